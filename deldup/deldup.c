@@ -1,13 +1,17 @@
 /**
- * This program calculate sha1 hash of some input filenames and removes duplicates
+ * This program calculate the hash (sha1 by default) of some input filenames and removes duplicates
  */
+#include "../utils/hashalgo.h"
 #include "../utils/hmap.h"
 #include "../utils/sha1.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
+#define COMPARE_CHUNK (64 * 1024) // bytes compared per read
+
 /**
  * Delete a file from the fs
  * Requires unistd.h
@@ -41,49 +45,94 @@ static bool delete_file(const char *filename) {
     return true;
 }
 
+/**
+ * Byte by byte comparison of two files
+ * Requires sys/stat.h
+ * @param[in] filename_a
+ * @param[in] filename_b
+ * @return true if the content is the same, false if it differs or cannot be read
+ */
+static bool same_content(const char *filename_a, const char *filename_b) {
+    struct stat st_a, st_b;
+    if (stat(filename_a, &st_a) != 0 || stat(filename_b, &st_b) != 0)
+        return false;
+    if (st_a.st_size != st_b.st_size)
+        return false;
+
+    FILE *file_a = fopen(filename_a, "rb");
+    FILE *file_b = fopen(filename_b, "rb");
+    uint8_t *buffer = malloc(2 * COMPARE_CHUNK);
+    bool same = file_a != NULL && file_b != NULL && buffer != NULL;
+
+    while (same) {
+        size_t read_a = fread(buffer, 1, COMPARE_CHUNK, file_a);
+        size_t read_b = fread(buffer + COMPARE_CHUNK, 1, COMPARE_CHUNK, file_b);
+        if (read_a != read_b || memcmp(buffer, buffer + COMPARE_CHUNK, read_a) != 0)
+            same = false;
+        else if (read_a < COMPARE_CHUNK) {
+            same = !ferror(file_a) && !ferror(file_b);
+            break; // end of both files
+        }
+    }
+
+    if (file_a != NULL)
+        fclose(file_a);
+    if (file_b != NULL)
+        fclose(file_b);
+    free(buffer);
+    return same;
+}
+
 /**
  * This function finds and remove duplicates inside an array of Fhash structure.
  * fhs array is not sorted by hash
  *
  * @param[in] fhs array of results
  * @param[in] len array length
+ * @param[in] hash_len bytes of fhs[ii].hash to compare
+ * @param[in] verify confirm every match with a byte by byte comparison before deleting
  */
-static void remove_duplicates(Fhash *fhs, size_t len) {
+static void remove_duplicates(Fhash *fhs, size_t len, size_t hash_len, bool verify) {
     // create an hash map to reduce scan complexity
-    HMap *map = hmap_create(1024);
+    HMap *map = hmap_create_pooled(1024, len);
     if (map == NULL) {
         perror("Cannot allocate hash map");
         exit(1);
     }
 
     // init to all zeros
-    uint8_t init[20] = {0};
+    uint8_t init[FHASH_LENGTH] = {0};
 
     // convertion from uint8_t to hex string
     // malloc is used because data are not owned by hash map
-    // so we need to allocate 40 + \0 byte for each hash
-    void *all_hash_str = malloc(sizeof(char) * SHA1_LENGTH_CHAR * len); // [hash_str (41) | hash_str | ....]
+    // so we need to allocate hash_len * 2 + \0 byte for each hash
+    size_t hash_len_char = hash_len * 2 + 1;
+    void *all_hash_str = malloc(sizeof(char) * hash_len_char * len); // [hash_str (41) | hash_str | ....]
     // point to first
     char *hash_str = all_hash_str;
 
     for (size_t ii = 0; ii < len; ii++) {
-        if (memcmp(fhs[ii].hash, init, SHA1_LENGTH) == 0)
+        if (memcmp(fhs[ii].hash, init, hash_len) == 0)
             continue; // hash not calculated, all zeros
 
         // Convert binary hash to hex string
-        if (!hash_to_hex(fhs[ii].hash, SHA1_LENGTH, hash_str, SHA1_LENGTH_CHAR))
+        if (!hash_to_hex(fhs[ii].hash, hash_len, hash_str, hash_len_char))
             exit(1); // cannot continue
 
         HEntry *entry = hmap_get(map, hash_str); // ht_get(map, hash_str);
         if (entry == NULL) {
             // not found then HMap *map, char *key, void *value, HEType type, uint32_t value_size
             hmap_add(map, hash_str, fhs[ii].filename, HE_TYPE_STR, 1);
+        } else if (verify && !same_content(fhs[ii].filename, (char *)entry->value)) {
+            // same hash, different content (or unreadable): never delete it
+            printf("%s has the same hash of %s but not the same content, kept\n", fhs[ii].filename,
+                   ((char *)entry->value));
         } else {
             // if found then it's a duplicate. cast to char* is safe
             printf("%s is a duplicate of %s\n", fhs[ii].filename, ((char *)entry->value));
             delete_file(fhs[ii].filename);
         }
-        hash_str += SHA1_LENGTH_CHAR; // go to the next one
+        hash_str += hash_len_char; // go to the next one
     }
 
     free(all_hash_str); // destroy hashes
@@ -96,29 +145,62 @@ static void remove_duplicates(Fhash *fhs, size_t len) {
  * @param[in]  argv  Filenames
  */
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        printf("Usage: %s <file_1>...<file_n>\n", argv[0]);
+    // options
+    bool pipeline = false;
+    bool verify = false;
+    HashAlgo algo = HASH_ALGO_SHA1;
+    int first = 1;
+    for (; first < argc && argv[first][0] == '-'; first++) {
+        if (strcmp(argv[first], "-p") == 0) {
+            pipeline = true;
+        } else if (strcmp(argv[first], "--verify") == 0) {
+            verify = true;
+        } else if (strcmp(argv[first], "-a") == 0 && first + 1 < argc) {
+            if (!hash_algo_parse(argv[++first], &algo)) {
+                fprintf(stderr, "Unknown algorithm %s\n", argv[first]);
+                argc = 0; // print usage
+            }
+        } else if (strcmp(argv[first], "--") == 0) {
+            first++;
+            break;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[first]);
+            argc = 0; // print usage
+        }
+    }
+
+    if (argc - first < 1) {
+        printf("Usage: %s [-a sha1|sha1tree|sha256|xxh3] [--verify] [-p] <file_1>...<file_n>\n", argv[0]);
+        printf("  -a        algorithm: sha1 (default), sha1tree (SHA-1 Merkle tree, huge files on every core),\n");
+        printf("            sha256 (collision resistant, slower) or xxh3 (128-bit, non-cryptographic, much faster)\n");
+        printf("  --verify  compare the content of duplicates before deleting them\n");
+        printf("  -p        asynchronous pipeline (io_uring, threads fallback), for many files on fast storage (sha1)\n");
         return EXIT_FAILURE;
     }
 
     // allocate one struct per file
-    int tot_files = argc - 1;
-    Fhash *fhs = calloc(argc - 1, sizeof(Fhash));
+    int tot_files = argc - first;
+    Fhash *fhs = calloc(tot_files, sizeof(Fhash));
+    bool *ok = calloc(tot_files, sizeof(bool));
+    if (fhs == NULL || ok == NULL) {
+        perror("Cannot allocate file list");
+        return EXIT_FAILURE;
+    }
     // printf("Total files %d\n", tot_files);
 
-    for (int ii = 0; ii < tot_files; ii++) {
-        Fhash *fh = &fhs[ii];
-        fh->filename = argv[ii + 1]; // skip first argv
+    for (int ii = 0; ii < tot_files; ii++)
+        fhs[ii].filename = argv[ii + first]; // skip first argv and options
 
-        if (!fhsha1(fh))
-            continue;
-
-        fhprint(fh);
+    fhash_files(fhs, tot_files, ok, algo, pipeline);
+    for (int ii = 0; ii < tot_files; ii++) {
+        if (ok[ii])
+            fhprint_algo(&fhs[ii], algo);
     }
 
     if (tot_files > 1)
-        remove_duplicates(fhs, tot_files);
+        remove_duplicates(fhs, tot_files, hash_algo_length(algo), verify);
 
+    free(ok);
     free(fhs); // free the space
 
     return EXIT_SUCCESS;
@@ -1,37 +1,122 @@
+#include "../utils/hashalgo.h"
 #include "../utils/sha1.h"
+#include "../utils/sha1tree.h"
+#include "../utils/sha256.h"
+#include "../utils/xxh3.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
 /**
- * This program calculate sha1 hash of some input filenames
+ * @brief Hash stdin as it arrives (pipes), without buffering it
+ *
+ * @param[out] fh hash of the stream
+ * @param[in] algo algorithm
+ * @return true if the hash is calculated else false
+ */
+static bool stdin_hash(Fhash *fh, HashAlgo algo) {
+    uint8_t buffer[64 * 1024];
+    size_t bytes_read;
+    SHA1_CTX sha1_ctx;
+    SHA1TREE_CTX tree_ctx;
+    SHA256_CTX sha256_ctx;
+    XXH3_CTX xxh3_ctx;
+
+    sha1_init(&sha1_ctx);
+    sha1tree_init(&tree_ctx);
+    sha256_init(&sha256_ctx);
+    xxh3_init(&xxh3_ctx);
+    while ((bytes_read = fread(buffer, 1, sizeof(buffer), stdin)) > 0) {
+        if (algo == HASH_ALGO_XXH3)
+            xxh3_update(&xxh3_ctx, buffer, bytes_read);
+        else if (algo == HASH_ALGO_SHA1TREE)
+            sha1tree_update(&tree_ctx, buffer, bytes_read);
+        else if (algo == HASH_ALGO_SHA256)
+            sha256_update(&sha256_ctx, buffer, bytes_read);
+        else
+            sha1_update(&sha1_ctx, buffer, bytes_read);
+    }
+    if (ferror(stdin)) {
+        perror("Cannot read stdin");
+        return false;
+    }
+    if (algo == HASH_ALGO_XXH3)
+        xxh3_final(&xxh3_ctx, fh->hash);
+    else if (algo == HASH_ALGO_SHA1TREE)
+        sha1tree_final(&tree_ctx, fh->hash);
+    else if (algo == HASH_ALGO_SHA256)
+        sha256_final(&sha256_ctx, fh->hash);
+    else
+        sha1_final(&sha1_ctx, fh->hash);
+    return true;
+}
+
+/**
+ * This program calculate the hash (sha1 by default) of some input filenames ("-" is stdin)
  * @param[in]  argc  args count
  * @param[in]  argv  Filenames
  */
 int main(int argc, char *argv[]) {
-    if (argc < 2) {
-        printf("Hash calculate the sha1 of some input filenames\n");
-        printf("Usage: %s <file_1>...<file_n>\n", argv[0]);
+    // options ("-" alone is stdin)
+    bool pipeline = false;
+    HashAlgo algo = HASH_ALGO_SHA1;
+    int first = 1;
+    for (; first < argc && argv[first][0] == '-' && argv[first][1] != '\0'; first++) {
+        if (strcmp(argv[first], "-p") == 0) {
+            pipeline = true;
+        } else if (strcmp(argv[first], "-a") == 0 && first + 1 < argc) {
+            if (!hash_algo_parse(argv[++first], &algo)) {
+                fprintf(stderr, "Unknown algorithm %s\n", argv[first]);
+                argc = 0; // print usage
+            }
+        } else if (strcmp(argv[first], "--") == 0) {
+            first++;
+            break;
+        } else {
+            fprintf(stderr, "Unknown option %s\n", argv[first]);
+            argc = 0; // print usage
+        }
+    }
+
+    if (argc - first < 1) {
+        printf("Hash calculate the hash (sha1 by default) of some input filenames\n");
+        printf("Usage: %s [-a sha1|sha1tree|sha256|xxh3] [-p] <file_1>...<file_n>\n", argv[0]);
+        printf("       <command> | %s [-a sha1|sha1tree|sha256|xxh3] -\n", argv[0]);
+        printf("  -a  algorithm: sha1 (default), sha1tree (SHA-1 Merkle tree, huge files on every core),\n");
+        printf("      sha256 (collision resistant, slower) or xxh3 (128-bit, non-cryptographic, much faster)\n");
+        printf("  -p  asynchronous pipeline (io_uring, threads fallback), for many files on fast storage (sha1)\n");
         return EXIT_FAILURE;
     }
 
     // allocate one struct per file
-    int tot_files = argc - 1;
-    Fhash *fhs = calloc(argc - 1, sizeof(Fhash));
+    int tot_files = argc - first;
+    Fhash *fhs = calloc(tot_files, sizeof(Fhash));
+    bool *ok = calloc(tot_files, sizeof(bool));
+    if (fhs == NULL || ok == NULL) {
+        perror("Cannot allocate file list");
+        return EXIT_FAILURE;
+    }
     // printf("Total files %d\n", tot_files);
 
+    for (int ii = 0; ii < tot_files; ii++)
+        fhs[ii].filename = argv[ii + first]; // skip first argv and options
+
+    fhash_files(fhs, tot_files, ok, algo, pipeline);
+    for (int ii = 0; ii < tot_files; ii++) {
+        if (strcmp(fhs[ii].filename, "-") == 0)
+            ok[ii] = stdin_hash(&fhs[ii], algo);
+    }
     for (int ii = 0; ii < tot_files; ii++) {
         Fhash *fh = &fhs[ii];
-        fh->filename = argv[ii + 1]; // skip first argv
-
-        if (!fhsha1(fh)) {
+        if (!ok[ii]) {
             fprintf(stderr, "Error: hash not calculated for %s\n", fh->filename);
             continue;
         }
 
-        fhprint(fh);
+        fhprint_algo(fh, algo);
     }
 
+    free(ok);
     free(fhs); // free the space
 
     return EXIT_SUCCESS;
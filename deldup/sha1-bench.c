@@ -0,0 +1,470 @@
+/**
+ * SHA-1 transform benchmark
+ * Throughput of every SHA-1 block transform on the workloads of the tools
+ *
+ * This benchmark tests:
+ * - hashs: sha1() of short strings (command line sized)
+ * - hash: fsha1() of a file in the page cache
+ * - the same two workloads with every XXH3 implementation (hash -a xxh3)
+ *   and every SHA-256 implementation (hash -a sha256)
+ * - many small messages through every multi-buffer engine, SHA-1 and SHA-256
+ * - hash of the file as a SHA-1 Merkle tree on every core (hash -a sha1tree)
+ * - fsha1 I/O strategies (read, mmap, O_DIRECT) on a hot and a cold file.
+ *   Cold means the pages of the file are dropped with POSIX_FADV_DONTNEED
+ *   before the run (no root needed, the rest of the page cache is kept)
+ *
+ * Every transform is checked against the portable one first, so a broken
+ * implementation fails loudly instead of reporting a great number.
+ *
+ * Usage:
+ *   ./sha1-bench              # 64 MB file, 1M strings
+ *   ./sha1-bench 256          # 256 MB file
+ *
+ * Compile with:
+ * gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 sha1-bench.c ../utils/fileio.c ../utils/mbsched.c ../utils/sha1.c ../utils/sha1mb.c
+ *     ../utils/sha1tree.c ../utils/sha256.c ../utils/sha256mb.c ../utils/xxh3.c -lpthread
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "../utils/fileio.h"
+#include "../utils/sha1.h"
+#include "../utils/sha1mb.h"
+#include "../utils/sha1tree.h"
+#include "../utils/sha256.h"
+#include "../utils/sha256mb.h"
+#include "../utils/xxh3.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_FILE_MB 64      // file size of the hash workload
+#define STRINGS 1000000         // sha1() calls per string length
+#define CHECK_MAX_LEN 1024      // cross check every length up to this one
+#define WRITE_CHUNK (1024 * 1024)
+#define MB_MESSAGES 8192        // messages of the multi-buffer workload
+#define MB_MESSAGE_LEN 4096     // small file sized
+
+/**
+ * One-shot hash of a buffer (sha1, sha256, xxh3)
+ */
+typedef bool (*HashFn)(const uint8_t *data, size_t len, uint8_t *hash);
+
+/**
+ * Hash of a file (fsha1, fsha1tree, fsha256, fxxh3)
+ */
+typedef bool (*FileHashFn)(const char *filename, uint8_t *hash);
+
+/**
+ * Multi-buffer hash of count messages, hashes one after the other (sha1_mb, sha256_mb)
+ */
+typedef bool (*MbHashFn)(const uint8_t *const data[], const size_t lens[], size_t count, uint8_t *hashes);
+
+static bool sha1_mb_flat(const uint8_t *const data[], const size_t lens[], size_t count, uint8_t *hashes) {
+    return sha1_mb(data, lens, count, (uint8_t(*)[SHA1_LENGTH])hashes);
+}
+
+static bool sha256_mb_flat(const uint8_t *const data[], const size_t lens[], size_t count, uint8_t *hashes) {
+    return sha256_mb(data, lens, count, (uint8_t(*)[SHA256_LENGTH])hashes);
+}
+
+/**
+ * Elapsed seconds between two timestamps
+ */
+static double elapsed_sec(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/**
+ * Check impl with the FIPS 180 vectors, then against the portable transform
+ * on every length up to CHECK_MAX_LEN
+ */
+static int check_impl(Sha1Impl impl, const uint8_t *data) {
+    static const char *vectors[][2] = {
+        {"abc", "a9993e364706816aba3e25717850c26c9cd0d89d"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "84983e441c3bd26ebaae4aa1f95129e5e54670f1"}};
+    for (size_t ii = 0; ii < sizeof(vectors) / sizeof(vectors[0]); ii++) {
+        uint8_t hash[SHA1_LENGTH];
+        char hex[SHA1_LENGTH_CHAR];
+        sha1_set_impl(impl);
+        sha1((const uint8_t *)vectors[ii][0], strlen(vectors[ii][0]), hash);
+        hash_to_hex(hash, SHA1_LENGTH, hex, SHA1_LENGTH_CHAR);
+        if (strcmp(hex, vectors[ii][1]) != 0) {
+            fprintf(stderr, "FAIL: %s wrong hash of \"%s\"\n", sha1_impl_name(impl), vectors[ii][0]);
+            return 0;
+        }
+    }
+
+    for (size_t len = 1; len <= CHECK_MAX_LEN; len++) {
+        uint8_t want[SHA1_LENGTH], got[SHA1_LENGTH];
+        sha1_set_impl(SHA1_IMPL_GENERIC);
+        sha1(data, len, want);
+        sha1_set_impl(impl);
+        sha1(data, len, got);
+        if (memcmp(want, got, SHA1_LENGTH) != 0) {
+            fprintf(stderr, "FAIL: %s differs from generic at length %zu\n", sha1_impl_name(impl), len);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Check XXH3 impl with known hashes, then against the portable one on
+ * every length up to CHECK_MAX_LEN, one-shot and streaming
+ */
+static int check_xxh3_impl(Xxh3Impl impl, const uint8_t *data) {
+    static const char *vectors[][2] = {{"", "99aa06d3014798d86001c324468d497f"},
+                                       {"abc", "06b05ab6733a618578af5f94892f3950"}};
+    for (size_t ii = 0; ii < sizeof(vectors) / sizeof(vectors[0]); ii++) {
+        uint8_t hash[XXH3_LENGTH];
+        char hex[XXH3_LENGTH_CHAR];
+        xxh3_set_impl(impl);
+        xxh3((const uint8_t *)vectors[ii][0], strlen(vectors[ii][0]), hash);
+        hash_to_hex(hash, XXH3_LENGTH, hex, XXH3_LENGTH_CHAR);
+        if (strcmp(hex, vectors[ii][1]) != 0) {
+            fprintf(stderr, "FAIL: xxh3 %s wrong hash of \"%s\"\n", xxh3_impl_name(impl), vectors[ii][0]);
+            return 0;
+        }
+    }
+
+    for (size_t len = 0; len <= CHECK_MAX_LEN; len++) {
+        uint8_t want[XXH3_LENGTH], got[XXH3_LENGTH], streamed[XXH3_LENGTH];
+        XXH3_CTX ctx;
+        xxh3_set_impl(XXH3_IMPL_GENERIC);
+        xxh3(data, len, want);
+        xxh3_set_impl(impl);
+        xxh3(data, len, got);
+        xxh3_init(&ctx);
+        for (size_t off = 0; off < len; off += 100)
+            xxh3_update(&ctx, data + off, len - off < 100 ? len - off : 100);
+        xxh3_final(&ctx, streamed);
+        if (memcmp(want, got, XXH3_LENGTH) != 0 || memcmp(want, streamed, XXH3_LENGTH) != 0) {
+            fprintf(stderr, "FAIL: xxh3 %s differs from generic at length %zu\n", xxh3_impl_name(impl), len);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Check SHA-256 impl with the FIPS 180 vectors, then against the portable
+ * transform on every length up to CHECK_MAX_LEN, one-shot and streaming
+ */
+static int check_sha256_impl(Sha256Impl impl, const uint8_t *data) {
+    static const char *vectors[][2] = {
+        {"", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+        {"abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+        {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"}};
+    for (size_t ii = 0; ii < sizeof(vectors) / sizeof(vectors[0]); ii++) {
+        uint8_t hash[SHA256_LENGTH];
+        char hex[SHA256_LENGTH_CHAR];
+        sha256_set_impl(impl);
+        sha256((const uint8_t *)vectors[ii][0], strlen(vectors[ii][0]), hash);
+        hash_to_hex(hash, SHA256_LENGTH, hex, SHA256_LENGTH_CHAR);
+        if (strcmp(hex, vectors[ii][1]) != 0) {
+            fprintf(stderr, "FAIL: sha256 %s wrong hash of \"%s\"\n", sha256_impl_name(impl), vectors[ii][0]);
+            return 0;
+        }
+    }
+
+    for (size_t len = 0; len <= CHECK_MAX_LEN; len++) {
+        uint8_t want[SHA256_LENGTH], got[SHA256_LENGTH], streamed[SHA256_LENGTH];
+        SHA256_CTX ctx;
+        sha256_set_impl(SHA256_IMPL_GENERIC);
+        sha256(data, len, want);
+        sha256_set_impl(impl);
+        sha256(data, len, got);
+        sha256_init(&ctx);
+        for (size_t off = 0; off < len; off += 100)
+            sha256_update(&ctx, data + off, len - off < 100 ? len - off : 100);
+        sha256_final(&ctx, streamed);
+        if (memcmp(want, got, SHA256_LENGTH) != 0 || memcmp(want, streamed, SHA256_LENGTH) != 0) {
+            fprintf(stderr, "FAIL: sha256 %s differs from generic at length %zu\n", sha256_impl_name(impl), len);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * hashs workload: many hash_fn() of len bytes
+ */
+static void bench_strings(HashFn hash_fn, size_t len) {
+    static const char text[] = "the quick brown fox jumps over the lazy dog, the quick brown fox jumps over";
+    uint8_t hash[FHASH_LENGTH];
+    uint8_t acc = 0;
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t ii = 0; ii < STRINGS; ii++) {
+        hash_fn((const uint8_t *)text + (ii & 7), len, hash);
+        acc += hash[ii & 15];
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double sec = elapsed_sec(start, end);
+    printf("  hashs  %3zu B strings : %8.2f M hash/s %9.1f MB/s (%02x)\n", len, STRINGS / sec / 1e6,
+           STRINGS * (double)len / sec / 1e6, acc);
+}
+
+/**
+ * hash workload: file_hash_fn() of a file in the page cache
+ */
+static void bench_file(const char *name, FileHashFn file_hash_fn, const char *path, size_t file_mb) {
+    uint8_t hash[FHASH_LENGTH];
+    char hex[SHA1_LENGTH_CHAR];
+    struct timespec start, end;
+
+    file_hash_fn(path, hash); // warm up the page cache
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    file_hash_fn(path, hash);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    hash_to_hex(hash, SHA1_LENGTH, hex, SHA1_LENGTH_CHAR);
+    printf("  %-6s %3zu MB file    : %9.1f MB/s (%.8s)\n", name, file_mb,
+           file_mb * 1024 * 1024 / elapsed_sec(start, end) / 1e6, hex);
+}
+
+/**
+ * Many small files workload: MB_MESSAGES messages through mb_fn, checked against hash_fn
+ *
+ * @return 1 if every hash is the one of hash_fn
+ */
+static int bench_messages(const char *name, MbHashFn mb_fn, HashFn hash_fn, size_t hash_len,
+                          const uint8_t *const data[], const size_t lens[], uint8_t *hashes) {
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    mb_fn(data, lens, MB_MESSAGES, hashes);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    int ok = 1;
+    for (size_t ii = 0; ii < MB_MESSAGES && ok; ii++) {
+        uint8_t want[FHASH_LENGTH];
+        hash_fn(data[ii], lens[ii], want);
+        ok = memcmp(want, hashes + ii * hash_len, hash_len) == 0;
+    }
+    printf("  %-6s %d x %d B    : %9.1f MB/s%s\n", name, MB_MESSAGES, MB_MESSAGE_LEN,
+           (double)MB_MESSAGES * MB_MESSAGE_LEN / elapsed_sec(start, end) / 1e6, ok ? "" : " FAILED");
+    return ok;
+}
+
+/**
+ * Drop the page cache of a file (its pages only)
+ */
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+    fdatasync(fd); // dirty pages cannot be dropped
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+/**
+ * fsha1_io of the file with one I/O strategy
+ *
+ * @return 1 if the hash is the expected one
+ */
+static int bench_io(const char *path, size_t file_mb, FileIo io, int cold, const uint8_t *expected) {
+    uint8_t hash[SHA1_LENGTH];
+    struct timespec start, end;
+
+    if (cold)
+        drop_cache(path);
+    else
+        fsha1_io(path, hash, io); // warm up the page cache
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    int ok = fsha1_io(path, hash, io);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    ok = ok && memcmp(hash, expected, SHA1_LENGTH) == 0;
+    printf("  %-6s %s %3zu MB file    : %9.1f MB/s%s\n", fileio_name(io), cold ? "cold" : "hot ", file_mb,
+           file_mb * 1024 * 1024 / elapsed_sec(start, end) / 1e6, ok ? "" : " FAILED");
+    return ok;
+}
+
+/**
+ * Create a temporary file of file_mb pseudo random megabytes
+ */
+static int create_file(char *path, size_t file_mb) {
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("[create_file] mkstemp");
+        return 0;
+    }
+
+    uint8_t *chunk = malloc(WRITE_CHUNK);
+    if (chunk == NULL) {
+        perror("[create_file] malloc");
+        close(fd);
+        return 0;
+    }
+    uint32_t seed = 0x12345678;
+    for (size_t ii = 0; ii < WRITE_CHUNK; ii++) {
+        seed = seed * 1664525u + 1013904223u;
+        chunk[ii] = (uint8_t)(seed >> 24);
+    }
+
+    int res = 1;
+    for (size_t mb = 0; mb < file_mb && res; mb++) {
+        if (write(fd, chunk, WRITE_CHUNK) != WRITE_CHUNK) {
+            perror("[create_file] write");
+            res = 0;
+        }
+    }
+    free(chunk);
+    close(fd);
+    return res;
+}
+
+int main(int argc, char *argv[]) {
+    size_t file_mb = DEFAULT_FILE_MB;
+    if (argc > 1) {
+        file_mb = strtoul(argv[1], NULL, 10);
+        if (file_mb == 0) {
+            printf("usage: %s [file_mb]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    char path[] = "/tmp/sha1-bench-XXXXXX";
+    if (!create_file(path, file_mb)) {
+        unlink(path);
+        return EXIT_FAILURE;
+    }
+
+    static uint8_t check_data[CHECK_MAX_LEN];
+    for (size_t ii = 0; ii < CHECK_MAX_LEN; ii++)
+        check_data[ii] = (uint8_t)(ii * 131 + 7);
+
+    static const Sha1Impl impls[] = {SHA1_IMPL_GENERIC, SHA1_IMPL_SHANI};
+    Sha1Impl best = sha1_get_impl();
+    int res = EXIT_SUCCESS;
+
+    printf("sha1 transforms (auto: %s)\n", sha1_impl_name(best));
+    for (size_t ii = 0; ii < sizeof(impls) / sizeof(impls[0]); ii++) {
+        if (!sha1_set_impl(impls[ii])) {
+            printf("%s: not supported\n", sha1_impl_name(impls[ii]));
+            continue;
+        }
+        if (!check_impl(impls[ii], check_data)) {
+            res = EXIT_FAILURE;
+            continue;
+        }
+
+        printf("%s:\n", sha1_impl_name(impls[ii]));
+        bench_strings(sha1, 8);
+        bench_strings(sha1, 40);
+        bench_strings(sha1, 64);
+        bench_file("hash", fsha1, path, file_mb);
+    }
+
+    static const Xxh3Impl xxh3_impls[] = {XXH3_IMPL_GENERIC, XXH3_IMPL_SSE2, XXH3_IMPL_AVX2};
+    Xxh3Impl xxh3_best = xxh3_get_impl();
+    printf("xxh3 (auto: %s)\n", xxh3_impl_name(xxh3_best));
+    for (size_t ii = 0; ii < sizeof(xxh3_impls) / sizeof(xxh3_impls[0]); ii++) {
+        if (!xxh3_set_impl(xxh3_impls[ii])) {
+            printf("%s: not supported\n", xxh3_impl_name(xxh3_impls[ii]));
+            continue;
+        }
+        if (!check_xxh3_impl(xxh3_impls[ii], check_data)) {
+            res = EXIT_FAILURE;
+            continue;
+        }
+
+        printf("%s:\n", xxh3_impl_name(xxh3_impls[ii]));
+        bench_strings(xxh3, 8);
+        bench_strings(xxh3, 40);
+        bench_strings(xxh3, 64);
+        bench_file("hash", fxxh3, path, file_mb);
+    }
+    xxh3_set_impl(xxh3_best);
+
+    static const Sha256Impl sha256_impls[] = {SHA256_IMPL_GENERIC, SHA256_IMPL_SHANI};
+    Sha256Impl sha256_best = sha256_get_impl();
+    printf("sha256 transforms (auto: %s)\n", sha256_impl_name(sha256_best));
+    for (size_t ii = 0; ii < sizeof(sha256_impls) / sizeof(sha256_impls[0]); ii++) {
+        if (!sha256_set_impl(sha256_impls[ii])) {
+            printf("%s: not supported\n", sha256_impl_name(sha256_impls[ii]));
+            continue;
+        }
+        if (!check_sha256_impl(sha256_impls[ii], check_data)) {
+            res = EXIT_FAILURE;
+            continue;
+        }
+
+        printf("%s:\n", sha256_impl_name(sha256_impls[ii]));
+        bench_strings(sha256, 8);
+        bench_strings(sha256, 40);
+        bench_strings(sha256, 64);
+        bench_file("hash", fsha256, path, file_mb);
+    }
+    sha256_set_impl(sha256_best);
+
+    // many small files: SHA-1 and SHA-256 through every multi-buffer engine
+    uint8_t *messages = malloc((size_t)MB_MESSAGES * MB_MESSAGE_LEN);
+    const uint8_t **mb_data = malloc(MB_MESSAGES * sizeof(*mb_data));
+    size_t *mb_lens = malloc(MB_MESSAGES * sizeof(*mb_lens));
+    uint8_t *mb_hashes = malloc((size_t)MB_MESSAGES * FHASH_LENGTH);
+    if (messages == NULL || mb_data == NULL || mb_lens == NULL || mb_hashes == NULL) {
+        perror("malloc");
+        res = EXIT_FAILURE;
+    } else {
+        for (size_t ii = 0; ii < (size_t)MB_MESSAGES * MB_MESSAGE_LEN; ii++)
+            messages[ii] = (uint8_t)(ii * 131 + (ii >> 12));
+        for (size_t ii = 0; ii < MB_MESSAGES; ii++) {
+            mb_data[ii] = messages + ii * MB_MESSAGE_LEN;
+            mb_lens[ii] = MB_MESSAGE_LEN;
+        }
+
+        static const Sha1MbImpl sha1_mb_impls[] = {SHA1_MB_SERIAL, SHA1_MB_VEC4, SHA1_MB_AVX2, SHA1_MB_AVX512};
+        Sha1MbImpl sha1_mb_best = sha1_mb_get_impl();
+        printf("sha1 multi-buffer (%s, auto: %s)\n", sha1_impl_name(best), sha1_mb_impl_name(sha1_mb_best));
+        for (size_t ii = 0; ii < sizeof(sha1_mb_impls) / sizeof(sha1_mb_impls[0]); ii++) {
+            if (!sha1_mb_set_impl(sha1_mb_impls[ii]))
+                printf("  %-6s not supported\n", sha1_mb_impl_name(sha1_mb_impls[ii]));
+            else if (!bench_messages(sha1_mb_impl_name(sha1_mb_impls[ii]), sha1_mb_flat, sha1, SHA1_LENGTH, mb_data, mb_lens, mb_hashes))
+                res = EXIT_FAILURE;
+        }
+        sha1_mb_set_impl(sha1_mb_best);
+
+        static const Sha256MbImpl sha256_mb_impls[] = {SHA256_MB_SERIAL, SHA256_MB_VEC4, SHA256_MB_AVX2, SHA256_MB_AVX512};
+        Sha256MbImpl sha256_mb_best = sha256_mb_get_impl();
+        printf("sha256 multi-buffer (%s, auto: %s)\n", sha256_impl_name(sha256_best), sha256_mb_impl_name(sha256_mb_best));
+        for (size_t ii = 0; ii < sizeof(sha256_mb_impls) / sizeof(sha256_mb_impls[0]); ii++) {
+            if (!sha256_mb_set_impl(sha256_mb_impls[ii]))
+                printf("  %-6s not supported\n", sha256_mb_impl_name(sha256_mb_impls[ii]));
+            else if (!bench_messages(sha256_mb_impl_name(sha256_mb_impls[ii]), sha256_mb_flat, sha256, SHA256_LENGTH, mb_data, mb_lens, mb_hashes))
+                res = EXIT_FAILURE;
+        }
+        sha256_mb_set_impl(sha256_mb_best);
+    }
+    free(mb_hashes);
+    free(mb_lens);
+    free(mb_data);
+    free(messages);
+
+    sha1_set_impl(best);
+    static const FileIo ios[] = {FILEIO_READ, FILEIO_MMAP, FILEIO_DIRECT};
+    printf("fsha1 I/O strategies (%s, auto: %s)\n", sha1_impl_name(best),
+           fileio_name(fileio_pick((uint64_t)file_mb * 1024 * 1024)));
+    uint8_t expected[SHA1_LENGTH];
+    fsha1(path, expected);
+    for (size_t ii = 0; ii < sizeof(ios) / sizeof(ios[0]); ii++) {
+        if (!bench_io(path, file_mb, ios[ii], 0, expected) || !bench_io(path, file_mb, ios[ii], 1, expected))
+            res = EXIT_FAILURE;
+    }
+
+    printf("sha1tree (%s, %ld threads, %d KB leaves)\n", sha1_impl_name(best), sysconf(_SC_NPROCESSORS_ONLN),
+           SHA1TREE_LEAF_LEN / 1024);
+    bench_file("hash", fsha1, path, file_mb);
+    bench_file("tree", fsha1tree, path, file_mb);
+
+    unlink(path);
+    return res;
+}
@@ -290,8 +290,8 @@ static void print_usage(void) {
  *   path: Starting directory (default: current directory ".")
  *   broom_targets: Optional list of directories to clean (defaults to predefined list)
  *
- * Build: gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/alist.c git-broom.c
- * Build static: gcc -static -Wextra -Wall -Wpedantic -O2 -g -std=c99 ../utils/alist.c git-broom.c
+ * Build: gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/alist.c ../utils/allocator.c git-broom.c
+ * Build static: gcc -static -Wextra -Wall -Wpedantic -O2 -g -std=c99 ../utils/alist.c ../utils/allocator.c git-broom.c
  *
  * Examples:
  *   ./git-broom                                    # Clean default broom_targets in current directory
@@ -1,4 +1,8 @@
+#include "../utils/alist.h"
+#include "../utils/allocstats.h"
 #include "../utils/bumparena.h"
+#include "../utils/hmap.h"
+#include <assert.h>
 #include <stdio.h>
 
 /**
@@ -67,19 +71,16 @@ static void safe_exit(BumpArena *arena) {
     exit(1);
 }
 
-// gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/bumparena.c how-arena.c
+// gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/allocator.c ../utils/allocstats.c ../utils/bumparena.c ../utils/alist.c ../utils/hmap.c ../utils/pool.c how-arena.c -lpthread
 int main(void) {
     BumpArena *arena = bumparena_create(1024);
-    {
-        // I would like to reserve some bytes to place some numbers...
-        size_t buffer_size = 192;
-
-        uint8_t *my_data = bumparena_alloc(arena, buffer_size);
-        if (!my_data)
-            safe_exit(arena);
-        for (size_t ii = 0; ii < buffer_size; ii++) {
-            (*(my_data + ii)) = (ii + 57) & 0xFF; // ensure uint8 size
-        }
+    // I would like to reserve some bytes to place some numbers...
+    size_t buffer_size = 192;
+    uint8_t *my_data = bumparena_alloc(arena, buffer_size);
+    if (!my_data)
+        safe_exit(arena);
+    for (size_t ii = 0; ii < buffer_size; ii++) {
+        (*(my_data + ii)) = (ii + 57) & 0xFF; // ensure uint8 size
     }
 
     // here I would like to read some files
@@ -92,9 +93,143 @@ int main(void) {
         printf("File size: %ld bytes\n", file_size);
     }
 
+    // typed allocations honor the alignment of the type
+    {
+        uint8_t *odd = bumparena_alloc(arena, 3); // leave the offset unaligned
+        uint64_t *counter = ARENA_NEW(arena, uint64_t);
+        double *values = ARENA_ARRAY(arena, double, 16);
+        float *vector = bumparena_alloc_aligned(arena, 16 * sizeof(float), BUMPARENA_CACHE_LINE);
+        if (!odd || !counter || !values || !vector)
+            safe_exit(arena);
+        assert((uintptr_t)counter % BUMPARENA_ALIGNOF(uint64_t) == 0);
+        assert((uintptr_t)values % BUMPARENA_ALIGNOF(double) == 0);
+        assert((uintptr_t)vector % BUMPARENA_CACHE_LINE == 0);
+        *counter = 42;
+        printf("counter %p values %p vector %p\n", (void *)counter, (void *)values, (void *)vector);
+    }
+
+    // the file does not fit in the first chunk: the arena has grown
+    // but my_data has not moved
+    for (size_t ii = 0; ii < buffer_size; ii++)
+        assert(my_data[ii] == ((ii + 57) & 0xFF));
+
     printf("start: %p offset: %p len: %ld capacity: %ld\n", arena->start, arena->offset, arena->len, arena->capacity);
 
+    // scratch scope: read the same file many times, every iteration rolls
+    // the arena back so the same chunks are reused (no malloc after the first round)
+    {
+        BumpArenaMark mark = bumparena_mark(arena);
+        size_t capacity = 0;
+        for (int ii = 0; ii < 100; ii++) {
+            size_t file_size = 0;
+            char *buffer = (char *)read_entire_file("how-arena.c", &file_size, arena);
+            char *copy = (char *)read_entire_file("how-arena.c", NULL, arena);
+            if (buffer == NULL || copy == NULL)
+                safe_exit(arena);
+            assert(buffer[file_size] == 0 && copy[0] == buffer[0]);
+
+            if (ii == 0)
+                capacity = arena->capacity;
+            assert(arena->capacity == capacity);
+            bumparena_reset_to(arena, mark);
+            assert(arena->len == mark.len && arena->offset == mark.offset);
+        }
+        printf("scratch loop: len: %ld capacity: %ld\n", arena->len, arena->capacity);
+    }
+
+    // release everything, keep the memory
+    bumparena_reset(arena);
+    assert(arena->len == 0);
+    my_data = bumparena_alloc(arena, buffer_size);
+    if (!my_data)
+        safe_exit(arena);
+
     bumparena_destroy(arena);
     arena = NULL;
+
+    // containers on an arena allocator: a whole request worth of structures
+    // released in one shot
+    {
+        arena = bumparena_create(4096);
+        if (arena == NULL)
+            return 1;
+        Allocator allocator = bumparena_allocator(arena);
+        static char *names[] = {"alpha", "beta", "gamma", "delta", "epsilon"};
+
+        AList *list = al_create_with(2, AL_TYPE_STR, &allocator); // grows by realloc
+        HMap *index = hmap_create_with(4, &allocator);            // grows by rehash
+        if (list == NULL || index == NULL)
+            safe_exit(arena);
+        for (size_t ii = 0; ii < 5; ii++) {
+            if (!al_append(list, names[ii]) || !hmap_add(index, names[ii], names[ii], HE_TYPE_STR, 1))
+                safe_exit(arena);
+        }
+        assert(list->size == 5 && index->len == 5);
+        assert(hmap_get(index, "gamma")->value == names[2]);
+        printf("request: list size %zu, index capacity %zu, arena len %zu\n", list->size, index->capacity, arena->len);
+
+        // no al_destroy / hmap_destroy needed
+        bumparena_destroy(arena);
+        arena = NULL;
+    }
+
+    // instrumentation: count what the containers and the arena ask to libc
+    {
+        AllocStats *stats = allocstats_create(NULL);
+        if (stats == NULL)
+            return 1;
+        // every allocation of a container is reported on the line that created it
+        arena = bumparena_create_with(256, ALLOCSTATS_AT(stats)); // chunks are counted
+        HMap *map = hmap_create_with(2, ALLOCSTATS_AT(stats));
+        if (arena == NULL || map == NULL)
+            return 1;
+        allocstats_track_arena(stats, arena, "scratch");
+
+        static char keys[64][8];
+        for (int ii = 0; ii < 64; ii++) {
+            snprintf(keys[ii], sizeof(keys[ii]), "k%d", ii);
+            char *value = bumparena_alloc(arena, 100);
+            if (value == NULL || !hmap_add(map, keys[ii], value, HE_TYPE_STR, 1))
+                safe_exit(arena);
+        }
+        bumparena_reset(arena);
+        uint8_t *direct = ALLOCSTATS_ALLOC(stats, 40);
+        ALLOCSTATS_FREE(stats, direct, 40);
+
+        assert(stats->live_blocks > 0 && stats->peak_bytes >= stats->live_bytes);
+        assert(arena->high_water >= 64 * 100 && arena->len == 0);
+        allocstats_report(stats, stdout);
+
+        hmap_destroy(map);
+        allocstats_untrack_arena(stats, arena);
+        bumparena_destroy(arena);
+        arena = NULL;
+        assert(stats->live_bytes == 0 && stats->live_blocks == 0);
+        allocstats_destroy(stats);
+    }
+
+    // virtual memory backend: reserve 64GB, only the touched pages are committed
+    {
+        size_t reserve = SIZE_MAX > 0xFFFFFFFFu ? (size_t)64 << 30 : (size_t)1 << 30;
+        arena = bumparena_create_vm(reserve, BUMPARENA_VM_HUGEPAGES);
+        if (arena == NULL)
+            return 1;
+        uint8_t *base = arena->start;
+        size_t block = 1024 * 1024;
+        for (size_t ii = 0; ii < 64; ii++) {
+            uint8_t *block_data = bumparena_alloc(arena, block);
+            if (block_data == NULL)
+                safe_exit(arena);
+            assert(block_data == base + ii * block); // the base never moves
+            block_data[0] = block_data[block - 1] = 0xAB;
+        }
+        printf("vm: reserved: %zu len: %zu committed: %zu\n", arena->reserved, arena->len, arena->capacity);
+
+        bumparena_reset(arena);
+        uint8_t *again = ARENA_ARRAY(arena, uint8_t, 4 * block);
+        assert(again == base && again[4 * block - 1] == 0); // pages returned to the OS
+        bumparena_destroy(arena);
+        arena = NULL;
+    }
     return 0;
 }
\ No newline at end of file
@@ -106,7 +106,7 @@ void test_4(void) {
     al_destroy_deep(list);
 }
 
-// gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/alist.c how-array-list.c
+// gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/allocator.c ../utils/alist.c how-array-list.c
 int main(void) {
     printf("------- Test 1 -------\n");
     test_1();
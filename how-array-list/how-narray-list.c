@@ -2,7 +2,7 @@
 #include <assert.h>
 #include <stdio.h>
 
-// gcc -Wall -Wpedantic -O2 -g -std=c99 ../utils/nalist.c how-narray-list.c
+// gcc -Wall -Wpedantic -O2 -g -std=c99 ../utils/allocator.c ../utils/nalist.c how-narray-list.c
 int main(void) {
     NAList *list = nal_create(16);
 
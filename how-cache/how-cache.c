@@ -0,0 +1,123 @@
+#include "../utils/cache.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOT_KEYS 2000     // keys requested again and again (skewed)
+#define REQUESTS 500000   // total requests
+#define VALUE_LEN 64      // bytes per cached value
+#define CACHE_BYTES 65536 // budget: roughly 500 entries
+#define CHURN_PUTS 1000000 // unique keys put by run_churn
+
+/**
+ * @brief Run a skewed workload polluted by one-off scans
+ *
+ * 70% of the requests hit a hot key set (low ids are much more popular),
+ * 30% are unique keys that are never requested again (e.g. a directory scan).
+ * A miss loads the value and puts it in the cache.
+ *
+ * @param[in] policy cache policy
+ */
+static void run_workload(CachePolicy policy) {
+    Cache *cache = cache_create(CACHE_BYTES, policy);
+    if (cache == NULL)
+        exit(1);
+
+    srand(1234);
+    char key[32];
+    uint8_t value[VALUE_LEN];
+    size_t scan_id = 0;
+
+    for (size_t ii = 0; ii < REQUESTS; ii++) {
+        if (rand() % 10 < 7) {
+            size_t hot = (size_t)(rand() % HOT_KEYS) * (size_t)(rand() % HOT_KEYS) / HOT_KEYS;
+            snprintf(key, sizeof(key), "hot-%zu", hot);
+        } else {
+            snprintf(key, sizeof(key), "scan-%zu", scan_id++);
+        }
+
+        size_t len = 0;
+        const uint8_t *cached = cache_get(cache, key, &len);
+        if (cached != NULL) {
+            assert(len == VALUE_LEN && cached[0] == (uint8_t)key[strlen(key) - 1]);
+            continue;
+        }
+
+        // miss: "load" the value and cache it
+        memset(value, key[strlen(key) - 1], VALUE_LEN);
+        cache_put(cache, key, value, VALUE_LEN);
+        assert(cache->used <= cache->capacity);
+    }
+
+    cache_print_stats(cache);
+    cache_destroy(cache);
+}
+
+/**
+ * @brief Churn: unique keys only, every put evicts
+ *
+ * Every eviction removes a key from the index. The index must reuse or
+ * clean up the deleted slots: its capacity stays bounded by the live entries
+ * instead of growing with the number of puts.
+ */
+static void run_churn(void) {
+    Cache *cache = cache_create(CACHE_BYTES, CACHE_POLICY_LRU);
+    if (cache == NULL)
+        exit(1);
+
+    char key[32];
+    uint8_t value[VALUE_LEN] = {0};
+    size_t max_capacity = 0;
+
+    for (size_t ii = 0; ii < CHURN_PUTS; ii++) {
+        snprintf(key, sizeof(key), "churn-%zu", ii);
+        int stored = cache_put(cache, key, value, VALUE_LEN);
+        assert(stored);
+
+        HMap *index = cache->index;
+        assert(index->len == cache->lru.size);
+        assert(index->len + index->tombstones <= index->capacity / 2 + 1);
+        if (index->capacity > max_capacity)
+            max_capacity = index->capacity;
+    }
+
+    printf("churn: %d puts, %zu entries, index capacity %zu (max %zu)\n",
+           CHURN_PUTS, cache->lru.size, cache->index->capacity, max_capacity);
+    // load at most 1/2, cleanup in place while the tombstones outnumber the
+    // live entries: a few slots per live entry, whatever the number of puts
+    assert(max_capacity <= 8 * cache->lru.size);
+    cache_destroy(cache);
+}
+
+// gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/allocator.c ../utils/hmap.c ../utils/pool.c ../utils/cache.c how-cache.c
+int main(void) {
+    {
+        // basic operations
+        Cache *cache = cache_create(1024, CACHE_POLICY_LRU);
+        int stored = cache_put(cache, "a", "apple", 6);
+        stored &= cache_put(cache, "b", "banana", 7);
+        assert(stored);
+        const char *value = cache_get(cache, "a", NULL);
+        assert(strcmp(value, "apple") == 0);
+        stored = cache_put(cache, "a", "avocado", 8); // replace
+        assert(stored);
+        value = cache_get(cache, "a", NULL);
+        assert(strcmp(value, "avocado") == 0);
+        int removed = cache_remove(cache, "b");
+        assert(removed);
+        value = cache_get(cache, "b", NULL);
+        assert(value == NULL);
+        static uint8_t big[2048];
+        stored = cache_put(cache, "big", big, sizeof(big)); // bigger than the budget: not stored
+        assert(!stored);
+        cache_print_stats(cache);
+        cache_destroy(cache);
+    }
+
+    printf("skewed workload with scans:\n");
+    run_workload(CACHE_POLICY_LRU);
+    run_workload(CACHE_POLICY_TINYLFU);
+    run_churn();
+    return 0;
+}
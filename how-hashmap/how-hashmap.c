@@ -32,7 +32,7 @@ double get_elapsed_ms(struct timespec start, struct timespec end) {
            (end.tv_nsec - start.tv_nsec) / 1000000.0;
 }
 
-// gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/hmap.c how-hashmap.c
+// gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/allocator.c ../utils/hmap.c ../utils/pool.c how-hashmap.c
 // valgrind ./a.out
 int main(void) {
     srand((unsigned int)time(NULL)); // seed
@@ -1,8 +1,13 @@
+#include "../utils/ilist.h"
 #include "../utils/llist.h"
 #include "../utils/nllist.h"
+#include "../utils/skiplist.h"
+#include "../utils/ullist.h"
 #include <assert.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
 
 void test_1(void) {
     NLList *list = nll_create();
@@ -193,7 +198,238 @@ void test_6() {
     ll_destroy(list);
 }
 
-// gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/llist.c ../utils/nllist.c how-linked-list.c
+void test_7(void) {
+    // queue-style churn: nodes are recycled by the pool, no malloc per node
+    NLList *queue = nll_create_pooled(64);
+    for (size_t ii = 0; ii < 100000; ii++) {
+        nll_append(queue, ii);
+        if (queue->size > 32) {
+            size_t head;
+            nll_get_value_head(queue, &head);
+            nll_remove(queue, 0);
+            assert(head == ii - 32);
+        }
+    }
+    printf("pooled queue size %zu, slab capacity %zu\n", queue->size, queue->pool->capacity);
+    assert(queue->pool->capacity == 64); // never needed a second slab
+    nll_destroy(queue);                  // bulk release
+
+    // two lists sharing the same pool
+    Pool *pool = pool_create(sizeof(LLNode), 0);
+    LList *a = ll_create_with_pool(pool);
+    LList *b = ll_create_with_pool(pool);
+    int32_t data[] = {1, 2, 3};
+    ll_append(a, &data[0], 1, LL_TYPE_INT32);
+    ll_append(b, &data[1], 1, LL_TYPE_INT32);
+    ll_append(b, &data[2], 1, LL_TYPE_INT32);
+    assert(pool->used == 3);
+    ll_print(a);
+    ll_print(b);
+    ll_destroy(a);
+    ll_destroy(b);
+    assert(pool->used == 0);
+    pool_destroy(pool);
+
+    // typed pool with a per-thread cache: the pool lock is taken once every
+    // POOL_CACHE_LEN / 2 blocks
+    Pool *shared = POOL_CREATE(NLLNode, 0);
+    PoolCache cache;
+    pool_cache_init(&cache, shared);
+    NLLNode *nodes[100];
+    for (size_t ii = 0; ii < 100; ii++) {
+        nodes[ii] = pool_cache_alloc(&cache);
+        assert(nodes[ii] != NULL);
+        nodes[ii]->elem = ii;
+    }
+    for (size_t ii = 0; ii < 100; ii++) {
+        assert(nodes[ii]->elem == ii);
+        pool_cache_free(&cache, nodes[ii]);
+    }
+    pool_cache_flush(&cache);
+    assert(shared->used == 0);
+    pool_destroy(shared);
+}
+
+void test_8(void) {
+    // unrolled list must behave exactly like the numeric list
+    NLList *ref = nll_create();
+    ULList *list = ull_create();
+    srand(42);
+    for (size_t ii = 0; ii < 20000; ii++) {
+        size_t op = rand() % 3;
+        if (op < 2 || ref->size == 0) {
+            size_t idx = rand() % (ref->size + 1);
+            nll_add(ref, ii, idx);
+            ull_add(list, ii, idx);
+        } else {
+            size_t idx = rand() % ref->size;
+            nll_remove(ref, idx);
+            ull_remove(list, idx);
+        }
+    }
+    assert(ref->size == list->size);
+    NLLNode *cur = ref->head;
+    for (size_t ii = 0; ii < list->size; ii++, cur = cur->next) {
+        size_t val = 0;
+        int found = ull_get_value(list, ii, &val);
+        assert(found && val == cur->elem);
+    }
+    printf("unrolled list size %zu, nodes %zu (%zu values per node)\n", list->size, list->nodes, ULL_NODE_CAP);
+    nll_destroy(ref);
+    ull_destroy(list);
+
+    // traversal and indexed access speed on a large list
+    const size_t n = 1000000;
+    NLList *nl = nll_create();
+    ULList *ul = ull_create();
+    for (size_t ii = 0; ii < n; ii++) {
+        nll_append(nl, ii);
+        ull_append(ul, ii);
+    }
+
+    clock_t start = clock();
+    size_t sum_n = 0;
+    for (NLLNode *node = nl->head; node != NULL; node = node->next)
+        sum_n += node->elem;
+    for (size_t ii = 0; ii < n; ii += n / 100) {
+        size_t val;
+        nll_get_value(nl, ii, &val);
+        sum_n += val;
+    }
+    double nll_ms = (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+
+    start = clock();
+    size_t sum_u = 0;
+    for (ULLNode *node = ul->head; node != NULL; node = node->next)
+        for (size_t kk = 0; kk < node->count; kk++)
+            sum_u += node->elems[kk];
+    for (size_t ii = 0; ii < n; ii += n / 100) {
+        size_t val;
+        ull_get_value(ul, ii, &val);
+        sum_u += val;
+    }
+    double ull_ms = (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+
+    assert(sum_n == sum_u);
+    printf("nllist %.2f ms, ullist %.2f ms\n", nll_ms, ull_ms);
+    nll_destroy(nl);
+    ull_destroy(ul);
+}
+
+void test_9(void) {
+    // positional edits: skip list must behave exactly like the unrolled list
+    ULList *ref = ull_create();
+    SkipList *list = skl_create();
+    srand(7);
+    for (size_t ii = 0; ii < 50000; ii++) {
+        if (rand() % 3 < 2 || ref->size == 0) {
+            size_t idx = rand() % (ref->size + 1);
+            ull_add(ref, ii, idx);
+            skl_add(list, ii, idx);
+        } else {
+            size_t idx = rand() % ref->size;
+            ull_remove(ref, idx);
+            skl_remove(list, idx);
+        }
+    }
+    assert(ref->size == list->size);
+    for (size_t ii = 0; ii < list->size; ii++) {
+        size_t a, b;
+        ull_get_value(ref, ii, &a);
+        skl_get_value(list, ii, &b);
+        assert(a == b);
+    }
+    printf("skip list size %zu, levels %zu\n", list->size, list->level);
+    ull_destroy(ref);
+    skl_destroy(list);
+
+    // ordered operations
+    SkipList *set = skl_create();
+    for (size_t ii = 0; ii < 1000; ii++)
+        skl_insert_sorted(set, (ii * 7919) % 1000, NULL);
+    size_t idx = 0;
+    int found = skl_find(set, 500, &idx);
+    assert(found && idx == 500);
+    int removed = skl_remove_value(set, 500);
+    assert(removed);
+    found = skl_find(set, 500, NULL);
+    assert(!found);
+    assert(skl_lower_bound(set, 500) == 500);
+    size_t prev = 0;
+    for (size_t ii = 0; ii < set->size; ii++) {
+        size_t val;
+        skl_get_value(set, ii, &val);
+        assert(val >= prev);
+        prev = val;
+    }
+    skl_destroy(set);
+
+    // indexed access on a large sequence
+    const size_t n = 200000;
+    NLList *nl = nll_create();
+    SkipList *sl = skl_create();
+    for (size_t ii = 0; ii < n; ii++) {
+        nll_append(nl, ii);
+        skl_append(sl, ii);
+    }
+    clock_t start = clock();
+    size_t sum_n = 0;
+    for (size_t ii = 0; ii < 1000; ii++) {
+        size_t val;
+        nll_get_value(nl, (ii * 7919) % n, &val);
+        sum_n += val;
+    }
+    double nll_ms = (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    start = clock();
+    size_t sum_s = 0;
+    for (size_t ii = 0; ii < 1000; ii++) {
+        size_t val;
+        skl_get_value(sl, (ii * 7919) % n, &val);
+        sum_s += val;
+    }
+    double skl_ms = (clock() - start) * 1000.0 / CLOCKS_PER_SEC;
+    assert(sum_n == sum_s);
+    printf("1000 random gets: nllist %.2f ms, skiplist %.2f ms\n", nll_ms, skl_ms);
+    nll_destroy(nl);
+    skl_destroy(sl);
+}
+
+typedef struct
+{
+    int id;
+    ILink link; // embedded link: no node allocation
+} Job;
+
+void test_10(void) {
+    Job jobs[5];
+    IList queue;
+    ilist_init(&queue);
+    for (int ii = 0; ii < 5; ii++) {
+        jobs[ii].id = ii;
+        ilist_push_back(&queue, &jobs[ii].link);
+    }
+
+    // remove odd jobs while iterating
+    ilist_foreach_safe(&queue, it, tmp) {
+        Job *job = ilist_entry(it, Job, link);
+        if (job->id % 2 == 1)
+            ilist_remove(&queue, it);
+    }
+    ilist_move_front(&queue, &jobs[4].link);
+
+    ilist_foreach(&queue, it) {
+        printf("%d ", ilist_entry(it, Job, link)->id);
+    }
+    printf("\n");
+
+    assert(queue.size == 3);
+    assert(ilist_entry(ilist_first(&queue), Job, link)->id == 4);
+    Job *popped = ilist_entry(ilist_pop_back(&queue), Job, link);
+    assert(popped->id == 2);
+    assert(ilist_entry(ilist_last(&queue), Job, link)->id == 0);
+}
+
+// gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 ../utils/allocator.c ../utils/pool.c ../utils/llist.c ../utils/nllist.c ../utils/ullist.c ../utils/skiplist.c how-linked-list.c
 int main(void) {
     printf("--------- numeric list test ---------\n");
     test_1();
@@ -207,5 +443,13 @@ int main(void) {
     test_5();
     printf("--- void* empty array test ---\n");
     test_6();
+    printf("--- pooled list test ---\n");
+    test_7();
+    printf("--- unrolled list test ---\n");
+    test_8();
+    printf("--- skip list test ---\n");
+    test_9();
+    printf("--- intrusive list test ---\n");
+    test_10();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,93 @@
+#define _POSIX_C_SOURCE 199309L
+#include "../third-party/sds/sds.h"
+#include "../utils/bumparena.h"
+#include "../utils/pool.h"
+#include "../utils/sdsctx.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// sds strings on a BumpArena / size class pools instead of one malloc each
+// gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 -DSDS_ALLOCATOR ../third-party/sds/sds.c ../utils/sdsctx.c ../utils/allocator.c ../utils/bumparena.c ../utils/pool.c arena-sds.c -lpthread
+
+#define STRINGS 1000000
+
+static double elapsed_ms(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1000000.0;
+}
+
+/**
+ * @brief Build STRINGS short strings, check them, free them
+ *
+ * @param[in] label printed label
+ * @param[in] strings array of STRINGS slots
+ * @return total length of the strings
+ */
+static size_t build_strings(const char *label, sds *strings) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t total = 0;
+    for (size_t ii = 0; ii < STRINGS; ii++) {
+        strings[ii] = sdscatprintf(sdsempty(), "key:%zu", ii);
+        strings[ii] = sdscat(strings[ii], ":value");
+        total += sdslen(strings[ii]);
+    }
+    for (size_t ii = 0; ii < STRINGS; ii++)
+        sdsfree(strings[ii]);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("%-8s %zu strings, %zu bytes in %.2f ms\n", label, (size_t)STRINGS, total, elapsed_ms(start, end));
+    return total;
+}
+
+int main(void) {
+    sds *strings = malloc(sizeof(sds) * STRINGS);
+    if (strings == NULL)
+        return 1;
+
+    // default: libc
+    size_t total = build_strings("libc", strings);
+
+    // arena: sdsfree is a no-op, everything goes away with one reset
+    BumpArena *arena = bumparena_create(1024 * 1024);
+    if (arena == NULL)
+        return 1;
+    Allocator arena_allocator = bumparena_allocator(arena);
+    const Allocator *prev = sds_set_allocator(&arena_allocator);
+    size_t built = build_strings("arena", strings);
+    assert(built == total);
+    printf("arena len %zu capacity %zu\n", arena->len, arena->capacity);
+    bumparena_reset(arena);
+
+    // the same chunks are reused by the next round
+    size_t capacity = arena->capacity;
+    built = build_strings("arena", strings);
+    assert(built == total);
+    assert(arena->capacity == capacity);
+    sds_set_allocator(prev);
+
+    // a string made in the arena can still be freed after switching back
+    sds_set_allocator(&arena_allocator);
+    sds in_arena = sdsnew("made in the arena");
+    sds_set_allocator(prev);
+    in_arena = sdscat(in_arena, ", grown later");
+    assert(strcmp(in_arena, "made in the arena, grown later") == 0);
+    sdsfree(in_arena);
+    bumparena_destroy(arena);
+
+    // size class pools: freed blocks are recycled
+    PoolSet *set = poolset_create(4096);
+    if (set == NULL)
+        return 1;
+    Allocator set_allocator = poolset_allocator(set);
+    prev = sds_set_allocator(&set_allocator);
+    built = build_strings("poolset", strings);
+    assert(built == total);
+    sds_set_allocator(prev);
+    poolset_destroy(set);
+
+    free(strings);
+    return 0;
+}
@@ -0,0 +1,435 @@
+/**
+ * Performance metrics for inter-thread queues
+ * Throughput and latency microbenchmark of the lock-free queues in utils
+ *
+ * This benchmark tests:
+ * - SPSC ring buffer throughput (one producer, one consumer)
+ * - The same ring protected by a pthread mutex, as a baseline
+ * - SPSC round trip latency (ping-pong between two threads, percentiles)
+ * - MPSC intrusive queue throughput with several producers
+ *
+ * Every run also checks FIFO order, so a broken queue fails loudly instead
+ * of reporting a great number.
+ *
+ * Usage:
+ *   ./perf-queue              # 10M items per test
+ *   ./perf-queue 1000000      # 1M items per test
+ *
+ * Compile with:
+ * gcc -Wall -Wextra -Wpedantic -O2 -g -std=c11 perf-queue.c ../utils/spscq.c ../utils/mpscq.c -lpthread
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "../utils/ilist.h"
+#include "../utils/mpscq.h"
+#include "../utils/spscq.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PERF_QUEUE_VERSION "1.0"
+
+#define DEFAULT_ITEMS 10000000 // items per throughput test
+#define QUEUE_CAPACITY 4096    // ring capacity (power of two)
+#define LATENCY_SAMPLES 100000 // round trips measured by the latency test
+#define MPSC_PRODUCERS 4       // producer threads for the MPSC test
+
+/**
+ * Busy wait step
+ * Spin a few times then yield, so the benchmark still progresses when
+ * producer and consumer share a single CPU
+ *
+ * @param spins spin counter owned by the caller, reset it after progress
+ */
+static void backoff(unsigned *spins) {
+    if (++(*spins) > 64) {
+        *spins = 0;
+        sched_yield();
+    }
+}
+
+/**
+ * Elapsed seconds between two timestamps
+ */
+static double elapsed_sec(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/* ---------------------------------------------------------------------- */
+/* SPSC throughput                                                        */
+/* ---------------------------------------------------------------------- */
+
+typedef struct
+{
+    SpscQueue *queue;
+    size_t items;
+} spsc_arg_t;
+
+static void *spsc_producer(void *arg) {
+    spsc_arg_t *a = (spsc_arg_t *)arg;
+    unsigned spins = 0;
+    for (size_t ii = 1; ii <= a->items; ii++) {
+        while (!spscq_push(a->queue, (void *)(uintptr_t)ii))
+            backoff(&spins);
+    }
+    return NULL;
+}
+
+/**
+ * SPSC throughput: one producer thread, the caller thread consumes
+ * @return million items per second, -1 on error
+ */
+static double bench_spsc(size_t items) {
+    SpscQueue *queue = spscq_create(QUEUE_CAPACITY);
+    if (queue == NULL)
+        return -1.0;
+
+    spsc_arg_t arg = {queue, items};
+    pthread_t producer;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (pthread_create(&producer, NULL, spsc_producer, &arg) != 0) {
+        spscq_destroy(queue);
+        return -1.0;
+    }
+
+    int ordered = 1;
+    unsigned spins = 0;
+    for (size_t ii = 1; ii <= items; ii++) {
+        void *elem;
+        while (!spscq_pop(queue, &elem))
+            backoff(&spins);
+        if ((uintptr_t)elem != ii)
+            ordered = 0;
+    }
+
+    pthread_join(producer, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    spscq_destroy(queue);
+
+    if (!ordered) {
+        fprintf(stderr, "SPSC: FIFO order violated\n");
+        return -1.0;
+    }
+    return items / elapsed_sec(start, end) / 1e6;
+}
+
+/* ---------------------------------------------------------------------- */
+/* Mutex ring baseline                                                    */
+/* ---------------------------------------------------------------------- */
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    size_t head;
+    size_t tail;
+    void *slots[QUEUE_CAPACITY];
+} mutex_ring_t;
+
+typedef struct
+{
+    mutex_ring_t *ring;
+    size_t items;
+} mutex_arg_t;
+
+static int mutex_ring_push(mutex_ring_t *ring, void *elem) {
+    int res = 0;
+    pthread_mutex_lock(&ring->lock);
+    if (ring->tail - ring->head < QUEUE_CAPACITY) {
+        ring->slots[ring->tail++ & (QUEUE_CAPACITY - 1)] = elem;
+        res = 1;
+    }
+    pthread_mutex_unlock(&ring->lock);
+    return res;
+}
+
+static int mutex_ring_pop(mutex_ring_t *ring, void **res) {
+    int ok = 0;
+    pthread_mutex_lock(&ring->lock);
+    if (ring->head != ring->tail) {
+        *res = ring->slots[ring->head++ & (QUEUE_CAPACITY - 1)];
+        ok = 1;
+    }
+    pthread_mutex_unlock(&ring->lock);
+    return ok;
+}
+
+static void *mutex_producer(void *arg) {
+    mutex_arg_t *a = (mutex_arg_t *)arg;
+    unsigned spins = 0;
+    for (size_t ii = 1; ii <= a->items; ii++) {
+        while (!mutex_ring_push(a->ring, (void *)(uintptr_t)ii))
+            backoff(&spins);
+    }
+    return NULL;
+}
+
+/**
+ * Same workload as bench_spsc with a mutex protected ring
+ * @return million items per second, -1 on error
+ */
+static double bench_mutex(size_t items) {
+    mutex_ring_t *ring = malloc(sizeof(mutex_ring_t));
+    if (ring == NULL)
+        return -1.0;
+    pthread_mutex_init(&ring->lock, NULL);
+    ring->head = 0;
+    ring->tail = 0;
+
+    mutex_arg_t arg = {ring, items};
+    pthread_t producer;
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (pthread_create(&producer, NULL, mutex_producer, &arg) != 0) {
+        free(ring);
+        return -1.0;
+    }
+
+    unsigned spins = 0;
+    for (size_t ii = 1; ii <= items; ii++) {
+        void *elem;
+        while (!mutex_ring_pop(ring, &elem))
+            backoff(&spins);
+    }
+
+    pthread_join(producer, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    pthread_mutex_destroy(&ring->lock);
+    free(ring);
+    return items / elapsed_sec(start, end) / 1e6;
+}
+
+/* ---------------------------------------------------------------------- */
+/* SPSC latency                                                           */
+/* ---------------------------------------------------------------------- */
+
+typedef struct
+{
+    SpscQueue *ping;
+    SpscQueue *pong;
+    size_t rounds;
+} pingpong_arg_t;
+
+static void *pong_thread(void *arg) {
+    pingpong_arg_t *a = (pingpong_arg_t *)arg;
+    unsigned spins = 0;
+    for (size_t ii = 0; ii < a->rounds; ii++) {
+        void *elem;
+        while (!spscq_pop(a->ping, &elem))
+            backoff(&spins);
+        while (!spscq_push(a->pong, elem))
+            backoff(&spins);
+    }
+    return NULL;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Round trip latency through two SPSC queues
+ * @param[out] samples LATENCY_SAMPLES round trip times (ns), sorted
+ * @return 1 if OK, 0 in case of error
+ */
+static int bench_latency(double *samples) {
+    SpscQueue *ping = spscq_create(2);
+    SpscQueue *pong = spscq_create(2);
+    if (ping == NULL || pong == NULL) {
+        spscq_destroy(ping);
+        spscq_destroy(pong);
+        return 0;
+    }
+
+    pingpong_arg_t arg = {ping, pong, LATENCY_SAMPLES};
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, pong_thread, &arg) != 0) {
+        spscq_destroy(ping);
+        spscq_destroy(pong);
+        return 0;
+    }
+
+    unsigned spins = 0;
+    for (size_t ii = 0; ii < LATENCY_SAMPLES; ii++) {
+        struct timespec start, end;
+        void *elem;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (!spscq_push(ping, (void *)(uintptr_t)(ii + 1)))
+            backoff(&spins);
+        while (!spscq_pop(pong, &elem))
+            backoff(&spins);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        samples[ii] = elapsed_sec(start, end) * 1e9;
+    }
+
+    pthread_join(thread, NULL);
+    spscq_destroy(ping);
+    spscq_destroy(pong);
+    qsort(samples, LATENCY_SAMPLES, sizeof(double), compare_double);
+    return 1;
+}
+
+/* ---------------------------------------------------------------------- */
+/* MPSC throughput                                                        */
+/* ---------------------------------------------------------------------- */
+
+typedef struct
+{
+    MpscNode node; // embedded queue link
+    size_t producer;
+    size_t seq;
+} mpsc_item_t;
+
+typedef struct
+{
+    MpscQueue *queue;
+    mpsc_item_t *items; // this producer slice
+    size_t count;
+} mpsc_arg_t;
+
+static void *mpsc_producer(void *arg) {
+    mpsc_arg_t *a = (mpsc_arg_t *)arg;
+    for (size_t ii = 0; ii < a->count; ii++)
+        mpscq_push(a->queue, &a->items[ii].node);
+    return NULL;
+}
+
+/**
+ * MPSC throughput: MPSC_PRODUCERS producers, the caller thread consumes
+ * @return million items per second, -1 on error
+ */
+static double bench_mpsc(size_t items) {
+    static MpscQueue queue; // static storage honors the cache line alignment
+    mpscq_init(&queue);
+
+    size_t per_producer = items / MPSC_PRODUCERS;
+    size_t total = per_producer * MPSC_PRODUCERS;
+    mpsc_item_t *all = malloc(sizeof(mpsc_item_t) * total);
+    if (all == NULL)
+        return -1.0;
+
+    mpsc_arg_t args[MPSC_PRODUCERS];
+    pthread_t producers[MPSC_PRODUCERS];
+    size_t expected[MPSC_PRODUCERS] = {0};
+
+    for (size_t pp = 0; pp < MPSC_PRODUCERS; pp++) {
+        args[pp].queue = &queue;
+        args[pp].items = &all[pp * per_producer];
+        args[pp].count = per_producer;
+        for (size_t ii = 0; ii < per_producer; ii++) {
+            args[pp].items[ii].producer = pp;
+            args[pp].items[ii].seq = ii;
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    size_t started = 0;
+    for (; started < MPSC_PRODUCERS; started++) {
+        if (pthread_create(&producers[started], NULL, mpsc_producer, &args[started]) != 0)
+            break;
+    }
+    if (started < MPSC_PRODUCERS) {
+        // cannot consume what has not been produced: drain and give up
+        for (size_t pp = 0; pp < started; pp++)
+            pthread_join(producers[pp], NULL);
+        free(all);
+        return -1.0;
+    }
+
+    // every producer slice must come out in its own push order
+    int ordered = 1;
+    unsigned spins = 0;
+    for (size_t ii = 0; ii < total; ii++) {
+        MpscNode *node;
+        while ((node = mpscq_pop(&queue)) == NULL)
+            backoff(&spins);
+        mpsc_item_t *item = container_of(node, mpsc_item_t, node);
+        if (item->seq != expected[item->producer]++)
+            ordered = 0;
+    }
+
+    for (size_t pp = 0; pp < MPSC_PRODUCERS; pp++)
+        pthread_join(producers[pp], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    free(all);
+
+    if (!ordered) {
+        fprintf(stderr, "MPSC: per producer FIFO order violated\n");
+        return -1.0;
+    }
+    return total / elapsed_sec(start, end) / 1e6;
+}
+
+/**
+ * Print help message
+ */
+static void print_help(void) {
+    printf("USAGE:\n");
+    printf("  perf-queue [OPTIONS] [ITEMS]\n\n");
+    printf("OPTIONS:\n");
+    printf("  -h, --help    Display this help message and exit\n\n");
+    printf("ARGUMENTS:\n");
+    printf("  ITEMS         Items per throughput test (default: %d)\n\n", DEFAULT_ITEMS);
+    printf("BENCHMARK TESTS:\n");
+    printf("  - SPSC ring throughput (lock-free vs mutex)\n");
+    printf("  - SPSC round trip latency (p50, p99, p99.9)\n");
+    printf("  - MPSC intrusive queue throughput (%d producers)\n\n", MPSC_PRODUCERS);
+}
+
+int main(int argc, char const *argv[]) {
+    printf("=== Performance metrics queues v%s ===\n\n", PERF_QUEUE_VERSION);
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        print_help();
+        return 0;
+    }
+
+    size_t items = DEFAULT_ITEMS;
+    if (argc > 1) {
+        long long selected = atoll(argv[1]);
+        if (selected < MPSC_PRODUCERS) {
+            fprintf(stderr, "Invalid items: must be at least %d\n\n", MPSC_PRODUCERS);
+            print_help();
+            return 1;
+        }
+        items = (size_t)selected;
+    }
+
+    printf("CPUs online: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+    printf("Items per test: %zu, ring capacity: %d\n\n", items, QUEUE_CAPACITY);
+
+    double spsc = bench_spsc(items);
+    double mutex = bench_mutex(items);
+    double mpsc = bench_mpsc(items);
+    double *samples = malloc(sizeof(double) * LATENCY_SAMPLES);
+    if (spsc < 0 || mutex < 0 || mpsc < 0 || samples == NULL || !bench_latency(samples)) {
+        fprintf(stderr, "Benchmark failed\n");
+        free(samples);
+        return 1;
+    }
+
+    printf("Throughput:\n");
+    printf("  SPSC lock-free: %8.2f Mitems/s\n", spsc);
+    printf("  SPSC mutex:     %8.2f Mitems/s\n", mutex);
+    printf("  MPSC lock-free: %8.2f Mitems/s (%d producers)\n\n", mpsc, MPSC_PRODUCERS);
+
+    printf("SPSC round trip latency (%d samples):\n", LATENCY_SAMPLES);
+    printf("  p50:   %8.0f ns\n", samples[LATENCY_SAMPLES / 2]);
+    printf("  p99:   %8.0f ns\n", samples[LATENCY_SAMPLES * 99 / 100]);
+    printf("  p99.9: %8.0f ns\n", samples[LATENCY_SAMPLES * 999 / 1000]);
+    printf("  max:   %8.0f ns\n", samples[LATENCY_SAMPLES - 1]);
+
+    free(samples);
+    return 0;
+}
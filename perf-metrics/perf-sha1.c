@@ -0,0 +1,604 @@
+/**
+ * Performance metrics for SHA-1 hashing
+ * Throughput and latency benchmark of sha1() and fsha1() in utils, with
+ * machine readable output to track regressions over releases
+ *
+ * This benchmark tests, for message sizes from 64 B to 1 GB (x4 steps):
+ * - sha1() of a buffer in memory
+ * - fsha1() of a file with the same content, hot (in the page cache) and
+ *   cold (its pages dropped with POSIX_FADV_DONTNEED before every call, no
+ *   root needed). Cold needs a disk backed directory: tmpfs pages cannot
+ *   be dropped
+ * - the same memory and hot file workloads on N threads at once
+ *   (aggregate throughput)
+ * - latency percentiles (p50, p99, p99.9, max) of single calls, for the
+ *   messages up to 4 KB
+ *
+ * Every row reports MB/s (10^6 bytes) and cycles/byte. Cycles are TSC
+ * ticks on x86-64: reference cycles at the nominal frequency, not core
+ * cycles under turbo. Elsewhere cycles/byte is not reported. With N threads
+ * cycles/byte is wall ticks x N / bytes, the single thread value when the
+ * scaling is perfect.
+ *
+ * Every hash is checked against sha1() of the same bytes, so a broken path
+ * fails loudly instead of reporting a great number.
+ *
+ * Usage:
+ *   ./perf-sha1                     # 64 B .. 1 GB, text report
+ *   ./perf-sha1 -f csv > sha1.csv   # one row per measure
+ *   ./perf-sha1 -f json -m 16M -t 4 # up to 16 MB, 4 threads
+ *
+ * Compile with:
+ * gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 perf-sha1.c ../utils/sha1.c ../utils/fileio.c -lpthread
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#define _POSIX_C_SOURCE 200809L
+#include "../utils/fileio.h"
+#include "../utils/sha1.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define PERF_SHA1_HAS_TSC 1
+#include <x86intrin.h>
+#endif
+
+#define PERF_SHA1_VERSION "1.0"
+
+#define MIN_SIZE 64                          // first message size
+#define DEFAULT_MAX_SIZE ((uint64_t)1 << 30) // last message size (1 GB)
+#define TARGET_BYTES ((uint64_t)256 << 20)   // bytes hashed per throughput measure
+#define COLD_BYTES ((uint64_t)64 << 20)      // bytes read per cold measure
+#define MAX_CALLS 1000000                    // sha1() calls per throughput measure
+#define FILE_MAX_CALLS 20000                 // fsha1() calls per hot measure
+#define COLD_MAX_CALLS 1000                  // fsha1() calls per cold measure
+#define LATENCY_MAX_SIZE 4096                // latency percentiles up to this size
+#define LATENCY_SAMPLES 100000               // sha1() calls timed one by one
+#define FILE_LATENCY_SAMPLES 10000           // hot fsha1() calls timed one by one
+#define MAX_THREADS 1024
+
+typedef enum {
+    OUT_TEXT, // human readable report
+    OUT_CSV,  // header + one line per measure
+    OUT_JSON  // one object, measures in "results"
+} OutFormat;
+
+/**
+ * One measure: a row of the report
+ */
+typedef struct
+{
+    const char *func;   // "sha1" or "fsha1"
+    const char *cache;  // "mem", "hot" or "cold"
+    const char *io;     // fsha1 I/O strategy (FILEIO_AUTO pick), NULL for sha1
+    uint64_t size;      // message size in bytes
+    size_t threads;     // threads hashing at once
+    uint64_t calls;     // calls per thread
+    double sec;         // time spent hashing (wall time with threads)
+    double mb_s;        // aggregate throughput
+    double cycles_byte; // < 0 if not available
+    bool has_latency;   // percentiles below are valid
+    double p50_ns;
+    double p99_ns;
+    double p999_ns;
+    double max_ns;
+} PerfRow;
+
+/**
+ * Calls of sha1() or fsha1() on one thread
+ */
+typedef struct
+{
+    const uint8_t *data;     // sha1: message
+    const char *path;        // fsha1: file with the same content, NULL for sha1
+    uint64_t size;           // message size
+    uint64_t calls;          // number of calls
+    bool cold;               // drop the file pages before every call
+    double *samples;         // per call latency (ns), NULL to time the whole loop
+    const uint8_t *expected; // sha1 of the message
+    uint64_t ticks;          // out: ticks spent hashing
+    bool ok;                 // out: every call succeeded with the expected hash
+} PerfJob;
+
+static double tick_hz = 1e9; // ticks per second, see calibrate_ticks
+
+/**
+ * Elapsed seconds between two timestamps
+ */
+static double elapsed_sec(struct timespec start, struct timespec end) {
+    return (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+/**
+ * Timestamp: TSC on x86-64 (lfence keeps it in program order), else ns
+ */
+static uint64_t now_ticks(void) {
+#ifdef PERF_SHA1_HAS_TSC
+    _mm_lfence();
+    uint64_t ticks = __rdtsc();
+    _mm_lfence();
+    return ticks;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/**
+ * TSC frequency against CLOCK_MONOTONIC (100 ms busy wait)
+ */
+static void calibrate_ticks(void) {
+#ifdef PERF_SHA1_HAS_TSC
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t first = now_ticks();
+    do {
+        clock_gettime(CLOCK_MONOTONIC, &now);
+    } while (elapsed_sec(start, now) < 0.1);
+    tick_hz = (now_ticks() - first) / elapsed_sec(start, now);
+#endif
+}
+
+/**
+ * Drop the page cache of a file (its pages only)
+ */
+static void drop_cache(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+    fdatasync(fd); // dirty pages cannot be dropped
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+static bool perf_job_hash(const PerfJob *job, uint8_t *hash) {
+    return job->path == NULL ? sha1(job->data, job->size, hash) : fsha1(job->path, hash);
+}
+
+static void *perf_job_run(void *arg) {
+    PerfJob *job = (PerfJob *)arg;
+    uint8_t hash[SHA1_LENGTH] = {0};
+    bool ok = true;
+
+    job->ticks = 0;
+    if (job->samples == NULL && !job->cold) {
+        uint64_t start = now_ticks();
+        for (uint64_t ii = 0; ii < job->calls; ii++)
+            ok = perf_job_hash(job, hash) && ok;
+        job->ticks = now_ticks() - start;
+    } else {
+        for (uint64_t ii = 0; ii < job->calls; ii++) {
+            if (job->cold)
+                drop_cache(job->path);
+            uint64_t start = now_ticks();
+            ok = perf_job_hash(job, hash) && ok;
+            uint64_t ticks = now_ticks() - start;
+            job->ticks += ticks;
+            if (job->samples != NULL)
+                job->samples[ii] = ticks * 1e9 / tick_hz;
+        }
+    }
+    job->ok = ok && memcmp(hash, job->expected, SHA1_LENGTH) == 0;
+    return NULL;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a;
+    double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Run job on threads threads at once and fill the throughput of row
+ *
+ * @return 1 if every hash is right, 0 otherwise
+ */
+static int perf_measure(const PerfJob *job, size_t threads, PerfRow *row) {
+    row->threads = threads;
+    row->calls = job->calls;
+    uint64_t bytes = job->size * job->calls * threads;
+    uint64_t ticks;
+    int ok = 1;
+
+    if (threads == 1) {
+        PerfJob single = *job;
+        perf_job_run(&single);
+        ticks = single.ticks; // cold: without the drop_cache calls
+        ok = single.ok;
+    } else {
+        PerfJob *jobs = malloc(threads * sizeof(PerfJob));
+        pthread_t *tids = malloc(threads * sizeof(pthread_t));
+        if (jobs == NULL || tids == NULL) {
+            perror("[perf_measure] malloc");
+            free(jobs);
+            free(tids);
+            return 0;
+        }
+
+        uint64_t start = now_ticks();
+        size_t started = 0;
+        for (; started < threads; started++) {
+            jobs[started] = *job;
+            if (pthread_create(&tids[started], NULL, perf_job_run, &jobs[started]) != 0)
+                break;
+        }
+        for (size_t ii = 0; ii < started; ii++) {
+            pthread_join(tids[ii], NULL);
+            ok = ok && jobs[ii].ok;
+        }
+        ticks = now_ticks() - start;
+        if (started < threads) {
+            fprintf(stderr, "[perf_measure] Cannot start %zu threads\n", threads);
+            ok = 0;
+        }
+        free(jobs);
+        free(tids);
+    }
+
+    row->sec = ticks / tick_hz;
+    row->mb_s = row->sec > 0 ? bytes / row->sec / 1e6 : 0;
+#ifdef PERF_SHA1_HAS_TSC
+    row->cycles_byte = (double)ticks * threads / bytes;
+#else
+    row->cycles_byte = -1.0;
+#endif
+    return ok;
+}
+
+/**
+ * Time samples calls of job one by one and fill the percentiles of row
+ *
+ * @return 1 if every hash is right, 0 otherwise
+ */
+static int perf_latency(const PerfJob *job, uint64_t samples, PerfRow *row) {
+    PerfJob single = *job;
+    single.calls = samples;
+    single.samples = malloc(samples * sizeof(double));
+    if (single.samples == NULL) {
+        perror("[perf_latency] malloc");
+        return 0;
+    }
+    perf_job_run(&single);
+
+    qsort(single.samples, samples, sizeof(double), compare_double);
+    row->has_latency = true;
+    row->p50_ns = single.samples[samples / 2];
+    row->p99_ns = single.samples[samples * 99 / 100];
+    row->p999_ns = single.samples[samples * 999 / 1000];
+    row->max_ns = single.samples[samples - 1];
+    free(single.samples);
+    return single.ok;
+}
+
+/**
+ * Calls of a measure: about target bytes, at least one, at most max_calls
+ */
+static uint64_t perf_calls(uint64_t size, uint64_t target, uint64_t max_calls) {
+    uint64_t calls = target / size;
+    if (calls < 1)
+        return 1;
+    return calls > max_calls ? max_calls : calls;
+}
+
+/**
+ * Human readable size: sizes are powers of 4 from 64 B
+ */
+static void format_size(uint64_t size, char *out, size_t out_len) {
+    static const char *units[] = {"B", "KB", "MB", "GB", "TB"};
+    size_t unit = 0;
+    while (size >= 1024 && size % 1024 == 0 && unit < 4) {
+        size /= 1024;
+        unit++;
+    }
+    snprintf(out, out_len, "%llu %s", (unsigned long long)size, units[unit]);
+}
+
+/**
+ * Print the report header (csv header, json opening, text banner)
+ */
+static void print_header(OutFormat format, size_t threads, uint64_t max_size) {
+    char max_str[32];
+    format_size(max_size, max_str, sizeof(max_str));
+#ifdef PERF_SHA1_HAS_TSC
+    const char *tick_source = "tsc";
+#else
+    const char *tick_source = "clock_monotonic";
+#endif
+
+    switch (format) {
+    case OUT_CSV:
+        printf("version,sha1_impl,func,cache,io,size,threads,calls,seconds,mb_s,cycles_per_byte,p50_ns,p99_ns,p999_ns,max_ns\n");
+        break;
+    case OUT_JSON:
+        printf("{\n");
+        printf("  \"version\": \"%s\",\n", PERF_SHA1_VERSION);
+        printf("  \"sha1_impl\": \"%s\",\n", sha1_impl_name(sha1_get_impl()));
+        printf("  \"cpus\": %ld,\n", sysconf(_SC_NPROCESSORS_ONLN));
+        printf("  \"threads\": %zu,\n", threads);
+        printf("  \"tick_source\": \"%s\",\n", tick_source);
+        printf("  \"tick_hz\": %.0f,\n", tick_hz);
+        printf("  \"results\": [");
+        break;
+    case OUT_TEXT:
+        printf("=== Performance metrics sha1 v%s ===\n\n", PERF_SHA1_VERSION);
+        printf("CPUs online: %ld, threads: %zu, sha1: %s\n", sysconf(_SC_NPROCESSORS_ONLN), threads,
+               sha1_impl_name(sha1_get_impl()));
+        printf("Sizes: 64 B .. %s, ticks: %s %.3f GHz\n\n", max_str, tick_source, tick_hz / 1e9);
+        printf("%-5s %-5s %-6s %8s %4s %10s %8s %9s %9s %9s %9s\n", "func", "cache", "io", "size", "thr", "MB/s",
+               "cyc/B", "p50 ns", "p99 ns", "p99.9 ns", "max ns");
+        break;
+    }
+}
+
+/**
+ * Print one measure
+ */
+static void print_row(OutFormat format, const PerfRow *row) {
+    static size_t rows = 0;
+    char size_str[32];
+
+    switch (format) {
+    case OUT_CSV:
+        printf("%s,%s,%s,%s,%s,%llu,%zu,%llu,%.6f,%.2f,", PERF_SHA1_VERSION, sha1_impl_name(sha1_get_impl()), row->func,
+               row->cache, row->io != NULL ? row->io : "", (unsigned long long)row->size, row->threads,
+               (unsigned long long)row->calls, row->sec, row->mb_s);
+        if (row->cycles_byte >= 0)
+            printf("%.3f", row->cycles_byte);
+        if (row->has_latency)
+            printf(",%.0f,%.0f,%.0f,%.0f\n", row->p50_ns, row->p99_ns, row->p999_ns, row->max_ns);
+        else
+            printf(",,,,\n");
+        break;
+    case OUT_JSON:
+        printf("%s\n    {\"func\": \"%s\", \"cache\": \"%s\", ", rows > 0 ? "," : "", row->func, row->cache);
+        if (row->io != NULL)
+            printf("\"io\": \"%s\", ", row->io);
+        else
+            printf("\"io\": null, ");
+        printf("\"size\": %llu, \"threads\": %zu, \"calls\": %llu, \"seconds\": %.6f, \"mb_s\": %.2f, ",
+               (unsigned long long)row->size, row->threads, (unsigned long long)row->calls, row->sec, row->mb_s);
+        if (row->cycles_byte >= 0)
+            printf("\"cycles_per_byte\": %.3f, ", row->cycles_byte);
+        else
+            printf("\"cycles_per_byte\": null, ");
+        if (row->has_latency)
+            printf("\"p50_ns\": %.0f, \"p99_ns\": %.0f, \"p999_ns\": %.0f, \"max_ns\": %.0f}", row->p50_ns, row->p99_ns,
+                   row->p999_ns, row->max_ns);
+        else
+            printf("\"p50_ns\": null, \"p99_ns\": null, \"p999_ns\": null, \"max_ns\": null}");
+        break;
+    case OUT_TEXT:
+        format_size(row->size, size_str, sizeof(size_str));
+        printf("%-5s %-5s %-6s %8s %4zu %10.1f ", row->func, row->cache, row->io != NULL ? row->io : "-", size_str,
+               row->threads, row->mb_s);
+        if (row->cycles_byte >= 0)
+            printf("%8.2f", row->cycles_byte);
+        else
+            printf("%8s", "-");
+        if (row->has_latency)
+            printf(" %9.0f %9.0f %9.0f %9.0f\n", row->p50_ns, row->p99_ns, row->p999_ns, row->max_ns);
+        else
+            printf(" %9s %9s %9s %9s\n", "-", "-", "-", "-");
+        break;
+    }
+    rows++;
+    fflush(stdout); // rows are streamed, a long run can be followed
+}
+
+/**
+ * Print the report footer
+ */
+static void print_footer(OutFormat format) {
+    if (format == OUT_JSON)
+        printf("\n  ]\n}\n");
+}
+
+/**
+ * Write the first size bytes of data to a new file in dir
+ *
+ * @param[out] path created file name, PATH_MAX sized
+ * @return 1 if OK, 0 in case of error
+ */
+static int create_file(const char *dir, const uint8_t *data, uint64_t size, char *path, size_t path_len) {
+    snprintf(path, path_len, "%s/perf-sha1-XXXXXX", dir);
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        fprintf(stderr, "[create_file] mkstemp in %s: %s\n", dir, strerror(errno));
+        return 0;
+    }
+
+    uint64_t done = 0;
+    while (done < size) {
+        ssize_t bytes_written = write(fd, data + done, size - done);
+        if (bytes_written < 0 && errno == EINTR)
+            continue;
+        if (bytes_written <= 0) {
+            fprintf(stderr, "[create_file] write %s: %s\n", path, strerror(errno));
+            close(fd);
+            unlink(path);
+            return 0;
+        }
+        done += (uint64_t)bytes_written;
+    }
+    close(fd);
+    return 1;
+}
+
+/**
+ * Every measure of one message size
+ *
+ * @return 1 if every hash is right, 0 otherwise
+ */
+static int bench_size(OutFormat format, const uint8_t *data, uint64_t size, size_t threads, const char *dir) {
+    uint8_t expected[SHA1_LENGTH];
+    sha1(data, size, expected);
+    int ok = 1;
+
+    // sha1() in memory
+    PerfJob job = {.data = data, .size = size, .expected = expected};
+    job.calls = perf_calls(size, TARGET_BYTES, MAX_CALLS);
+    PerfRow row = {.func = "sha1", .cache = "mem", .size = size};
+    ok = perf_measure(&job, 1, &row) && ok;
+    if (size <= LATENCY_MAX_SIZE)
+        ok = perf_latency(&job, LATENCY_SAMPLES, &row) && ok;
+    print_row(format, &row);
+    if (threads > 1) {
+        PerfRow mt = {.func = "sha1", .cache = "mem", .size = size};
+        ok = perf_measure(&job, threads, &mt) && ok;
+        print_row(format, &mt);
+    }
+
+    // fsha1() of a file with the same bytes
+    char path[4096];
+    if (!create_file(dir, data, size, path, sizeof(path)))
+        return 0;
+    const char *io = fileio_name(fileio_pick(size));
+
+    PerfJob file_job = {.path = path, .size = size, .expected = expected};
+    file_job.calls = perf_calls(size, TARGET_BYTES, FILE_MAX_CALLS);
+    uint8_t warm[SHA1_LENGTH];
+    fsha1(path, warm); // load the page cache
+    PerfRow hot = {.func = "fsha1", .cache = "hot", .io = io, .size = size};
+    ok = perf_measure(&file_job, 1, &hot) && ok;
+    if (size <= LATENCY_MAX_SIZE)
+        ok = perf_latency(&file_job, FILE_LATENCY_SAMPLES, &hot) && ok;
+    print_row(format, &hot);
+    if (threads > 1) {
+        PerfRow mt = {.func = "fsha1", .cache = "hot", .io = io, .size = size};
+        ok = perf_measure(&file_job, threads, &mt) && ok;
+        print_row(format, &mt);
+    }
+
+    // cold: every call is timed alone, after dropping the pages
+    file_job.cold = true;
+    file_job.calls = perf_calls(size, COLD_BYTES, COLD_MAX_CALLS);
+    PerfRow cold = {.func = "fsha1", .cache = "cold", .io = io, .size = size};
+    ok = perf_measure(&file_job, 1, &cold) && ok;
+    if (size <= LATENCY_MAX_SIZE)
+        ok = perf_latency(&file_job, file_job.calls, &cold) && ok;
+    print_row(format, &cold);
+
+    unlink(path);
+    if (!ok)
+        fprintf(stderr, "FAIL: wrong hash at size %llu\n", (unsigned long long)size);
+    return ok;
+}
+
+/**
+ * Size with an optional binary suffix: 512, 64K, 16M, 1G
+ *
+ * @return 0 if invalid
+ */
+static uint64_t parse_size(const char *str) {
+    char *end;
+    errno = 0;
+    unsigned long long value = strtoull(str, &end, 10);
+    if (errno != 0 || end == str || str[0] == '-')
+        return 0;
+    int shift = 0;
+    if (*end == 'K' || *end == 'k')
+        shift = 10;
+    else if (*end == 'M' || *end == 'm')
+        shift = 20;
+    else if (*end == 'G' || *end == 'g')
+        shift = 30;
+    if (shift > 0)
+        end++;
+    if (*end != '\0' || value > (UINT64_MAX >> shift))
+        return 0;
+    return (uint64_t)value << shift;
+}
+
+/**
+ * Print help message
+ */
+static void print_help(void) {
+    printf("USAGE:\n");
+    printf("  perf-sha1 [OPTIONS]\n\n");
+    printf("OPTIONS:\n");
+    printf("  -f FORMAT     Output: text (default), csv or json\n");
+    printf("  -m SIZE       Largest message, K/M/G suffixes (default: 1G)\n");
+    printf("  -t THREADS    Threads of the multi-thread measures (default: CPUs online)\n");
+    printf("  -d DIR        Directory of the temporary files (default: /tmp), disk backed for cold numbers\n");
+    printf("  -h, --help    Display this help message and exit\n\n");
+    printf("BENCHMARK TESTS (message sizes from %d B, x4 steps):\n", MIN_SIZE);
+    printf("  - sha1() in memory, 1 and THREADS threads\n");
+    printf("  - fsha1() hot (page cache), 1 and THREADS threads\n");
+    printf("  - fsha1() cold (pages dropped before every call)\n");
+    printf("  - latency p50, p99, p99.9, max up to %d B\n\n", LATENCY_MAX_SIZE);
+}
+
+int main(int argc, char const *argv[]) {
+    OutFormat format = OUT_TEXT;
+    uint64_t max_size = DEFAULT_MAX_SIZE;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t threads = cpus > 0 ? (size_t)cpus : 1;
+    const char *dir = "/tmp";
+
+    for (int ii = 1; ii < argc; ii++) {
+        if (strcmp(argv[ii], "-h") == 0 || strcmp(argv[ii], "--help") == 0) {
+            print_help();
+            return 0;
+        }
+        if (ii + 1 >= argc) {
+            fprintf(stderr, "Invalid option: %s\n\n", argv[ii]);
+            print_help();
+            return 1;
+        }
+        const char *value = argv[++ii];
+        if (strcmp(argv[ii - 1], "-f") == 0 && strcmp(value, "text") == 0) {
+            format = OUT_TEXT;
+        } else if (strcmp(argv[ii - 1], "-f") == 0 && strcmp(value, "csv") == 0) {
+            format = OUT_CSV;
+        } else if (strcmp(argv[ii - 1], "-f") == 0 && strcmp(value, "json") == 0) {
+            format = OUT_JSON;
+        } else if (strcmp(argv[ii - 1], "-m") == 0 && parse_size(value) >= MIN_SIZE) {
+            max_size = parse_size(value);
+        } else if (strcmp(argv[ii - 1], "-t") == 0 && atoi(value) >= 1 && atoi(value) <= MAX_THREADS) {
+            threads = (size_t)atoi(value);
+        } else if (strcmp(argv[ii - 1], "-d") == 0) {
+            dir = value;
+        } else {
+            fprintf(stderr, "Invalid option: %s %s\n\n", argv[ii - 1], value);
+            print_help();
+            return 1;
+        }
+    }
+    if (max_size > SIZE_MAX) {
+        fprintf(stderr, "Invalid size: larger than the address space\n");
+        return 1;
+    }
+
+    // pseudo random content, shared read only by every measure
+    uint8_t *data = malloc((size_t)max_size);
+    if (data == NULL) {
+        perror("Cannot allocate the message buffer");
+        return 1;
+    }
+    uint32_t seed = 0x12345678;
+    for (uint64_t ii = 0; ii < max_size; ii++) {
+        seed = seed * 1664525u + 1013904223u;
+        data[ii] = (uint8_t)(seed >> 24);
+    }
+
+    calibrate_ticks();
+    print_header(format, threads, max_size);
+    int res = 0;
+    for (uint64_t size = MIN_SIZE; size <= max_size; size *= 4) {
+        if (!bench_size(format, data, size, threads, dir))
+            res = 1;
+    }
+    print_footer(format);
+
+    free(data);
+    return res;
+}
@@ -37,6 +37,18 @@
  * the include of your alternate allocator if needed (not needed in order
  * to use the default libc allocator). */
 
+#ifdef SDS_ALLOCATOR
+/* -DSDS_ALLOCATOR routes every allocation through the allocator selected at
+ * run time with sds_set_allocator() (utils/sdsctx.h, link utils/sdsctx.c
+ * and utils/allocator.c). */
+void *sds_ctx_malloc(size_t size);
+void *sds_ctx_realloc(void *ptr, size_t size);
+void sds_ctx_free(void *ptr);
+#define s_malloc sds_ctx_malloc
+#define s_realloc sds_ctx_realloc
+#define s_free sds_ctx_free
+#else
 #define s_malloc malloc
 #define s_realloc realloc
 #define s_free free
+#endif
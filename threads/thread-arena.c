@@ -0,0 +1,143 @@
+/**
+ * Thread-local arenas
+ *
+ * Every worker builds a linked list of records allocated from its own
+ * thread-local arena (no lock, no atomic), then hands the arena off to a
+ * shared one before returning. After the join the main thread walks all the
+ * lists: the records are still valid and are freed at once with the shared
+ * arena.
+ *
+ * The main thread also swaps in a scratch arena with tlarena_set and restores
+ * its own one: the restored arena is still released by tlarena_destroy.
+ *
+ * gcc -Wall -Wextra -Wpedantic -O2 -g -std=c99 thread-arena.c ../utils/tlarena.c ../utils/bumparena.c ../utils/allocator.c -lpthread
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#include "../utils/tlarena.h"
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+
+#define NUM_WORKERS 4
+#define RECORDS_PER_WORKER 100000
+
+typedef struct record {
+    struct record *next;
+    int worker;
+    int value;
+} Record;
+
+typedef struct
+{
+    int id;
+    SharedArena *shared;
+    Record *head; // result: list built by the worker
+    int ok;       // result: 1 if the handoff succeeded
+} WorkerParam;
+
+void *worker(void *param) {
+    WorkerParam *wp = (WorkerParam *)param;
+    wp->head = NULL;
+
+    for (int ii = 0; ii < RECORDS_PER_WORKER; ii++) {
+        Record *rec = TLARENA_NEW(Record);
+        if (rec == NULL) {
+            tlarena_destroy();
+            wp->head = NULL;
+            wp->ok = 0;
+            return NULL;
+        }
+        rec->worker = wp->id;
+        rec->value = ii;
+        rec->next = wp->head;
+        wp->head = rec;
+    }
+
+    // the records outlive the thread: give them to the shared arena
+    wp->ok = tlarena_handoff(wp->shared);
+    if (!wp->ok)
+        tlarena_destroy();
+    return NULL;
+}
+
+/**
+ * @brief Swap in a scratch arena, then restore the thread arena
+ *
+ * @return 1 if good, 0 in case of error
+ */
+int scratch_swap(void) {
+    int *mine = TLARENA_NEW(int); // creates the thread arena
+    if (mine == NULL)
+        return 0;
+    *mine = 42;
+
+    BumpArena *scratch = bumparena_create(1024);
+    if (scratch == NULL) {
+        tlarena_destroy();
+        return 0;
+    }
+    BumpArena *prev = tlarena_set(scratch);
+    assert(prev != NULL && prev != scratch);
+
+    int *tmp = TLARENA_NEW(int);
+    assert(tmp != NULL && scratch->len > 0);
+    *tmp = 7;
+
+    if (tlarena_set(prev) != scratch) {
+        bumparena_destroy(scratch);
+        tlarena_destroy();
+        return 0;
+    }
+    assert(tlarena_get() == prev && *mine == 42);
+    bumparena_destroy(scratch);
+
+    // the restored arena is owned again: released here, no leak
+    tlarena_destroy();
+    return 1;
+}
+
+int main(void) {
+    if (!scratch_swap())
+        return 1;
+
+    SharedArena *shared = sharedarena_create(1024);
+    if (shared == NULL)
+        return 1;
+
+    pthread_t threads[NUM_WORKERS];
+    WorkerParam params[NUM_WORKERS];
+    for (int ii = 0; ii < NUM_WORKERS; ii++) {
+        params[ii].id = ii;
+        params[ii].shared = shared;
+        if (pthread_create(&threads[ii], NULL, worker, &params[ii]) != 0) {
+            fprintf(stderr, "Cannot create thread %d\n", ii);
+            return 1;
+        }
+    }
+    for (int ii = 0; ii < NUM_WORKERS; ii++)
+        pthread_join(threads[ii], NULL);
+
+    // the main thread can keep using the shared arena
+    int *total = sharedarena_alloc(shared, sizeof(int), BUMPARENA_ALIGNOF(int));
+    assert(total != NULL);
+    *total = 0;
+
+    for (int ii = 0; ii < NUM_WORKERS; ii++) {
+        assert(params[ii].ok);
+        int expected = RECORDS_PER_WORKER - 1;
+        for (Record *rec = params[ii].head; rec != NULL; rec = rec->next) {
+            assert(rec->worker == ii && rec->value == expected);
+            expected--;
+            (*total)++;
+        }
+        assert(expected == -1);
+    }
+    assert(*total == NUM_WORKERS * RECORDS_PER_WORKER);
+
+    printf("records: %d shared arena len: %zu capacity: %zu\n",
+           *total, shared->arena->len, shared->arena->capacity);
+
+    sharedarena_destroy(shared);
+    return 0;
+}
@@ -4,39 +4,55 @@
 
 /** @copydoc al_create */
 AList *al_create(size_t capacity, ALType type) {
-    if (capacity == 0) {
+    return al_create_with(capacity, type, NULL);
+}
+
+/** @copydoc al_create_with */
+AList *al_create_with(size_t capacity, ALType type, const Allocator *allocator) {
+    if (capacity == 0 || capacity > SIZE_MAX / sizeof(void *)) {
         fprintf(stderr, "[al_create] Invalid capacity\n");
         return NULL;
     }
 
-    AList *list = malloc(sizeof(AList));
+    allocator = allocator_or_default(allocator);
+    AList *list = allocator_alloc(allocator, sizeof(AList));
     if (list == NULL) {
         perror("[al_create] Cannot create a new array list");
         return NULL;
     }
+    list->allocator = *allocator;
     list->capacity = capacity;
     list->size = 0;
     list->type = type;
-    list->data = malloc(sizeof(void *) * capacity);
+    list->data = allocator_alloc(allocator, sizeof(void *) * capacity);
     if (list->data == NULL) {
         perror("[al_create] Cannot create a new array list");
-        free(list);
+        allocator_free(allocator, list, sizeof(AList));
         return NULL;
     }
     return list;
 }
 
+/**
+ * @brief Release the data array and the list structure
+ *
+ * @param[in] list List pointer
+ */
+static void al_free(AList *list) {
+    Allocator allocator = list->allocator; // the list itself is released last
+    if (list->data != NULL)
+        allocator_free(&allocator, list->data, sizeof(void *) * list->capacity);
+    list->capacity = 0;
+    list->size = 0;
+    allocator_free(&allocator, list, sizeof(AList));
+}
+
 /** @copydoc al_destroy */
 void al_destroy(AList *list) {
     if (list == NULL)
         return;
 
-    if (list->data != NULL)
-        free(list->data);
-
-    list->capacity = 0;
-    list->size = 0;
-    free(list);
+    al_free(list);
 }
 
 /** @copydoc al_destroy_deep */
@@ -47,12 +63,9 @@ void al_destroy_deep(AList *list) {
     if (list->data != NULL) {
         for (size_t ii = 0; ii < list->size; ii++)
             free(list->data[ii]);
-        free(list->data);
     }
 
-    list->capacity = 0;
-    list->size = 0;
-    free(list);
+    al_free(list);
 }
 
 /**
@@ -66,7 +79,8 @@ void al_destroy_deep(AList *list) {
 static size_t al_grow(AList *list) {
     // resize with double capacity
     size_t new_capacity = list->capacity * 2;
-    void *temp = realloc(list->data, sizeof(void *) * new_capacity);
+    void *temp = allocator_realloc(&list->allocator, list->data, sizeof(void *) * list->capacity,
+                                   sizeof(void *) * new_capacity);
     if (!temp) {
         perror("[al_grow] Reallocation failed! The old data are still valid");
         return 0;
@@ -93,7 +107,8 @@ static size_t al_shrink(AList *list) {
     if (new_capacity < 2)
         return list->capacity;
 
-    void *temp = realloc(list->data, sizeof(void *) * new_capacity);
+    void *temp = allocator_realloc(&list->allocator, list->data, sizeof(void *) * list->capacity,
+                                   sizeof(void *) * new_capacity);
     if (!temp) {
         perror("[al_shrink] Reallocation failed! The old data are still valid");
         return 0;
@@ -25,6 +25,7 @@
  */
 #ifndef ALIST_H
 #define ALIST_H
+#include "allocator.h"
 #include <stdlib.h>
 
 /**
@@ -48,10 +49,11 @@ typedef enum {
  */
 typedef struct
 {
-    size_t capacity; // Maximum number of elements before reallocation
-    size_t size;     // Current number of elements in the list
-    void **data;     // Array of pointers to elements
-    ALType type;     // Type constraint for all elements
+    size_t capacity;     // Maximum number of elements before reallocation
+    size_t size;         // Current number of elements in the list
+    void **data;         // Array of pointers to elements
+    ALType type;         // Type constraint for all elements
+    Allocator allocator; // Allocator of the list structure and of the data array
 } AList;
 
 /**
@@ -80,6 +82,30 @@ typedef struct
  */
 AList *al_create(size_t capacity, ALType type);
 
+/**
+ * @brief Create a new array list using a custom allocator
+ *
+ * Same as al_create() but the list structure and the data array are
+ * allocated with allocator (see allocator.h). Element data released by the
+ * *_deep functions is still freed with free().
+ *
+ * @param[in] capacity Initial number of elements the list can hold without reallocation
+ * @param[in] type Type of elements this list will store
+ * @param[in] allocator Allocator to use, NULL means libc
+ *
+ * @return Pointer to the newly created AList, or NULL if allocation fails
+ *
+ * Example:
+ * @code
+ * BumpArena *arena = bumparena_create(4096);
+ * Allocator allocator = bumparena_allocator(arena);
+ * AList *names = al_create_with(16, AL_TYPE_STR, &allocator);
+ * // ... use names ...
+ * bumparena_destroy(arena); // releases the list too
+ * @endcode
+ */
+AList *al_create_with(size_t capacity, ALType type, const Allocator *allocator);
+
 /**
  * @brief Destroy the array list structure without freeing element data
  *
@@ -0,0 +1,35 @@
+#include "allocator.h"
+#include <stdlib.h>
+
+/**
+ * @brief malloc adapter
+ */
+static void *libc_alloc(void *ctx, size_t size) {
+    (void)ctx;
+    return malloc(size);
+}
+
+/**
+ * @brief realloc adapter
+ */
+static void *libc_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+    (void)ctx;
+    (void)old_size;
+    return realloc(ptr, new_size);
+}
+
+/**
+ * @brief free adapter
+ */
+static void libc_free(void *ctx, void *ptr, size_t size) {
+    (void)ctx;
+    (void)size;
+    free(ptr);
+}
+
+static const Allocator LIBC_ALLOCATOR = {libc_alloc, libc_realloc, libc_free, NULL};
+
+/** @copydoc allocator_default */
+const Allocator *allocator_default(void) {
+    return &LIBC_ALLOCATOR;
+}
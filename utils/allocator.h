@@ -0,0 +1,97 @@
+/**
+ * @brief Pluggable allocator interface
+ *
+ * Allocator is a small vtable (alloc/realloc/free plus an opaque context)
+ * that the utils containers take at creation (e.g. hmap_create_with,
+ * al_create_with, ll_create_with, bumparena_create_with). It lets the caller
+ * route every internal allocation of a container to libc, a BumpArena, a
+ * Pool or an instrumented allocator without touching the container code.
+ *
+ * The interface is sized: realloc and free receive the size of the block,
+ * which the containers always know. Allocators that keep no per-block header
+ * (arena, pool) rely on it.
+ *
+ * Containers store the Allocator by value: the struct passed at creation can
+ * be a temporary, but its context must outlive the container.
+ *
+ * Available allocators:
+ * - allocator_default(): libc malloc/realloc/free (what a NULL allocator means)
+ * - bumparena_allocator() in bumparena.h: free is a no-op, everything is
+ *   released with the arena (one shot cleanup of a whole request)
+ * - pool_allocator() in pool.h: fixed-size blocks only
+ *
+ * Element data owned by the containers (the *_deep functions) is still
+ * released with libc free(): the allocator only serves container internals.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define ALLOCATOR_ALIGN (2 * sizeof(void *)) // alignment of the blocks, same as glibc malloc
+
+typedef struct
+{
+    // allocate size bytes, NULL in case of error
+    void *(*alloc)(void *ctx, size_t size);
+    // resize a block of old_size bytes, NULL in case of error (the old block is still valid)
+    void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+    // release a block of size bytes (ptr can be NULL)
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx; // allocator state passed to every call
+} Allocator;
+
+/**
+ * @brief libc allocator
+ *
+ * @return pointer to a static allocator, never NULL
+ */
+const Allocator *allocator_default(void);
+
+/**
+ * @brief Allocator to use for a container
+ *
+ * @param[in] allocator allocator passed by the caller (can be NULL)
+ * @return allocator, or allocator_default() when NULL
+ */
+static inline const Allocator *allocator_or_default(const Allocator *allocator) {
+    return allocator != NULL ? allocator : allocator_default();
+}
+
+/**
+ * @brief Allocate size bytes
+ */
+static inline void *allocator_alloc(const Allocator *allocator, size_t size) {
+    return allocator->alloc(allocator->ctx, size);
+}
+
+/**
+ * @brief Allocate count * size zeroed bytes, NULL on overflow
+ */
+static inline void *allocator_calloc(const Allocator *allocator, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size)
+        return NULL;
+    void *ptr = allocator->alloc(allocator->ctx, count * size);
+    if (ptr != NULL)
+        memset(ptr, 0, count * size);
+    return ptr;
+}
+
+/**
+ * @brief Resize a block of old_size bytes to new_size bytes
+ */
+static inline void *allocator_realloc(const Allocator *allocator, void *ptr, size_t old_size, size_t new_size) {
+    return allocator->realloc(allocator->ctx, ptr, old_size, new_size);
+}
+
+/**
+ * @brief Release a block of size bytes
+ */
+static inline void allocator_free(const Allocator *allocator, void *ptr, size_t size) {
+    allocator->free(allocator->ctx, ptr, size);
+}
+
+#endif // ALLOCATOR_H
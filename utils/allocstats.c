@@ -0,0 +1,341 @@
+#include "allocstats.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ALLOCSTATS_AT_EXIT 8 // stats that can be reported at exit
+
+static AllocStats *at_exit_stats[ALLOCSTATS_AT_EXIT];
+static int at_exit_registered = 0;
+
+/**
+ * @brief Histogram bucket of a size: number of significant bits
+ */
+static size_t allocstats_bucket(size_t size) {
+    size_t bucket = 0;
+    while (size > 0 && bucket < ALLOCSTATS_BUCKETS - 1) {
+        size >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void *allocstats_site_alloc(void *ctx, size_t size);
+static void *allocstats_site_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size);
+static void allocstats_site_free(void *ctx, void *ptr, size_t size);
+
+/**
+ * @brief Find or add the file:line call site (lock held)
+ *
+ * @return site pointer or NULL when the table is full
+ */
+static AllocSite *allocstats_site(AllocStats *stats, const char *file, int line) {
+    uintptr_t key = (uintptr_t)file ^ ((uintptr_t)line * 0x9e3779b97f4a7c15ULL);
+    size_t idx = (size_t)((key >> 4) ^ (key >> 16)) % ALLOCSTATS_SITES;
+
+    for (size_t probe = 0; probe < ALLOCSTATS_SITES; probe++) {
+        AllocSite *site = &stats->sites[(idx + probe) % ALLOCSTATS_SITES];
+        if (site->file == NULL) {
+            site->allocator.alloc = allocstats_site_alloc;
+            site->allocator.realloc = allocstats_site_realloc;
+            site->allocator.free = allocstats_site_free;
+            site->allocator.ctx = site;
+            site->stats = stats;
+            site->file = file;
+            site->line = line;
+            return site;
+        }
+        if (site->line == line && (site->file == file || strcmp(site->file, file) == 0))
+            return site;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Record a request on its call site, NULL means no site (lock held)
+ */
+static void allocstats_count_site(AllocStats *stats, AllocSite *site, size_t size) {
+    if (site == NULL) {
+        stats->other_count++;
+        stats->other_bytes += size;
+        return;
+    }
+    site->count++;
+    site->bytes += size;
+}
+
+/**
+ * @brief Record a successful allocation of size bytes (lock held)
+ */
+static void allocstats_grow_live(AllocStats *stats, size_t size) {
+    stats->bytes_total += size;
+    stats->histogram[allocstats_bucket(size)]++;
+    stats->live_bytes += size;
+    if (stats->live_bytes > stats->peak_bytes)
+        stats->peak_bytes = stats->live_bytes;
+}
+
+/**
+ * @brief Instrumented alloc
+ */
+static void *allocstats_record_alloc(AllocStats *stats, AllocSite *site, size_t size) {
+    void *ptr = allocator_alloc(&stats->inner, size);
+
+    pthread_mutex_lock(&stats->lock);
+    if (ptr == NULL) {
+        stats->failures++;
+    } else {
+        stats->allocs++;
+        allocstats_grow_live(stats, size);
+        if (++stats->live_blocks > stats->peak_blocks)
+            stats->peak_blocks = stats->live_blocks;
+        allocstats_count_site(stats, site, size);
+    }
+    pthread_mutex_unlock(&stats->lock);
+    return ptr;
+}
+
+/**
+ * @brief Instrumented realloc
+ */
+static void *allocstats_record_realloc(AllocStats *stats, AllocSite *site, void *ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL)
+        return allocstats_record_alloc(stats, site, new_size);
+
+    void *res = allocator_realloc(&stats->inner, ptr, old_size, new_size);
+
+    pthread_mutex_lock(&stats->lock);
+    if (res == NULL) {
+        stats->failures++;
+    } else {
+        stats->reallocs++;
+        stats->live_bytes -= old_size;
+        allocstats_grow_live(stats, new_size);
+        stats->bytes_total -= new_size < old_size ? new_size : old_size; // count only the new bytes
+        allocstats_count_site(stats, site, new_size);
+    }
+    pthread_mutex_unlock(&stats->lock);
+    return res;
+}
+
+/**
+ * @brief Instrumented free
+ */
+static void allocstats_record_free(AllocStats *stats, void *ptr, size_t size) {
+    if (ptr == NULL)
+        return;
+
+    allocator_free(&stats->inner, ptr, size);
+
+    pthread_mutex_lock(&stats->lock);
+    stats->frees++;
+    stats->live_bytes -= size;
+    stats->live_blocks--;
+    pthread_mutex_unlock(&stats->lock);
+}
+
+/**
+ * @brief Allocator alloc adapter (no site)
+ */
+static void *allocstats_alloc(void *ctx, size_t size) {
+    return allocstats_record_alloc(ctx, NULL, size);
+}
+
+/**
+ * @brief Allocator realloc adapter (no site)
+ */
+static void *allocstats_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+    return allocstats_record_realloc(ctx, NULL, ptr, old_size, new_size);
+}
+
+/**
+ * @brief Allocator free adapter (no site)
+ */
+static void allocstats_free(void *ctx, void *ptr, size_t size) {
+    allocstats_record_free(ctx, ptr, size);
+}
+
+/**
+ * @brief Site allocator alloc adapter
+ */
+static void *allocstats_site_alloc(void *ctx, size_t size) {
+    AllocSite *site = ctx;
+    return allocstats_record_alloc(site->stats, site, size);
+}
+
+/**
+ * @brief Site allocator realloc adapter
+ */
+static void *allocstats_site_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+    AllocSite *site = ctx;
+    return allocstats_record_realloc(site->stats, site, ptr, old_size, new_size);
+}
+
+/**
+ * @brief Site allocator free adapter
+ */
+static void allocstats_site_free(void *ctx, void *ptr, size_t size) {
+    AllocSite *site = ctx;
+    allocstats_record_free(site->stats, ptr, size);
+}
+
+/** @copydoc allocstats_create */
+AllocStats *allocstats_create(const Allocator *inner) {
+    AllocStats *stats = calloc(1, sizeof(AllocStats));
+    if (stats == NULL) {
+        perror("[allocstats_create] out of memory");
+        return NULL;
+    }
+    if (pthread_mutex_init(&stats->lock, NULL) != 0) {
+        fprintf(stderr, "[allocstats_create] Cannot init the mutex\n");
+        free(stats);
+        return NULL;
+    }
+    stats->inner = *allocator_or_default(inner);
+    stats->allocator.alloc = allocstats_alloc;
+    stats->allocator.realloc = allocstats_realloc;
+    stats->allocator.free = allocstats_free;
+    stats->allocator.ctx = stats;
+    return stats;
+}
+
+/** @copydoc allocstats_destroy */
+void allocstats_destroy(AllocStats *stats) {
+    if (stats == NULL)
+        return;
+    for (size_t ii = 0; ii < ALLOCSTATS_AT_EXIT; ii++) {
+        if (at_exit_stats[ii] == stats)
+            at_exit_stats[ii] = NULL;
+    }
+    pthread_mutex_destroy(&stats->lock);
+    free(stats);
+}
+
+/** @copydoc allocstats_at */
+const Allocator *allocstats_at(AllocStats *stats, const char *file, int line) {
+    pthread_mutex_lock(&stats->lock);
+    AllocSite *site = allocstats_site(stats, file, line);
+    pthread_mutex_unlock(&stats->lock);
+    if (site == NULL) {
+        fprintf(stderr, "[allocstats_at] too many call sites, %s:%d has no site\n", file, line);
+        return &stats->allocator;
+    }
+    return &site->allocator;
+}
+
+/** @copydoc allocstats_alloc_at */
+void *allocstats_alloc_at(AllocStats *stats, size_t size, const char *file, int line) {
+    return allocator_alloc(allocstats_at(stats, file, line), size);
+}
+
+/** @copydoc allocstats_track_arena */
+int allocstats_track_arena(AllocStats *stats, const BumpArena *arena, const char *name) {
+    int res = 0;
+    pthread_mutex_lock(&stats->lock);
+    for (size_t ii = 0; ii < ALLOCSTATS_ARENAS; ii++) {
+        if (stats->arenas[ii] == NULL) {
+            stats->arenas[ii] = arena;
+            stats->arena_names[ii] = name;
+            res = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&stats->lock);
+    if (!res)
+        fprintf(stderr, "[allocstats_track_arena] too many arenas\n");
+    return res;
+}
+
+/** @copydoc allocstats_untrack_arena */
+void allocstats_untrack_arena(AllocStats *stats, const BumpArena *arena) {
+    pthread_mutex_lock(&stats->lock);
+    for (size_t ii = 0; ii < ALLOCSTATS_ARENAS; ii++) {
+        if (stats->arenas[ii] == arena)
+            stats->arenas[ii] = NULL;
+    }
+    pthread_mutex_unlock(&stats->lock);
+}
+
+/**
+ * @brief Sort sites by descending bytes (qsort callback)
+ */
+static int allocstats_cmp_site(const void *a, const void *b) {
+    const AllocSite *sa = a;
+    const AllocSite *sb = b;
+    if (sa->bytes != sb->bytes)
+        return sa->bytes < sb->bytes ? 1 : -1;
+    return sa->count < sb->count ? 1 : (sa->count > sb->count ? -1 : 0);
+}
+
+/** @copydoc allocstats_report */
+void allocstats_report(AllocStats *stats, FILE *out) {
+    pthread_mutex_lock(&stats->lock);
+
+    fprintf(out, "=== allocation report ===\n");
+    fprintf(out, "allocs: %zu reallocs: %zu frees: %zu failures: %zu\n",
+            stats->allocs, stats->reallocs, stats->frees, stats->failures);
+    fprintf(out, "requested: %zu bytes, live: %zu bytes in %zu blocks, peak: %zu bytes in %zu blocks\n",
+            stats->bytes_total, stats->live_bytes, stats->live_blocks, stats->peak_bytes, stats->peak_blocks);
+
+    fprintf(out, "size histogram:\n");
+    for (size_t ii = 0; ii < ALLOCSTATS_BUCKETS; ii++) {
+        if (stats->histogram[ii] == 0)
+            continue;
+        size_t low = ii == 0 ? 0 : (size_t)1 << (ii - 1);
+        fprintf(out, "  [%zu, %zu] %zu\n", low, ii == 0 ? 0 : ((size_t)1 << ii) - 1, stats->histogram[ii]);
+    }
+
+    // sort a copy of the sites, the table uses open addressing
+    AllocSite sites[ALLOCSTATS_SITES];
+    size_t len = 0;
+    for (size_t ii = 0; ii < ALLOCSTATS_SITES; ii++) {
+        if (stats->sites[ii].count > 0) // sites with no allocation yet are not shown
+            sites[len++] = stats->sites[ii];
+    }
+    qsort(sites, len, sizeof(AllocSite), allocstats_cmp_site);
+    fprintf(out, "call sites (by bytes):\n");
+    for (size_t ii = 0; ii < len; ii++)
+        fprintf(out, "  %s:%d count: %zu bytes: %zu\n", sites[ii].file, sites[ii].line, sites[ii].count, sites[ii].bytes);
+    if (stats->other_count > 0)
+        fprintf(out, "  no site count: %zu bytes: %zu\n", stats->other_count, stats->other_bytes);
+
+    for (size_t ii = 0; ii < ALLOCSTATS_ARENAS; ii++) {
+        const BumpArena *arena = stats->arenas[ii];
+        if (arena == NULL)
+            continue;
+        fprintf(out, "arena %s: len: %zu high water: %zu capacity: %zu\n",
+                stats->arena_names[ii] != NULL ? stats->arena_names[ii] : "?",
+                arena->len, arena->high_water, arena->capacity);
+    }
+
+    pthread_mutex_unlock(&stats->lock);
+}
+
+/**
+ * @brief atexit handler
+ */
+static void allocstats_exit_handler(void) {
+    for (size_t ii = 0; ii < ALLOCSTATS_AT_EXIT; ii++) {
+        if (at_exit_stats[ii] != NULL)
+            allocstats_report(at_exit_stats[ii], stderr);
+    }
+}
+
+/** @copydoc allocstats_report_at_exit */
+int allocstats_report_at_exit(AllocStats *stats) {
+    if (!at_exit_registered) {
+        if (atexit(allocstats_exit_handler) != 0) {
+            fprintf(stderr, "[allocstats_report_at_exit] Cannot register the handler\n");
+            return 0;
+        }
+        at_exit_registered = 1;
+    }
+    for (size_t ii = 0; ii < ALLOCSTATS_AT_EXIT; ii++) {
+        if (at_exit_stats[ii] == NULL || at_exit_stats[ii] == stats) {
+            at_exit_stats[ii] = stats;
+            return 1;
+        }
+    }
+    fprintf(stderr, "[allocstats_report_at_exit] too many reports\n");
+    return 0;
+}
@@ -0,0 +1,164 @@
+/**
+ * @brief Allocation instrumentation (opt-in)
+ *
+ * AllocStats wraps another Allocator and records, for every call:
+ * - alloc/realloc/free/failure counts and the total requested bytes
+ * - live and peak bytes / blocks
+ * - a power of two size histogram (bucket ii counts sizes in [2^(ii-1), 2^ii))
+ * - per call site counts and bytes
+ *
+ * Call sites are file:line pairs. ALLOCSTATS_AT(stats) returns an allocator
+ * bound to the line where it is written: pass it to *_create_with and every
+ * internal allocation of the container is reported on the line that created
+ * it. Direct allocations made with ALLOCSTATS_ALLOC / ALLOCSTATS_FREE are
+ * recorded with their own file:line. Allocations made through
+ * &stats->allocator have no site and are grouped as "no site".
+ *
+ * BumpArena instances can be registered with allocstats_track_arena: the
+ * report shows their capacity, current len and high-water mark.
+ *
+ * allocstats_report_at_exit prints the report to stderr when the program
+ * exits. The statistics are protected by a mutex: one AllocStats can be
+ * shared by several threads.
+ *
+ * Usage:
+ * @code
+ * AllocStats *stats = allocstats_create(NULL); // wraps libc
+ * allocstats_report_at_exit(stats);
+ * HMap *map = hmap_create_with(1024, ALLOCSTATS_AT(stats)); // reported on this line
+ * @endcode
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+#include "allocator.h"
+#include "bumparena.h"
+#include <pthread.h>
+#include <stdio.h>
+
+#define ALLOCSTATS_SITES 128   // distinct call sites recorded (then grouped as "no site")
+#define ALLOCSTATS_BUCKETS 48  // histogram buckets: up to 2^47 bytes
+#define ALLOCSTATS_ARENAS 16   // arenas that can be tracked
+
+struct allocstats;
+
+/**
+ * Allocation call site
+ */
+typedef struct
+{
+    Allocator allocator;      // allocator returned by ALLOCSTATS_AT, ctx is the site
+    struct allocstats *stats; // owner of the site
+    const char *file;         // source file
+    int line;                 // source line
+    size_t count;             // allocations and reallocations from this site
+    size_t bytes;             // bytes requested from this site
+} AllocSite;
+
+typedef struct allocstats
+{
+    Allocator allocator;                          // instrumented allocator to hand to containers
+    Allocator inner;                              // allocator doing the real work
+    pthread_mutex_t lock;                         // protects every counter
+    size_t allocs;                                // successful alloc calls
+    size_t reallocs;                              // successful realloc calls
+    size_t frees;                                 // free calls (ptr != NULL)
+    size_t failures;                              // alloc/realloc that returned NULL
+    size_t bytes_total;                           // bytes requested by alloc/realloc
+    size_t live_bytes;                            // bytes currently allocated
+    size_t peak_bytes;                            // max live_bytes
+    size_t live_blocks;                           // blocks currently allocated
+    size_t peak_blocks;                           // max live_blocks
+    size_t histogram[ALLOCSTATS_BUCKETS];         // request size histogram
+    AllocSite sites[ALLOCSTATS_SITES];            // call sites (open addressing)
+    size_t other_count;                           // allocations with no site (or sites that did not fit)
+    size_t other_bytes;                           // bytes requested with no site
+    const BumpArena *arenas[ALLOCSTATS_ARENAS];   // tracked arenas
+    const char *arena_names[ALLOCSTATS_ARENAS];   // tracked arena labels
+} AllocStats;
+
+/**
+ * @brief Create an instrumented allocator
+ *
+ * @param[in] inner allocator doing the real work, NULL means libc (copied)
+ * @return stats pointer or NULL in case of error
+ */
+AllocStats *allocstats_create(const Allocator *inner);
+
+/**
+ * @brief Destroy the statistics
+ *
+ * Blocks still allocated are not released. Unregisters the at exit report.
+ *
+ * @param[in] stats stats pointer (can be NULL)
+ */
+void allocstats_destroy(AllocStats *stats);
+
+/**
+ * @brief Allocator recording a file:line call site (see ALLOCSTATS_AT)
+ *
+ * The allocator lives in the stats: it stays valid until allocstats_destroy.
+ *
+ * @param[in] stats stats pointer
+ * @param[in] file source file (not copied)
+ * @param[in] line source line
+ * @return site allocator, or &stats->allocator when the site table is full
+ */
+const Allocator *allocstats_at(AllocStats *stats, const char *file, int line);
+
+/**
+ * @brief Allocator reporting its allocations on the current file:line
+ */
+#define ALLOCSTATS_AT(stats) allocstats_at((stats), __FILE__, __LINE__)
+
+/**
+ * @brief Allocate recording a file:line call site (see ALLOCSTATS_ALLOC)
+ */
+void *allocstats_alloc_at(AllocStats *stats, size_t size, const char *file, int line);
+
+/**
+ * @brief Allocate size bytes recording the current file:line
+ */
+#define ALLOCSTATS_ALLOC(stats, size) allocstats_alloc_at((stats), (size), __FILE__, __LINE__)
+
+/**
+ * @brief Free a block of size bytes allocated by ALLOCSTATS_ALLOC
+ */
+#define ALLOCSTATS_FREE(stats, ptr, size) allocator_free(&(stats)->allocator, (ptr), (size))
+
+/**
+ * @brief Show an arena in the report
+ *
+ * @param[in] stats stats pointer
+ * @param[in] arena arena, must stay alive until the report (or until allocstats_untrack_arena)
+ * @param[in] name label printed in the report (not copied)
+ * @return 1 if tracked, 0 if the table is full
+ */
+int allocstats_track_arena(AllocStats *stats, const BumpArena *arena, const char *name);
+
+/**
+ * @brief Stop showing an arena in the report (call it before destroying the arena)
+ *
+ * @param[in] stats stats pointer
+ * @param[in] arena arena previously tracked
+ */
+void allocstats_untrack_arena(AllocStats *stats, const BumpArena *arena);
+
+/**
+ * @brief Print the report
+ *
+ * @param[in] stats stats pointer
+ * @param[in] out output stream (e.g. stderr)
+ */
+void allocstats_report(AllocStats *stats, FILE *out);
+
+/**
+ * @brief Print the report to stderr when the program exits
+ *
+ * @param[in] stats stats pointer, must not be destroyed before exit (or destroy unregisters it)
+ * @return 1 if registered, 0 in case of error
+ */
+int allocstats_report_at_exit(AllocStats *stats);
+
+#endif // ALLOCSTATS_H
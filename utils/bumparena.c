@@ -1,75 +1,494 @@
+#define _DEFAULT_SOURCE // MAP_ANONYMOUS, MAP_NORESERVE, madvise
 #include "bumparena.h"
 #include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+/**
+ * @brief Allocate a chunk
+ *
+ * @param[in] allocator allocator of the chunk
+ * @param[in] capacity usable bytes
+ * @param[in] prev previous chunk (can be NULL)
+ * @return chunk pointer or NULL in case of error
+ */
+static BumpChunk *bumpchunk_create(const Allocator *allocator, size_t capacity, BumpChunk *prev) {
+    if (capacity > SIZE_MAX - sizeof(BumpChunk)) {
+        fprintf(stderr, "[bumpchunk_create] capacity overflow\n");
+        return NULL;
+    }
+    BumpChunk *chunk = allocator_alloc(allocator, sizeof(BumpChunk) + capacity);
+    if (chunk == NULL) {
+        perror("[bumpchunk_create] out of memory");
+        return NULL;
+    }
+    chunk->prev = prev;
+    chunk->capacity = capacity;
+    return chunk;
+}
 
 /** @copydoc bumparena_create */
 BumpArena *bumparena_create(size_t capacity) {
-    BumpArena *arena = malloc(sizeof(BumpArena));
+    return bumparena_create_with(capacity, NULL);
+}
+
+/** @copydoc bumparena_create_with */
+BumpArena *bumparena_create_with(size_t capacity, const Allocator *allocator) {
+    if (capacity == 0) {
+        fprintf(stderr, "[bumparena_create] Invalid capacity\n");
+        return NULL;
+    }
+
+    allocator = allocator_or_default(allocator);
+    BumpArena *arena = allocator_alloc(allocator, sizeof(BumpArena));
     if (arena == NULL) {
         perror("[bumparena_create] out of memory");
         return NULL;
     }
+
+    arena->allocator = *allocator;
+    arena->chunk = bumpchunk_create(allocator, capacity, NULL);
+    if (arena->chunk == NULL) {
+        allocator_free(allocator, arena, sizeof(BumpArena));
+        return NULL;
+    }
+    arena->spare = NULL;
+    arena->reserved = 0;
+    arena->commit = 0;
     arena->capacity = capacity;
-    arena->start = malloc(capacity * sizeof(uint8_t));
+    arena->start = arena->chunk->data;
+    arena->offset = arena->start;
+    arena->len = 0;
+    arena->high_water = 0;
+    return arena;
+}
 
-    if (arena->start == NULL) {
-        perror("[bumparena_create] out of memory");
+/**
+ * @brief Round len up to a multiple of a power of two
+ */
+static size_t bumparena_round_up(size_t len, size_t align) {
+    return (len + align - 1) & ~(align - 1);
+}
+
+/**
+ * @brief Reserve an address range, 2MB aligned if huge pages are requested
+ *
+ * @param[in] reserve bytes to reserve, multiple of the page size
+ * @param[in] align alignment of the base address (page size or huge page size)
+ * @return base address or NULL in case of error
+ */
+static void *bumparena_vm_reserve(size_t reserve, size_t align) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t extra = align > page ? align : 0;
+    uint8_t *raw = mmap(NULL, reserve + extra, PROT_NONE,
+                        MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (raw == MAP_FAILED) {
+        perror("[bumparena_create_vm] mmap");
+        return NULL;
+    }
+    if (extra == 0)
+        return raw;
+
+    // trim the head and the tail to leave an aligned range
+    uint8_t *base = (uint8_t *)bumparena_round_up((uintptr_t)raw, align);
+    size_t head = (size_t)(base - raw);
+    if (head > 0)
+        munmap(raw, head);
+    if (extra - head > 0)
+        munmap(base + reserve, extra - head);
+    return base;
+}
+
+/**
+ * @brief Commit the mapping up to total bytes (VM backend)
+ *
+ * @param[in] arena BumpArena pointer
+ * @param[in] total bytes of the mapping to commit, chunk header included
+ * @return 1 if good, 0 in case of error
+ */
+static int bumparena_vm_commit(BumpArena *arena, size_t total) {
+    uint8_t *base = (uint8_t *)arena->chunk;
+    size_t committed = sizeof(BumpChunk) + arena->chunk->capacity;
+    if (mprotect(base + committed, total - committed, PROT_READ | PROT_WRITE) != 0) {
+        perror("[bumparena_vm_commit] mprotect");
+        return 0;
+    }
+    arena->chunk->capacity = total - sizeof(BumpChunk);
+    arena->capacity = arena->chunk->capacity;
+    return 1;
+}
+
+/** @copydoc bumparena_create_vm */
+BumpArena *bumparena_create_vm(size_t reserve, int flags) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t commit = BUMPARENA_VM_COMMIT > page ? BUMPARENA_VM_COMMIT : page;
+    if (flags & BUMPARENA_VM_HUGEPAGES)
+        commit = BUMPARENA_VM_HUGEPAGE;
+
+    if (reserve == 0 || reserve > SIZE_MAX - commit) {
+        fprintf(stderr, "[bumparena_create_vm] Invalid reserve\n");
+        return NULL;
+    }
+    reserve = bumparena_round_up(reserve, commit);
+
+    const Allocator *allocator = allocator_default();
+    BumpArena *arena = allocator_alloc(allocator, sizeof(BumpArena));
+    if (arena == NULL) {
+        perror("[bumparena_create_vm] out of memory");
+        return NULL;
+    }
+    arena->allocator = *allocator;
+
+    uint8_t *base = bumparena_vm_reserve(reserve, commit);
+    if (base == NULL) {
+        allocator_free(allocator, arena, sizeof(BumpArena));
+        return NULL;
+    }
+#ifdef MADV_HUGEPAGE
+    // only a hint: THP can be disabled system wide
+    if ((flags & BUMPARENA_VM_HUGEPAGES) && madvise(base, reserve, MADV_HUGEPAGE) != 0)
+        perror("[bumparena_create_vm] madvise(MADV_HUGEPAGE)");
+#endif
+
+    // the chunk header lives in the first page
+    if (mprotect(base, commit, PROT_READ | PROT_WRITE) != 0) {
+        perror("[bumparena_create_vm] mprotect");
+        munmap(base, reserve);
+        allocator_free(allocator, arena, sizeof(BumpArena));
         return NULL;
     }
+    arena->chunk = (BumpChunk *)base;
+    arena->chunk->prev = NULL;
+    arena->chunk->capacity = commit - sizeof(BumpChunk);
+    arena->spare = NULL;
+    arena->reserved = reserve;
+    arena->commit = commit;
+    arena->capacity = arena->chunk->capacity;
+    arena->start = arena->chunk->data;
     arena->offset = arena->start;
     arena->len = 0;
+    arena->high_water = 0;
     return arena;
 }
 
+/**
+ * @brief Free a list of chunks linked by prev
+ *
+ * @param[in] allocator allocator of the chunks
+ * @param[in] chunk first chunk of the list (can be NULL)
+ */
+static void bumpchunk_destroy_all(const Allocator *allocator, BumpChunk *chunk) {
+    while (chunk != NULL) {
+        BumpChunk *prev = chunk->prev;
+        allocator_free(allocator, chunk, sizeof(BumpChunk) + chunk->capacity);
+        chunk = prev;
+    }
+}
+
 /** @copydoc bumparena_destroy */
 void bumparena_destroy(BumpArena *arena) {
     if (arena == NULL)
         return;
+
+    if (arena->reserved > 0) {
+        if (munmap(arena->chunk, arena->reserved) != 0)
+            perror("[bumparena_destroy] munmap");
+    } else {
+        bumpchunk_destroy_all(&arena->allocator, arena->chunk);
+        bumpchunk_destroy_all(&arena->allocator, arena->spare);
+    }
+    arena->chunk = NULL;
+    arena->spare = NULL;
     arena->capacity = 0;
+    arena->start = NULL;
     arena->offset = NULL;
-    if (arena->start != NULL) {
-        free(arena->start);
-        arena->start = NULL;
+    Allocator allocator = arena->allocator; // the arena itself is released last
+    allocator_free(&allocator, arena, sizeof(BumpArena));
+}
+
+/**
+ * @brief Take a spare chunk big enough for len
+ *
+ * @param[in] arena BumpArena pointer
+ * @param[in] len bytes that must fit in the chunk
+ * @return chunk unlinked from the spare list, or NULL if none fits
+ */
+static BumpChunk *bumparena_take_spare(BumpArena *arena, size_t len) {
+    BumpChunk **link = &arena->spare;
+    while (*link != NULL) {
+        BumpChunk *chunk = *link;
+        if (chunk->capacity >= len) {
+            *link = chunk->prev;
+            return chunk;
+        }
+        link = &chunk->prev;
     }
-    free(arena);
+    return NULL;
 }
 
 /**
- * @brief Resize arena
+ * @brief Grow arena
  *
- * Increase the arena capacity by *2 factor
+ * VM backend: commit the pages needed to fit len after the current offset.
+ * Malloc backend: append a chunk that fits len: a spare chunk if any, otherwise a new one
+ * with twice the current chunk capacity, or more if needed to fit len.
+ * The free space left in the current chunk is abandoned.
  *
  * @param[in] arena BumpArena pointer
+ * @param[in] len bytes that must fit in the new chunk
  * @return 1 if good, 0 in case of error
  */
-static int bumparena_grow(BumpArena *arena) {
-    size_t new_cap = arena->capacity * 2;
-    uint8_t *tmp = realloc(arena->start, new_cap);
-    if (tmp == NULL) {
-        perror("[bumparena_alloc] cannot realloc. Old data are still valid");
-        return 0;
+static int bumparena_grow(BumpArena *arena, size_t len) {
+    if (arena->reserved > 0) {
+        // VM backend: commit more pages, the chunk grows in place
+        size_t used = sizeof(BumpChunk) + (size_t)(arena->offset - arena->start);
+        if (len > arena->reserved - used) {
+            fprintf(stderr, "[bumparena_alloc] reserved address space exhausted\n");
+            return 0;
+        }
+        // at least double the committed size to keep mprotect calls rare
+        size_t total = bumparena_round_up(used + len, arena->commit);
+        size_t doubled = 2 * (sizeof(BumpChunk) + arena->chunk->capacity);
+        if (total < doubled)
+            total = doubled < arena->reserved ? doubled : arena->reserved;
+        return bumparena_vm_commit(arena, total);
     }
-    arena->start = tmp;
-    // recalculate the offset because start can be changed
-    arena->offset = arena->start + arena->len;
-    arena->capacity = new_cap;
+
+    BumpChunk *chunk = bumparena_take_spare(arena, len);
+    if (chunk == NULL) {
+        size_t new_cap = arena->chunk->capacity * 2;
+        if (new_cap < len)
+            new_cap = len;
+
+        chunk = bumpchunk_create(&arena->allocator, new_cap, NULL);
+        if (chunk == NULL) {
+            fprintf(stderr, "[bumparena_alloc] cannot grow. Old data are still valid\n");
+            return 0;
+        }
+        arena->capacity += new_cap;
+    }
+
+    chunk->prev = arena->chunk;
+    arena->chunk = chunk;
+    arena->start = chunk->data;
+    arena->offset = arena->start;
     return 1;
 }
 
 /** @copydoc bumparena_alloc */
 void *bumparena_alloc(BumpArena *arena, size_t len) {
-    if (arena == NULL)
+    return bumparena_alloc_aligned(arena, len, 1);
+}
+
+/**
+ * @brief Padding needed to align ptr
+ *
+ * @param[in] ptr address
+ * @param[in] align power of two
+ * @return bytes to skip
+ */
+static size_t bumparena_padding(const uint8_t *ptr, size_t align) {
+    return (size_t)(-(uintptr_t)ptr) & (align - 1);
+}
+
+/** @copydoc bumparena_alloc_aligned */
+void *bumparena_alloc_aligned(BumpArena *arena, size_t len, size_t align) {
+    if (arena == NULL || arena->chunk == NULL)
         return NULL;
 
-    // arena grows until the len is inside the capacity
-    while (arena->len + len >= arena->capacity) {
-        if (!bumparena_grow(arena))
+    if (align == 0 || (align & (align - 1)) != 0) {
+        fprintf(stderr, "[bumparena_alloc_aligned] align must be a power of two\n");
+        return NULL;
+    }
+
+    // a new chunk is needed when the current one cannot fit padding + len
+    size_t available = arena->chunk->capacity - (size_t)(arena->offset - arena->start);
+    size_t padding = bumparena_padding(arena->offset, align);
+    if (padding + len > available) {
+        // worst case padding in the new chunk is align - 1
+        if (len > SIZE_MAX - align || !bumparena_grow(arena, len + align - 1))
             return NULL;
+        padding = bumparena_padding(arena->offset, align);
     }
 
     // result is the pointer where the caller can write data
-    uint8_t *result = arena->offset;
-    arena->len += len;
-    arena->offset = arena->offset + len; // then increment
+    uint8_t *result = arena->offset + padding;
+    arena->len += padding + len;
+    arena->offset = result + len; // then increment
+    if (arena->len > arena->high_water)
+        arena->high_water = arena->len;
 
     return (void *)result;
-}
\ No newline at end of file
+}
+
+/** @copydoc bumparena_alloc_array */
+void *bumparena_alloc_array(BumpArena *arena, size_t count, size_t size, size_t align) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        fprintf(stderr, "[bumparena_alloc_array] size overflow\n");
+        return NULL;
+    }
+    return bumparena_alloc_aligned(arena, count * size, align);
+}
+
+/** @copydoc bumparena_mark */
+BumpArenaMark bumparena_mark(const BumpArena *arena) {
+    BumpArenaMark mark = {arena->chunk, arena->offset, arena->len};
+    return mark;
+}
+
+/** @copydoc bumparena_reset_to */
+void bumparena_reset_to(BumpArena *arena, BumpArenaMark mark) {
+    if (arena == NULL || mark.chunk == NULL)
+        return;
+
+    // move the chunks opened after the mark to the spare list
+    // (the oldest of them ends up first, it is the smallest)
+    while (arena->chunk != mark.chunk) {
+        BumpChunk *chunk = arena->chunk;
+        if (chunk == NULL) {
+            fprintf(stderr, "[bumparena_reset_to] mark does not belong to this arena\n");
+            return;
+        }
+        arena->chunk = chunk->prev;
+        chunk->prev = arena->spare;
+        arena->spare = chunk;
+    }
+
+    arena->start = mark.chunk->data;
+    arena->offset = mark.offset;
+    arena->len = mark.len;
+}
+
+/** @copydoc bumparena_reset */
+void bumparena_reset(BumpArena *arena) {
+    if (arena == NULL || arena->chunk == NULL)
+        return;
+
+    // the first chunk is the last one of the prev chain
+    BumpChunk *first = arena->chunk;
+    while (first->prev != NULL)
+        first = first->prev;
+
+    BumpArenaMark mark = {first, first->data, 0};
+    bumparena_reset_to(arena, mark);
+
+    // VM backend: give back the physical pages, keep the first commit granule hot
+    size_t committed = sizeof(BumpChunk) + arena->chunk->capacity;
+    if (arena->reserved > 0 && committed > arena->commit) {
+        uint8_t *base = (uint8_t *)arena->chunk;
+        if (madvise(base + arena->commit, committed - arena->commit, MADV_DONTNEED) != 0)
+            perror("[bumparena_reset] madvise(MADV_DONTNEED)");
+    }
+}
+
+/** @copydoc bumparena_absorb */
+int bumparena_absorb(BumpArena *dst, BumpArena *src) {
+    if (dst == NULL || src == NULL || dst == src || dst->chunk == NULL) {
+        fprintf(stderr, "[bumparena_absorb] Invalid parameters\n");
+        return 0;
+    }
+    if (dst->reserved > 0 || src->reserved > 0) {
+        fprintf(stderr, "[bumparena_absorb] VM backed arenas cannot be merged\n");
+        return 0;
+    }
+    if (dst->allocator.free != src->allocator.free || dst->allocator.ctx != src->allocator.ctx) {
+        fprintf(stderr, "[bumparena_absorb] arenas with different allocators cannot be merged\n");
+        return 0;
+    }
+    if (src->chunk == NULL)
+        return 1; // already empty
+
+    // splice the src chain behind the dst current chunk
+    BumpChunk *oldest = src->chunk;
+    while (oldest->prev != NULL)
+        oldest = oldest->prev;
+    oldest->prev = dst->chunk->prev;
+    dst->chunk->prev = src->chunk;
+
+    // src spare chunks are still good for future growth
+    if (src->spare != NULL) {
+        BumpChunk *last = src->spare;
+        while (last->prev != NULL)
+            last = last->prev;
+        last->prev = dst->spare;
+        dst->spare = src->spare;
+    }
+
+    dst->capacity += src->capacity;
+    dst->len += src->len;
+    if (dst->len > dst->high_water)
+        dst->high_water = dst->len;
+
+    src->chunk = NULL;
+    src->spare = NULL;
+    src->start = NULL;
+    src->offset = NULL;
+    src->capacity = 0;
+    src->len = 0;
+    src->high_water = 0;
+    return 1;
+}
+
+/**
+ * @brief Allocator alloc adapter
+ */
+static void *bumparena_allocator_alloc(void *ctx, size_t size) {
+    return bumparena_alloc_aligned(ctx, size, ALLOCATOR_ALIGN);
+}
+
+/**
+ * @brief Is ptr the last allocation of the arena?
+ */
+static int bumparena_is_last(const BumpArena *arena, const void *ptr, size_t size) {
+    return (const uint8_t *)ptr + size == arena->offset &&
+           (const uint8_t *)ptr >= arena->start;
+}
+
+/**
+ * @brief Allocator realloc adapter
+ *
+ * The last allocation grows or shrinks in place when the current chunk
+ * allows it, otherwise the block is copied to a new allocation.
+ */
+static void *bumparena_allocator_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+    BumpArena *arena = ctx;
+    if (ptr == NULL)
+        return bumparena_allocator_alloc(ctx, new_size);
+
+    if (bumparena_is_last(arena, ptr, old_size)) {
+        size_t available = arena->chunk->capacity - (size_t)(arena->offset - arena->start);
+        if (new_size <= old_size || new_size - old_size <= available) {
+            arena->offset = (uint8_t *)ptr + new_size;
+            arena->len = arena->len - old_size + new_size;
+            if (arena->len > arena->high_water)
+                arena->high_water = arena->len;
+            return ptr;
+        }
+    } else if (new_size <= old_size) {
+        return ptr;
+    }
+
+    void *res = bumparena_allocator_alloc(ctx, new_size);
+    if (res != NULL)
+        memcpy(res, ptr, old_size < new_size ? old_size : new_size);
+    return res;
+}
+
+/**
+ * @brief Allocator free adapter: only the last allocation is reclaimed
+ */
+static void bumparena_allocator_free(void *ctx, void *ptr, size_t size) {
+    BumpArena *arena = ctx;
+    if (ptr != NULL && bumparena_is_last(arena, ptr, size)) {
+        arena->offset = ptr;
+        arena->len -= size;
+    }
+}
+
+/** @copydoc bumparena_allocator */
+Allocator bumparena_allocator(BumpArena *arena) {
+    Allocator allocator = {bumparena_allocator_alloc, bumparena_allocator_realloc,
+                           bumparena_allocator_free, arena};
+    return allocator;
+}
@@ -1,50 +1,216 @@
 /**
  * @brief Append-only Arena Allocator
  *
- * BumpArena allocator manages a contiguous block of memory for fast allocations.
+ * BumpArena allocator manages a list of memory chunks for fast allocations.
  * It is optimized for short-lived data that can be freed all at once, such as
  * request-scoped allocations or temporary data structures. The arena grows
  * automatically as needed but never shrinks, prioritizing simplicity and
  * performance over memory efficiency.
  *
+ * Growth appends a new chunk (twice the size of the current one, or big
+ * enough for the request) instead of reallocating: pointers returned by
+ * bumparena_alloc stay valid until bumparena_destroy and growing costs O(1).
+ *
+ * Scratch scopes: bumparena_mark saves the current position and
+ * bumparena_reset_to rolls the arena back to it, bumparena_reset rolls back
+ * everything. Chunks released by a rollback are kept and reused by the next
+ * growth, so a loop that marks/resets every iteration runs on the same pages
+ * with no malloc/free after the first iterations.
+ *
+ * Virtual memory backend: bumparena_create_vm reserves a huge address range
+ * up front (mmap PROT_NONE, no physical memory) and commits pages on demand
+ * with mprotect. The arena is a single chunk that grows in place: the base
+ * never moves, growing costs no copy and no free space is abandoned.
+ * bumparena_reset gives the committed pages back to the OS (MADV_DONTNEED).
+ * With BUMPARENA_VM_HUGEPAGES the range is 2MB aligned and marked for
+ * transparent huge pages (MADV_HUGEPAGE) to reduce TLB misses.
+ *
+ * bumparena_alloc hands out raw bytes with no alignment. Use
+ * bumparena_alloc_aligned or the typed ARENA_NEW / ARENA_ARRAY macros for
+ * anything wider than a byte (integers, doubles, structs, SIMD vectors).
+ *
  * @author Alberto Ielpo <alberto.ielpo@gmail.com>
  */
 
 #ifndef BUMPARENA_H
 #define BUMPARENA_H
+#include "allocator.h"
 #include <stdint.h>
 #include <stdlib.h>
 
+#define BUMPARENA_CACHE_LINE 64 // alignment for cache line / AVX-512 data
+
+#define BUMPARENA_VM_COMMIT (64 * 1024)         // min bytes committed at once (VM backend)
+#define BUMPARENA_VM_HUGEPAGE (2 * 1024 * 1024) // transparent huge page size (x86-64)
+#define BUMPARENA_VM_HUGEPAGES 1                // bumparena_create_vm flag: THP hint
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define BUMPARENA_ALIGNOF(T) _Alignof(T)
+#else
+#define BUMPARENA_ALIGNOF(T) __alignof__(T) // gcc/clang extension before C11
+#endif
+
+/**
+ * @brief Allocate one uninitialized T, aligned for T
+ */
+#define ARENA_NEW(arena, T) \
+    ((T *)bumparena_alloc_aligned((arena), sizeof(T), BUMPARENA_ALIGNOF(T)))
+
+/**
+ * @brief Allocate an uninitialized array of n T, aligned for T
+ */
+#define ARENA_ARRAY(arena, T, n) \
+    ((T *)bumparena_alloc_array((arena), (n), sizeof(T), BUMPARENA_ALIGNOF(T)))
+
+/**
+ * Chunk header. Chunk memory follows the header in the same allocation.
+ */
+typedef struct bumpchunk {
+    struct bumpchunk *prev; // previous (older) chunk, NULL for the first one
+    size_t capacity;        // usable bytes in data
+    uint8_t data[];         // chunk memory
+} BumpChunk;
+
 typedef struct
 {
-    size_t capacity; // total capacity (bytes)
-    size_t len;      // current occupied capacity (bytes).
-    uint8_t *start;  // heap allocated start pointer
-    uint8_t *offset; // heap offset pointer
+    size_t capacity;     // total capacity of all chunks, spare ones included (bytes)
+    size_t len;          // current occupied capacity of all chunks (bytes).
+    size_t high_water;   // max len ever reached, resets included (bytes)
+    uint8_t *start;      // current chunk start pointer
+    uint8_t *offset;     // current chunk offset pointer
+    BumpChunk *chunk;    // current (newest) chunk
+    BumpChunk *spare;    // chunks released by a reset, reused before allocating new ones
+    size_t reserved;     // VM backend: reserved bytes of the mapping, 0 for the malloc backend
+    size_t commit;       // VM backend: commit granularity (bytes)
+    Allocator allocator; // allocator of the arena structure and of the chunks
 } BumpArena;
 
+/**
+ * Saved arena position (see bumparena_mark)
+ */
+typedef struct
+{
+    BumpChunk *chunk; // current chunk when the mark was taken
+    uint8_t *offset;  // offset inside that chunk
+    size_t len;       // arena len when the mark was taken
+} BumpArenaMark;
+
 /**
  * @brief Create a bump arena
  * This method reserve an heap space for a bump arena
- * @param[in] capacity Reserved bytes
+ * @param[in] capacity Reserved bytes of the first chunk
  * @return Bump Arena pointer
  */
 BumpArena *bumparena_create(size_t capacity);
 
+/**
+ * @brief Create a bump arena with a custom allocator
+ * Same as bumparena_create but the arena structure and the chunks are
+ * allocated with allocator (see allocator.h)
+ * @param[in] capacity Reserved bytes of the first chunk
+ * @param[in] allocator allocator to use, NULL means libc
+ * @return Bump Arena pointer
+ */
+BumpArena *bumparena_create_with(size_t capacity, const Allocator *allocator);
+
+/**
+ * @brief Create a bump arena backed by reserved virtual memory
+ * The whole range is reserved (not committed) at once, pages are committed
+ * when the allocations reach them. Reserving far more than needed is cheap
+ * (e.g. 64GB on a 64-bit system).
+ * @param[in] reserve bytes of address space to reserve (rounded up to the page size)
+ * @param[in] flags 0 or BUMPARENA_VM_HUGEPAGES
+ * @return Bump Arena pointer or NULL in case of error
+ */
+BumpArena *bumparena_create_vm(size_t reserve, int flags);
+
 /**
  * @brief Deallocate bump arena
- * This method free from heap the bump arena reserved
+ * This method free from heap the bump arena reserved (all chunks)
  * @param[in] arena
  */
 void bumparena_destroy(BumpArena *arena);
 
 /**
  * @brief Alloc element into the arena
- * Alloc element into the arena stack.
+ * Alloc element into the arena stack. If the current chunk is full a new
+ * chunk is appended, previous allocations never move.
  * @param[in] arena
  * @param[in] len in bytes
  * @return Return a void* because it's caller responsability to use it properly
  */
 void *bumparena_alloc(BumpArena *arena, size_t len);
 
-#endif
\ No newline at end of file
+/**
+ * @brief Alloc aligned element into the arena
+ * Like bumparena_alloc but the returned address is a multiple of align.
+ * The padding bytes skipped to align the address are counted in len.
+ * @param[in] arena
+ * @param[in] len in bytes
+ * @param[in] align power of two (e.g. BUMPARENA_ALIGNOF(T) or BUMPARENA_CACHE_LINE)
+ * @return aligned pointer or NULL in case of error
+ */
+void *bumparena_alloc_aligned(BumpArena *arena, size_t len, size_t align);
+
+/**
+ * @brief Alloc aligned array into the arena
+ * Like bumparena_alloc_aligned for count elements of size bytes,
+ * fails if count * size overflows
+ * @param[in] arena
+ * @param[in] count number of elements
+ * @param[in] size element size in bytes
+ * @param[in] align power of two
+ * @return aligned pointer or NULL in case of error
+ */
+void *bumparena_alloc_array(BumpArena *arena, size_t count, size_t size, size_t align);
+
+/**
+ * @brief Save the current arena position
+ * @param[in] arena
+ * @return mark to pass to bumparena_reset_to
+ */
+BumpArenaMark bumparena_mark(const BumpArena *arena);
+
+/**
+ * @brief Roll the arena back to a mark
+ * Everything allocated after the mark is released at once. Chunks opened
+ * after the mark are kept as spare for the next allocations.
+ * Marks are LIFO: rolling back to a mark invalidates the marks taken after it.
+ * @param[in] arena
+ * @param[in] mark position returned by bumparena_mark on the same arena
+ */
+void bumparena_reset_to(BumpArena *arena, BumpArenaMark mark);
+
+/**
+ * @brief Release every allocation but keep the memory
+ * The arena restarts from its first chunk, the other chunks become spare.
+ * With the VM backend the committed pages are returned to the OS and come
+ * back zero filled on the next touch.
+ * @param[in] arena
+ */
+void bumparena_reset(BumpArena *arena);
+
+/**
+ * @brief Move all the chunks of src into dst
+ * Allocations made from src stay valid and are now released with dst.
+ * Only chunk lists are relinked, nothing is copied. dst keeps allocating from
+ * its current chunk. src is left empty: it can only be destroyed.
+ * Both arenas must use the malloc backend and the same allocator.
+ * Not thread safe: lock dst if shared.
+ * @param[in] dst arena receiving the chunks
+ * @param[in] src arena giving its chunks
+ * @return 1 if good, 0 in case of error
+ */
+int bumparena_absorb(BumpArena *dst, BumpArena *src);
+
+/**
+ * @brief Allocator adapter (see allocator.h)
+ * Blocks are aligned to ALLOCATOR_ALIGN. free only reclaims the last
+ * allocation and realloc extends the last allocation in place when possible:
+ * everything else is released with the arena.
+ * @param[in] arena arena pointer, must outlive the users of the allocator
+ * @return allocator using the arena
+ */
+Allocator bumparena_allocator(BumpArena *arena);
+
+#endif
@@ -0,0 +1,277 @@
+#include "cache.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_INDEX_CAPACITY 64     // initial HMap capacity (grows on demand)
+#define SKETCH_ROWS 4               // count-min rows
+#define SKETCH_MIN_WIDTH 256        // min counters per row
+#define SKETCH_MAX_WIDTH (1 << 20)  // max counters per row
+#define SKETCH_BYTES_PER_ENTRY 64   // expected bytes per entry to size the sketch
+#define SKETCH_AGING_FACTOR 10      // halve counters every width * factor increments
+
+/**
+ * @brief Key hash
+ *
+ * 64-bit FNV-1a, the same function used by HMap
+ *
+ * @param[in] key \0 terminated key
+ * @return hash
+ */
+static uint64_t cache_hash(const char *key) {
+    uint64_t hash = FNV_OFFSET;
+    for (const char *p = key; *p; p++) {
+        hash ^= (uint64_t)(unsigned char)(*p);
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+/**
+ * @brief Counter index of a hash in a sketch row
+ *
+ * @param[in] cache cache pointer
+ * @param[in] hash key hash
+ * @param[in] row sketch row
+ * @return index inside the whole sketch array
+ */
+static size_t sketch_idx(const Cache *cache, uint64_t hash, size_t row) {
+    static const uint64_t seeds[SKETCH_ROWS] = {
+        0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL,
+        0x165667b19e3779f9ULL, 0xd6e8feb86659fd93ULL};
+    uint64_t x = (hash ^ (hash >> 31)) * seeds[row];
+    return row * (cache->sketch_mask + 1) + ((x >> 32) & cache->sketch_mask);
+}
+
+/**
+ * @brief Estimated request count of a key (min over the rows)
+ */
+static uint8_t sketch_estimate(const Cache *cache, uint64_t hash) {
+    uint8_t min = UINT8_MAX;
+    for (size_t rr = 0; rr < SKETCH_ROWS; rr++) {
+        uint8_t val = cache->sketch[sketch_idx(cache, hash, rr)];
+        if (val < min)
+            min = val;
+    }
+    return min;
+}
+
+/**
+ * @brief Record one request of a key
+ *
+ * Counters saturate at 255. Periodically all counters are halved so that
+ * old popularity fades away.
+ */
+static void sketch_increment(Cache *cache, uint64_t hash) {
+    for (size_t rr = 0; rr < SKETCH_ROWS; rr++) {
+        size_t idx = sketch_idx(cache, hash, rr);
+        if (cache->sketch[idx] < UINT8_MAX)
+            cache->sketch[idx]++;
+    }
+
+    if (++cache->sketch_ops >= (cache->sketch_mask + 1) * SKETCH_AGING_FACTOR) {
+        size_t len = SKETCH_ROWS * (cache->sketch_mask + 1);
+        for (size_t ii = 0; ii < len; ii++)
+            cache->sketch[ii] >>= 1;
+        cache->sketch_ops = 0;
+    }
+}
+
+/** @copydoc cache_create */
+Cache *cache_create(size_t capacity, CachePolicy policy) {
+    if (capacity == 0) {
+        fprintf(stderr, "[cache_create] Invalid capacity\n");
+        return NULL;
+    }
+
+    Cache *cache = calloc(1, sizeof(Cache));
+    if (cache == NULL) {
+        perror("[cache_create] Cannot create a new cache");
+        return NULL;
+    }
+
+    cache->index = hmap_create_pooled(CACHE_INDEX_CAPACITY, 0);
+    if (cache->index == NULL) {
+        free(cache);
+        return NULL;
+    }
+
+    if (policy == CACHE_POLICY_TINYLFU) {
+        // one counter per expected entry, power of two
+        size_t width = SKETCH_MIN_WIDTH;
+        while (width < SKETCH_MAX_WIDTH && width < capacity / SKETCH_BYTES_PER_ENTRY)
+            width <<= 1;
+
+        cache->sketch = calloc(SKETCH_ROWS * width, sizeof(uint8_t));
+        if (cache->sketch == NULL) {
+            perror("[cache_create] Cannot create the frequency sketch");
+            hmap_destroy(cache->index);
+            free(cache);
+            return NULL;
+        }
+        cache->sketch_mask = width - 1;
+    }
+
+    ilist_init(&cache->lru);
+    cache->capacity = capacity;
+    cache->policy = policy;
+    return cache;
+}
+
+/** @copydoc cache_destroy */
+void cache_destroy(Cache *cache) {
+    if (cache == NULL)
+        return;
+
+    ilist_foreach_safe(&cache->lru, it, tmp) {
+        free(ilist_entry(it, CacheEntry, link));
+    }
+    hmap_destroy(cache->index);
+    free(cache->sketch);
+    free(cache);
+}
+
+/**
+ * @brief Find the entry of a key
+ */
+static CacheEntry *cache_lookup(Cache *cache, const char *key) {
+    // hmap_get does not modify the key
+    HEntry *hentry = hmap_get(cache->index, (char *)key);
+    return hentry == NULL ? NULL : (CacheEntry *)hentry->value;
+}
+
+/**
+ * @brief Unlink an entry from the index and the recency list, then free it
+ */
+static void cache_drop(Cache *cache, CacheEntry *entry) {
+    // the index references entry->key: remove it before freeing the entry
+    hmap_remove(cache->index, entry->key);
+    ilist_remove(&cache->lru, &entry->link);
+    cache->used -= entry->charge;
+    free(entry);
+}
+
+/**
+ * @brief TinyLFU admission check
+ *
+ * Walk the LRU tail over the entries that would be evicted to make room for
+ * charge bytes. The candidate is admitted only if it is more popular than
+ * every one of them.
+ *
+ * @return 1 if admitted, 0 otherwise
+ */
+static int cache_admit(Cache *cache, uint64_t hash, size_t charge) {
+    uint8_t candidate = sketch_estimate(cache, hash);
+    size_t freed = 0;
+
+    for (ILink *it = ilist_last(&cache->lru);
+         it != NULL && cache->used - freed + charge > cache->capacity;
+         it = ilist_prev(&cache->lru, it)) {
+        CacheEntry *victim = ilist_entry(it, CacheEntry, link);
+        if (sketch_estimate(cache, cache_hash(victim->key)) >= candidate)
+            return 0;
+        freed += victim->charge;
+    }
+    return 1;
+}
+
+/** @copydoc cache_get */
+const void *cache_get(Cache *cache, const char *key, size_t *value_len) {
+    if (cache == NULL || key == NULL)
+        return NULL;
+
+    if (cache->sketch != NULL)
+        sketch_increment(cache, cache_hash(key));
+
+    CacheEntry *entry = cache_lookup(cache, key);
+    if (entry == NULL) {
+        cache->misses++;
+        return NULL;
+    }
+
+    cache->hits++;
+    ilist_move_front(&cache->lru, &entry->link);
+    if (value_len != NULL)
+        *value_len = entry->value_len;
+    return entry->value;
+}
+
+/** @copydoc cache_put */
+int cache_put(Cache *cache, const char *key, const void *value, size_t value_len) {
+    if (cache == NULL || key == NULL || (value == NULL && value_len > 0)) {
+        fprintf(stderr, "[cache_put] Invalid parameters\n");
+        return 0;
+    }
+
+    size_t key_len = strlen(key);
+    size_t charge = sizeof(CacheEntry) + value_len + key_len + 1;
+    if (charge > cache->capacity)
+        return 0;
+
+    // replacing a resident key is always admitted
+    CacheEntry *old = cache_lookup(cache, key);
+    if (old != NULL) {
+        cache_drop(cache, old);
+    } else if (cache->sketch != NULL) {
+        uint64_t hash = cache_hash(key);
+        sketch_increment(cache, hash);
+        if (!cache_admit(cache, hash, charge)) {
+            cache->rejections++;
+            return 0;
+        }
+    }
+
+    // make room
+    while (cache->used + charge > cache->capacity) {
+        CacheEntry *victim = ilist_entry(ilist_last(&cache->lru), CacheEntry, link);
+        cache_drop(cache, victim);
+        cache->evictions++;
+    }
+
+    // single allocation: header | value | key
+    CacheEntry *entry = malloc(charge);
+    if (entry == NULL) {
+        perror("[cache_put] Cannot allocate entry");
+        return 0;
+    }
+    entry->charge = charge;
+    entry->value_len = value_len;
+    entry->key = (char *)entry->value + value_len;
+    if (value_len > 0)
+        memcpy(entry->value, value, value_len);
+    memcpy(entry->key, key, key_len + 1);
+
+    if (!hmap_add(cache->index, entry->key, entry, HE_TYPE_PTR, 1)) {
+        free(entry);
+        return 0;
+    }
+    ilist_push_front(&cache->lru, &entry->link);
+    cache->used += charge;
+    return 1;
+}
+
+/** @copydoc cache_remove */
+int cache_remove(Cache *cache, const char *key) {
+    if (cache == NULL || key == NULL)
+        return 0;
+
+    CacheEntry *entry = cache_lookup(cache, key);
+    if (entry == NULL)
+        return 0;
+    cache_drop(cache, entry);
+    return 1;
+}
+
+/** @copydoc cache_print_stats */
+void cache_print_stats(const Cache *cache) {
+    if (cache == NULL)
+        return;
+
+    size_t lookups = cache->hits + cache->misses;
+    printf("{ policy:%s, entries:%zu, used:%zu/%zu bytes, hits:%zu, misses:%zu, hit_ratio:%.2f%%, evictions:%zu, rejections:%zu }\n",
+           cache->policy == CACHE_POLICY_TINYLFU ? "tinylfu" : "lru",
+           cache->lru.size, cache->used, cache->capacity,
+           cache->hits, cache->misses,
+           lookups == 0 ? 0.0 : cache->hits * 100.0 / lookups,
+           cache->evictions, cache->rejections);
+}
@@ -0,0 +1,125 @@
+/**
+ * @brief Bounded key/value cache with LRU eviction and optional TinyLFU admission
+ *
+ * Cache combines an HMap index (key -> entry) with an intrusive recency list
+ * (ilist.h). Every entry is a single allocation holding the list link, the
+ * key and a copy of the value, so get/put/evict are O(1) and no pointer of
+ * the caller is kept.
+ *
+ * The cache is byte budgeted: every entry is charged its full size
+ * (header + key + value) and the least recently used entries are evicted
+ * until the new one fits.
+ *
+ * Policies:
+ * - CACHE_POLICY_LRU: plain LRU, every put is admitted
+ * - CACHE_POLICY_TINYLFU: LRU eviction guarded by a TinyLFU admission filter.
+ *   A count-min sketch (4 rows of 8-bit saturating counters, halved
+ *   periodically) estimates how often each key has been requested. A new key
+ *   is admitted only if it is more popular than the entries it would evict,
+ *   so one-off scans cannot flush the hot set.
+ *
+ * Hit/miss/eviction/rejection counters are updated on every call.
+ * The cache is not thread safe.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "hmap.h"
+#include "ilist.h"
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    CACHE_POLICY_LRU,    // evict least recently used, admit everything
+    CACHE_POLICY_TINYLFU // evict least recently used, admit by frequency
+} CachePolicy;
+
+/**
+ * Cache entry: link, key and value share one allocation
+ */
+typedef struct
+{
+    ILink link;       // recency list link (front = most recent)
+    size_t charge;    // bytes charged against the budget
+    size_t value_len; // value length in bytes
+    char *key;        // \0 terminated key, stored right after the value
+    uint8_t value[];  // value bytes
+} CacheEntry;
+
+typedef struct
+{
+    HMap *index;        // key -> CacheEntry (HE_TYPE_PTR)
+    IList lru;          // recency list
+    size_t capacity;    // byte budget
+    size_t used;        // bytes charged by the current entries
+    CachePolicy policy; // admission policy
+    uint8_t *sketch;    // TinyLFU count-min sketch (4 rows), NULL with LRU
+    size_t sketch_mask; // row width - 1 (power of two)
+    size_t sketch_ops;  // increments since the last aging
+    size_t hits;        // successful cache_get
+    size_t misses;      // failed cache_get
+    size_t evictions;   // entries evicted to make room
+    size_t rejections;  // puts refused by the admission policy
+} Cache;
+
+/**
+ * @brief Create a cache
+ *
+ * @param[in] capacity byte budget for all entries (headers included)
+ * @param[in] policy admission policy
+ * @return cache pointer or NULL in case of error
+ */
+Cache *cache_create(size_t capacity, CachePolicy policy);
+
+/**
+ * @brief Destroy a cache and all its entries
+ *
+ * @param[in] cache cache pointer (can be NULL)
+ */
+void cache_destroy(Cache *cache);
+
+/**
+ * @brief Lookup a key
+ *
+ * On hit the entry becomes the most recently used one.
+ *
+ * @param[in] cache cache pointer
+ * @param[in] key \0 terminated key
+ * @param[out] value_len value length (can be NULL)
+ * @return pointer to the cached value, valid until the next put/remove, or NULL on miss
+ */
+const void *cache_get(Cache *cache, const char *key, size_t *value_len);
+
+/**
+ * @brief Insert or replace a key
+ *
+ * The key and the value are copied. Least recently used entries are evicted
+ * until the new entry fits in the budget.
+ *
+ * @param[in] cache cache pointer
+ * @param[in] key \0 terminated key
+ * @param[in] value value bytes
+ * @param[in] value_len value length in bytes
+ * @return 1 if stored, 0 if not stored (rejected by the policy, bigger than the budget or error)
+ */
+int cache_put(Cache *cache, const char *key, const void *value, size_t value_len);
+
+/**
+ * @brief Remove a key
+ *
+ * @param[in] cache cache pointer
+ * @param[in] key \0 terminated key
+ * @return 1 if removed, 0 if not found
+ */
+int cache_remove(Cache *cache, const char *key);
+
+/**
+ * @brief Print counters to stdout
+ *
+ * @param[in] cache cache pointer
+ */
+void cache_print_stats(const Cache *cache);
+
+#endif // CACHE_H
@@ -0,0 +1,673 @@
+#define _GNU_SOURCE // statx, AT_FDCWD, syscall
+#include "fhpipe.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#ifdef IO_URING_OP_SUPPORTED // opcode probe, kernel headers >= 5.6
+#define FHPIPE_HAS_URING 1
+#endif
+#endif
+#endif
+
+/** @copydoc fhpipe_engine_name */
+const char *fhpipe_engine_name(FhPipeEngine engine) {
+    switch (engine) {
+    case FHPIPE_AUTO:
+        return "auto";
+    case FHPIPE_URING:
+        return "io_uring";
+    case FHPIPE_THREADS:
+        return "threads";
+    }
+    return "unknown";
+}
+
+/* ---------------------------------------------------------------------- */
+/* Thread pool                                                            */
+/* ---------------------------------------------------------------------- */
+
+typedef struct
+{
+    Fhash *fhs;
+    bool *ok;
+    size_t count;
+    size_t next;          // next file to hash
+    size_t hashed;        // files hashed
+    pthread_mutex_t lock; // protects next and hashed
+} FhPool;
+
+static void *fhpool_worker(void *arg) {
+    FhPool *pool = (FhPool *)arg;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        size_t job = pool->next < pool->count ? pool->next++ : pool->count;
+        pthread_mutex_unlock(&pool->lock);
+        if (job == pool->count)
+            return NULL;
+
+        bool res = fhsha1(&pool->fhs[job]);
+        if (pool->ok != NULL)
+            pool->ok[job] = res;
+        if (res) {
+            pthread_mutex_lock(&pool->lock);
+            pool->hashed++;
+            pthread_mutex_unlock(&pool->lock);
+        }
+    }
+}
+
+/**
+ * @brief fhsha1 on every file with a pool of threads
+ */
+static size_t fhpool_run(Fhash *fhs, size_t count, bool ok[], size_t threads) {
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+    if (threads > count)
+        threads = count;
+
+    FhPool pool = {.fhs = fhs, .ok = ok, .count = count};
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_t *tids = calloc(threads, sizeof(pthread_t));
+    size_t started = 0;
+    if (tids != NULL) {
+        for (; started < threads; started++) {
+            if (pthread_create(&tids[started], NULL, fhpool_worker, &pool) != 0)
+                break;
+        }
+    }
+    if (started == 0)
+        fhpool_worker(&pool); // no thread at all: do it here
+    for (size_t ii = 0; ii < started; ii++)
+        pthread_join(tids[ii], NULL);
+
+    free(tids);
+    pthread_mutex_destroy(&pool.lock);
+    return pool.hashed;
+}
+
+#ifdef FHPIPE_HAS_URING
+/* ---------------------------------------------------------------------- */
+/* io_uring ring, raw syscalls                                            */
+/* ---------------------------------------------------------------------- */
+
+typedef struct
+{
+    int fd;                     // ring file descriptor
+    unsigned entries;           // sq entries
+    unsigned *sq_head;          // kernel: consumed sqes
+    unsigned *sq_tail;          // us: queued sqes
+    unsigned *sq_mask;          // sq index mask
+    unsigned *sq_array;         // sq index -> sqe index
+    struct io_uring_sqe *sqes;  // submission entries
+    unsigned *cq_head;          // us: consumed cqes
+    unsigned *cq_tail;          // kernel: posted cqes
+    unsigned *cq_mask;          // cq index mask
+    struct io_uring_cqe *cqes;  // completion entries
+    unsigned sq_local_tail;     // next sqe to fill
+    unsigned to_submit;         // filled but not submitted yet
+    void *sq_map;               // sq ring mapping
+    size_t sq_map_len;          // sq ring mapping length
+    void *cq_map;               // cq ring mapping (== sq_map with single mmap)
+    size_t cq_map_len;          // cq ring mapping length
+    size_t sqes_len;            // sqes mapping length
+} FhRing;
+
+static int fhring_setup(FhRing *ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    memset(ring, 0, sizeof(FhRing));
+
+    ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (ring->fd < 0)
+        return 0;
+
+    ring->sq_map_len = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cq_map_len = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (ring->cq_map_len > ring->sq_map_len)
+            ring->sq_map_len = ring->cq_map_len;
+        ring->cq_map_len = ring->sq_map_len;
+    }
+
+    ring->sq_map = mmap(NULL, ring->sq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                        IORING_OFF_SQ_RING);
+    if (ring->sq_map == MAP_FAILED) {
+        close(ring->fd);
+        return 0;
+    }
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        ring->cq_map = ring->sq_map;
+    } else {
+        ring->cq_map = mmap(NULL, ring->cq_map_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                            IORING_OFF_CQ_RING);
+        if (ring->cq_map == MAP_FAILED) {
+            munmap(ring->sq_map, ring->sq_map_len);
+            close(ring->fd);
+            return 0;
+        }
+    }
+    ring->sqes_len = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring->sqes = mmap(NULL, ring->sqes_len, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                      IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        if (ring->cq_map != ring->sq_map)
+            munmap(ring->cq_map, ring->cq_map_len);
+        munmap(ring->sq_map, ring->sq_map_len);
+        close(ring->fd);
+        return 0;
+    }
+
+    uint8_t *sq = ring->sq_map;
+    uint8_t *cq = ring->cq_map;
+    ring->entries = params.sq_entries;
+    ring->sq_head = (unsigned *)(sq + params.sq_off.head);
+    ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+    ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+    ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+    ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+    ring->sq_local_tail = *ring->sq_tail;
+    return 1;
+}
+
+static void fhring_destroy(FhRing *ring) {
+    munmap(ring->sqes, ring->sqes_len);
+    if (ring->cq_map != ring->sq_map)
+        munmap(ring->cq_map, ring->cq_map_len);
+    munmap(ring->sq_map, ring->sq_map_len);
+    close(ring->fd);
+}
+
+/**
+ * @brief Next free submission entry, zeroed, or NULL if the ring is full
+ */
+static struct io_uring_sqe *fhring_get_sqe(FhRing *ring) {
+    unsigned head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sq_local_tail - head >= ring->entries)
+        return NULL;
+    unsigned idx = ring->sq_local_tail & *ring->sq_mask;
+    struct io_uring_sqe *sqe = &ring->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    ring->sq_array[idx] = idx;
+    ring->sq_local_tail++;
+    ring->to_submit++;
+    return sqe;
+}
+
+/**
+ * @brief Submit the queued entries, optionally wait for one completion
+ *
+ * @return 1 on success, 0 on error
+ */
+static int fhring_submit(FhRing *ring, int wait) {
+    __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+    for (;;) {
+        long res = syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, wait ? 1 : 0,
+                           wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (res >= 0) {
+            ring->to_submit -= (unsigned)res;
+            return 1;
+        }
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            return 0;
+        if (errno != EINTR && !wait)
+            return 1; // completions to reap first
+    }
+}
+
+/**
+ * @brief Probe the opcodes used by the pipeline
+ */
+static int fhring_probe(FhRing *ring) {
+    size_t len = sizeof(struct io_uring_probe) + 256 * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, len);
+    if (probe == NULL)
+        return 0;
+    int res = syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PROBE, probe, 256) == 0;
+    static const int ops[] = {IORING_OP_STATX, IORING_OP_OPENAT, IORING_OP_READ_FIXED, IORING_OP_READ};
+    for (size_t ii = 0; res && ii < sizeof(ops) / sizeof(ops[0]); ii++)
+        res = ops[ii] <= probe->last_op && (probe->ops[ops[ii]].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    return res;
+}
+
+/* ---------------------------------------------------------------------- */
+/* io_uring pipeline                                                      */
+/* ---------------------------------------------------------------------- */
+
+#define FHPIPE_FREE SIZE_MAX // slot or buffer not in use
+#define FHPIPE_OP_STATX 1ULL
+#define FHPIPE_OP_OPEN 2ULL
+#define FHPIPE_OP_READ 3ULL
+#define FHPIPE_USER_DATA(op, idx) (((op) << 32) | (uint64_t)(idx))
+
+/**
+ * One file in flight
+ */
+typedef struct
+{
+    size_t job;         // file index, FHPIPE_FREE when the slot is free
+    int fd;             // -1 until opened
+    uint64_t size;      // from statx
+    uint64_t issued;    // bytes requested
+    uint64_t hashed;    // bytes hashed, in order
+    unsigned inflight;  // ring operations in flight
+    bool failed;        // stop reading, finish when inflight is 0
+    bool until_eof;     // statx size 0 (procfs, sysfs): one read at a time until EOF
+    struct statx stx;   // statx result
+    SHA1_CTX ctx;       // hash of the file
+} FhFile;
+
+/**
+ * One read buffer
+ */
+typedef struct
+{
+    size_t slot;     // owner file slot, FHPIPE_FREE when the buffer is free
+    uint64_t offset; // file offset of the chunk
+    size_t len;      // chunk length
+    size_t done;     // bytes read so far (short reads are resubmitted)
+    bool ready;      // complete, waiting for its turn to be hashed
+    uint8_t *data;   // registered memory
+} FhBuf;
+
+typedef struct
+{
+    FhRing ring;
+    Fhash *fhs;
+    bool *ok;
+    size_t count;
+    size_t next;        // next file to start
+    size_t hashed;      // files hashed
+    size_t running;     // files in a slot
+    FhFile *files;      // open_files slots
+    size_t open_files;  // slots
+    FhBuf *bufs;        // queue_depth buffers
+    size_t queue_depth; // buffers
+    size_t chunk_len;   // buffer length
+    uint8_t *memory;    // buffers memory
+    bool fixed;         // buffers are registered
+    unsigned ops;       // operations in flight (bounded by the ring size)
+} FhPipe;
+
+static void fhpipe_finish(FhPipe *fp, size_t slot, bool res) {
+    FhFile *file = &fp->files[slot];
+    if (res) {
+        sha1_final(&file->ctx, fp->fhs[file->job].hash);
+        fp->hashed++;
+    }
+    if (fp->ok != NULL)
+        fp->ok[file->job] = res;
+    if (file->fd >= 0)
+        close(file->fd);
+    file->fd = -1;
+    file->job = FHPIPE_FREE;
+    fp->running--;
+}
+
+/**
+ * @brief Queue a read of buf (or of its missing part after a short read)
+ */
+static int fhpipe_queue_read(FhPipe *fp, size_t bb) {
+    FhBuf *buf = &fp->bufs[bb];
+    struct io_uring_sqe *sqe = fhring_get_sqe(&fp->ring);
+    if (sqe == NULL)
+        return 0;
+    sqe->opcode = fp->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = fp->files[buf->slot].fd;
+    sqe->addr = (uint64_t)(uintptr_t)(buf->data + buf->done);
+    sqe->len = (uint32_t)(buf->len - buf->done);
+    sqe->off = buf->offset + buf->done;
+    sqe->buf_index = (uint16_t)bb;
+    sqe->user_data = FHPIPE_USER_DATA(FHPIPE_OP_READ, bb);
+    fp->files[buf->slot].inflight++;
+    fp->ops++;
+    return 1;
+}
+
+/**
+ * @brief Start statx of new files and reads of open files, while there is room
+ */
+static void fhpipe_fill(FhPipe *fp) {
+    // new files: statx first, openat when it is known to be a regular file
+    for (size_t ss = 0; ss < fp->open_files && fp->next < fp->count; ss++) {
+        FhFile *file = &fp->files[ss];
+        if (file->job != FHPIPE_FREE)
+            continue;
+        if (fp->ops >= fp->ring.entries)
+            return;
+        while (fp->next < fp->count && fp->fhs[fp->next].filename == NULL) {
+            if (fp->ok != NULL)
+                fp->ok[fp->next] = false;
+            fp->next++;
+        }
+        if (fp->next == fp->count)
+            break;
+        const char *filename = fp->fhs[fp->next].filename;
+        struct io_uring_sqe *sqe = fhring_get_sqe(&fp->ring);
+        if (sqe == NULL)
+            return;
+        file->job = fp->next++;
+        file->fd = -1;
+        file->issued = file->hashed = 0;
+        file->failed = false;
+        file->until_eof = false;
+        file->inflight = 1;
+        sha1_init(&file->ctx);
+        sqe->opcode = IORING_OP_STATX;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t)(uintptr_t)filename;
+        sqe->len = STATX_TYPE | STATX_SIZE;
+        sqe->off = (uint64_t)(uintptr_t)&file->stx;
+        sqe->user_data = FHPIPE_USER_DATA(FHPIPE_OP_STATX, ss);
+        fp->ops++;
+        fp->running++;
+    }
+
+    // reads: round robin over the open files, FHPIPE_FILE_DEPTH each at most
+    size_t bb = 0;
+    int progress = 1;
+    while (progress) {
+        progress = 0;
+        for (size_t ss = 0; ss < fp->open_files; ss++) {
+            FhFile *file = &fp->files[ss];
+            if (file->job == FHPIPE_FREE || file->fd < 0 || file->failed || file->inflight >= FHPIPE_FILE_DEPTH)
+                continue;
+            if (file->until_eof ? file->inflight > 0 : file->issued >= file->size)
+                continue;
+            while (bb < fp->queue_depth && fp->bufs[bb].slot != FHPIPE_FREE)
+                bb++;
+            if (bb == fp->queue_depth || fp->ops >= fp->ring.entries)
+                return;
+
+            FhBuf *buf = &fp->bufs[bb];
+            uint64_t left = file->until_eof ? fp->chunk_len : file->size - file->issued;
+            buf->slot = ss;
+            buf->offset = file->issued;
+            buf->len = left < fp->chunk_len ? (size_t)left : fp->chunk_len;
+            buf->done = 0;
+            buf->ready = false;
+            if (!fhpipe_queue_read(fp, bb)) {
+                buf->slot = FHPIPE_FREE;
+                return;
+            }
+            file->issued += buf->len;
+            progress = 1;
+        }
+    }
+}
+
+/**
+ * @brief Hash the ready chunks of a file that are next in file order
+ */
+static void fhpipe_hash_ready(FhPipe *fp, size_t slot) {
+    FhFile *file = &fp->files[slot];
+    int progress = 1;
+    while (progress) {
+        progress = 0;
+        for (size_t bb = 0; bb < fp->queue_depth; bb++) {
+            FhBuf *buf = &fp->bufs[bb];
+            if (buf->slot != slot || !buf->ready || buf->offset != file->hashed)
+                continue;
+            if (!file->failed)
+                sha1_update(&file->ctx, buf->data, buf->len);
+            file->hashed += buf->len;
+            buf->slot = FHPIPE_FREE;
+            progress = 1;
+        }
+    }
+}
+
+/**
+ * @brief Drop the chunks of a failed file that are not in flight
+ */
+static void fhpipe_drop_ready(FhPipe *fp, size_t slot) {
+    for (size_t bb = 0; bb < fp->queue_depth; bb++) {
+        if (fp->bufs[bb].slot == slot && fp->bufs[bb].ready)
+            fp->bufs[bb].slot = FHPIPE_FREE;
+    }
+}
+
+/**
+ * @brief Handle one completion
+ */
+static void fhpipe_complete(FhPipe *fp, uint64_t user_data, int res) {
+    uint64_t op = user_data >> 32;
+    size_t idx = (size_t)(user_data & 0xFFFFFFFFu);
+    size_t slot = op == FHPIPE_OP_READ ? fp->bufs[idx].slot : idx;
+    FhFile *file = &fp->files[slot];
+
+    fp->ops--;
+    file->inflight--;
+
+    if (op == FHPIPE_OP_STATX) {
+        if (res < 0 || !S_ISREG(file->stx.stx_mode)) {
+            fhpipe_finish(fp, slot, false); // same as fsha1: silent
+            return;
+        }
+        file->size = file->stx.stx_size;
+        struct io_uring_sqe *sqe = fhring_get_sqe(&fp->ring);
+        if (sqe == NULL) {
+            fhring_submit(&fp->ring, 0); // make room, cannot fail for long
+            sqe = fhring_get_sqe(&fp->ring);
+        }
+        if (sqe == NULL) {
+            fhpipe_finish(fp, slot, false);
+            return;
+        }
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = (uint64_t)(uintptr_t)fp->fhs[file->job].filename;
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        sqe->user_data = FHPIPE_USER_DATA(FHPIPE_OP_OPEN, slot);
+        file->inflight++;
+        fp->ops++;
+        return;
+    }
+
+    if (op == FHPIPE_OP_OPEN) {
+        if (res < 0) {
+            fprintf(stderr, "[fhsha1_pipeline] Cannot open %s: %s\n", fp->fhs[file->job].filename, strerror(-res));
+            fhpipe_finish(fp, slot, false);
+            return;
+        }
+        file->fd = res;
+        // a size of 0 is not trusted: procfs and sysfs files have content anyway
+        file->until_eof = file->size == 0;
+        return;
+    }
+
+    FhBuf *buf = &fp->bufs[idx];
+    if (res == -EINTR || res == -EAGAIN) {
+        if (fhpipe_queue_read(fp, idx))
+            return;
+        res = -EAGAIN;
+    }
+    if (file->until_eof && res >= 0) {
+        // any short read is a chunk, 0 is the end of the file
+        if (res == 0) {
+            buf->slot = FHPIPE_FREE;
+            fhpipe_finish(fp, slot, true);
+            return;
+        }
+        buf->len = buf->done = (size_t)res;
+        file->issued = buf->offset + buf->len;
+        buf->ready = true;
+        fhpipe_hash_ready(fp, slot);
+        return;
+    }
+    if (res <= 0) {
+        // error, or end of file before the statx size: truncated meanwhile
+        if (!file->failed)
+            fprintf(stderr, "[fhsha1_pipeline] Cannot read %s: %s\n", fp->fhs[file->job].filename,
+                    res < 0 ? strerror(-res) : "file truncated");
+        file->failed = true;
+        buf->slot = FHPIPE_FREE;
+    } else {
+        buf->done += (size_t)res;
+        if (buf->done < buf->len && fhpipe_queue_read(fp, idx))
+            return; // short read, ask for the rest
+        if (buf->done < buf->len) {
+            file->failed = true;
+            buf->slot = FHPIPE_FREE;
+        } else {
+            buf->ready = true;
+            fhpipe_hash_ready(fp, slot);
+        }
+    }
+
+    if (file->failed) {
+        fhpipe_drop_ready(fp, slot);
+        if (file->inflight == 0)
+            fhpipe_finish(fp, slot, false);
+    } else if (file->hashed == file->size) {
+        fhpipe_finish(fp, slot, true);
+    }
+}
+
+/**
+ * @brief Run the io_uring pipeline
+ *
+ * @return number of files hashed, or SIZE_MAX if io_uring cannot be used
+ *         (nothing has been started: the caller can fall back)
+ */
+static size_t fhpipe_uring_run(Fhash *fhs, size_t count, bool ok[], const FhPipeOptions *options) {
+    FhPipe fp;
+    memset(&fp, 0, sizeof(fp));
+    fp.fhs = fhs;
+    fp.ok = ok;
+    fp.count = count;
+    fp.queue_depth = options->queue_depth ? options->queue_depth : FHPIPE_QUEUE_DEPTH;
+    fp.chunk_len = options->chunk_len ? options->chunk_len : FHPIPE_CHUNK_LEN;
+    fp.open_files = options->open_files ? options->open_files : FHPIPE_OPEN_FILES;
+    if (fp.queue_depth > UINT16_MAX)
+        fp.queue_depth = UINT16_MAX; // buf_index is 16 bits
+    if (fp.chunk_len > (size_t)1 << 30)
+        fp.chunk_len = (size_t)1 << 30;
+
+    if (!fhring_setup(&fp.ring, (unsigned)(fp.queue_depth + 2 * fp.open_files)))
+        return SIZE_MAX;
+    if (!fhring_probe(&fp.ring)) {
+        fhring_destroy(&fp.ring);
+        return SIZE_MAX;
+    }
+
+    fp.files = calloc(fp.open_files, sizeof(FhFile));
+    fp.bufs = calloc(fp.queue_depth, sizeof(FhBuf));
+    struct iovec *iovs = calloc(fp.queue_depth, sizeof(struct iovec));
+    void *memory = NULL;
+    if (fp.files == NULL || fp.bufs == NULL || iovs == NULL ||
+        posix_memalign(&memory, 4096, fp.queue_depth * fp.chunk_len) != 0) {
+        perror("[fhsha1_pipeline] Cannot allocate the pipeline");
+        free(fp.files);
+        free(fp.bufs);
+        free(iovs);
+        fhring_destroy(&fp.ring);
+        return SIZE_MAX;
+    }
+    fp.memory = memory;
+
+    for (size_t ss = 0; ss < fp.open_files; ss++) {
+        fp.files[ss].job = FHPIPE_FREE;
+        fp.files[ss].fd = -1;
+    }
+    for (size_t bb = 0; bb < fp.queue_depth; bb++) {
+        fp.bufs[bb].slot = FHPIPE_FREE;
+        fp.bufs[bb].data = fp.memory + bb * fp.chunk_len;
+        iovs[bb].iov_base = fp.bufs[bb].data;
+        iovs[bb].iov_len = fp.chunk_len;
+    }
+    // pinned once, then IORING_OP_READ_FIXED. Plain reads if refused (RLIMIT_MEMLOCK on old kernels)
+    fp.fixed = syscall(__NR_io_uring_register, fp.ring.fd, IORING_REGISTER_BUFFERS, iovs, fp.queue_depth) == 0;
+    free(iovs);
+
+    while (fp.next < fp.count || fp.running > 0) {
+        fhpipe_fill(&fp);
+        if (!fhring_submit(&fp.ring, fp.ops > 0)) {
+            perror("[fhsha1_pipeline] io_uring_enter");
+            break;
+        }
+
+        unsigned head = *fp.ring.cq_head;
+        unsigned tail = __atomic_load_n(fp.ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail; head++) {
+            struct io_uring_cqe *cqe = &fp.ring.cqes[head & *fp.ring.cq_mask];
+            fhpipe_complete(&fp, cqe->user_data, cqe->res);
+        }
+        __atomic_store_n(fp.ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+
+    // only on io_uring_enter failure: release what is still open
+    for (size_t ss = 0; ss < fp.open_files; ss++) {
+        if (fp.files[ss].job != FHPIPE_FREE)
+            fhpipe_finish(&fp, ss, false);
+    }
+    fhring_destroy(&fp.ring);
+    // the kernel cancels the reads still in flight asynchronously: their buffers are leaked, not reused
+    if (fp.ops == 0)
+        free(fp.memory);
+    free(fp.files);
+    free(fp.bufs);
+    return fp.hashed;
+}
+
+/** @copydoc fhpipe_uring_available */
+bool fhpipe_uring_available(void) {
+    FhRing ring;
+    if (!fhring_setup(&ring, 4))
+        return false;
+    bool res = fhring_probe(&ring);
+    fhring_destroy(&ring);
+    return res;
+}
+#else
+/** @copydoc fhpipe_uring_available */
+bool fhpipe_uring_available(void) {
+    return false;
+}
+#endif
+
+/** @copydoc fhsha1_pipeline */
+size_t fhsha1_pipeline(Fhash *fhs, size_t count, bool ok[], const FhPipeOptions *options, FhPipeEngine *used) {
+    static const FhPipeOptions defaults = {0};
+    if (options == NULL)
+        options = &defaults;
+    if (used != NULL)
+        *used = FHPIPE_AUTO;
+    if (fhs == NULL || count == 0)
+        return 0;
+
+#ifdef FHPIPE_HAS_URING
+    if (options->engine != FHPIPE_THREADS) {
+        size_t hashed = fhpipe_uring_run(fhs, count, ok, options);
+        if (hashed != SIZE_MAX) {
+            if (used != NULL)
+                *used = FHPIPE_URING;
+            return hashed;
+        }
+    }
+#endif
+    if (options->engine == FHPIPE_URING) {
+        fprintf(stderr, "[fhsha1_pipeline] io_uring is not available\n");
+        return 0;
+    }
+    if (used != NULL)
+        *used = FHPIPE_THREADS;
+    return fhpool_run(fhs, count, ok, options->threads);
+}
@@ -0,0 +1,72 @@
+/**
+ * @brief Asynchronous file hashing pipeline (io_uring, thread pool fallback)
+ *
+ * fsha1 runs stat, open, read... close one file at a time: the storage
+ * sees at most one request, far from the queue depth NVMe devices need.
+ * fhsha1_pipeline keeps many files in flight instead:
+ * - statx and openat of the next files are queued on an io_uring ring
+ *   (batched, no thread blocked)
+ * - every open file gets several reads in flight into registered buffers
+ *   (IORING_OP_READ_FIXED, no per read page pinning)
+ * - completed chunks are fed, in file order, to the SHA-1 context of their
+ *   file while the next reads are already queued
+ *
+ * The ring is driven with raw syscalls (no liburing). Where io_uring is not
+ * available (old kernel, disabled by sysctl or seccomp, non Linux) the same
+ * call runs fhsha1 on a pool of threads.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef FHPIPE_H
+#define FHPIPE_H
+
+#include "sha1.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define FHPIPE_QUEUE_DEPTH 64          // reads in flight
+#define FHPIPE_CHUNK_LEN (256 * 1024)  // bytes per read
+#define FHPIPE_OPEN_FILES 32           // files open at once
+#define FHPIPE_FILE_DEPTH 8            // reads in flight per file
+
+typedef enum {
+    FHPIPE_AUTO,   // io_uring if available, else threads
+    FHPIPE_URING,  // io_uring only
+    FHPIPE_THREADS // thread pool only
+} FhPipeEngine;
+
+typedef struct
+{
+    FhPipeEngine engine; // engine to use
+    size_t queue_depth;  // io_uring: reads in flight (0 = FHPIPE_QUEUE_DEPTH)
+    size_t chunk_len;    // io_uring: bytes per read (0 = FHPIPE_CHUNK_LEN)
+    size_t open_files;   // io_uring: files open at once (0 = FHPIPE_OPEN_FILES)
+    size_t threads;      // thread pool: workers (0 = online CPUs)
+} FhPipeOptions;
+
+/**
+ * @brief Is io_uring usable (ring setup and the needed opcodes)?
+ */
+bool fhpipe_uring_available(void);
+
+/**
+ * @brief Engine name, e.g. "io_uring"
+ */
+const char *fhpipe_engine_name(FhPipeEngine engine);
+
+/**
+ * @brief Computes the SHA-1 of many files, like fhsha1 on each of them
+ *
+ * Files that cannot be hashed (not regular, cannot be opened or read) keep
+ * their hash untouched.
+ *
+ * @param[in,out] fhs files, hash is written for every hashed file
+ * @param[in] count number of files
+ * @param[out] ok per file result (can be NULL)
+ * @param[in] options options (can be NULL for the defaults)
+ * @param[out] used engine that did the work (can be NULL)
+ * @returns number of files hashed
+ */
+size_t fhsha1_pipeline(Fhash *fhs, size_t count, bool ok[], const FhPipeOptions *options, FhPipeEngine *used);
+
+#endif // FHPIPE_H
@@ -0,0 +1,138 @@
+#define _GNU_SOURCE // O_DIRECT, madvise, posix_fadvise
+#include "fileio.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/** @copydoc fileio_pick */
+FileIo fileio_pick(uint64_t size) {
+    if (size < FILEIO_DIRECT_MIN)
+        return FILEIO_READ;
+    return FILEIO_DIRECT;
+}
+
+/** @copydoc fileio_name */
+const char *fileio_name(FileIo io) {
+    switch (io) {
+    case FILEIO_AUTO:
+        return "auto";
+    case FILEIO_READ:
+        return "read";
+    case FILEIO_MMAP:
+        return "mmap";
+    case FILEIO_DIRECT:
+        return "direct";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief read() loop into an aligned buffer
+ *
+ * With O_DIRECT, a file system that accepts the flag at open but not the
+ * read (EINVAL) gets the flag removed and the read retried.
+ *
+ * Reads until EOF whatever the size: procfs, sysfs and some FUSE files
+ * report a size of 0 but have content.
+ *
+ * @param[in] fd open file
+ * @param[in] size file size, to size the buffer of small files
+ */
+static bool fileio_read_loop(int fd, uint64_t size, FileIoChunkFn fn, void *ctx) {
+    size_t buff_len = FILEIO_BUFF_LEN;
+    if (size < buff_len)
+        buff_len = (size_t)(size / FILEIO_ALIGN + 1) * FILEIO_ALIGN;
+
+    void *buffer = NULL;
+    if (posix_memalign(&buffer, FILEIO_ALIGN, buff_len) != 0) {
+        fprintf(stderr, "[fileio_stream] Cannot allocate the read buffer\n");
+        return false;
+    }
+
+    bool res = true;
+    for (;;) {
+        ssize_t bytes_read = read(fd, buffer, buff_len);
+        if (bytes_read < 0) {
+            int flags = fcntl(fd, F_GETFL);
+            if (errno == EINTR)
+                continue;
+            if (errno == EINVAL && flags >= 0 && (flags & O_DIRECT) && fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0)
+                continue;
+            perror("[fileio_stream] read");
+            res = false;
+            break;
+        }
+        if (bytes_read == 0)
+            break;
+        if (!fn(ctx, buffer, (size_t)bytes_read)) {
+            res = false;
+            break;
+        }
+    }
+    free(buffer);
+    return res;
+}
+
+/**
+ * @brief Map the whole file and hand it to fn in one call
+ *
+ * @return 1 done, 0 error, -1 cannot map (the caller falls back to read)
+ */
+static int fileio_mmap(int fd, uint64_t size, FileIoChunkFn fn, void *ctx) {
+    if (size > SIZE_MAX)
+        return -1; // 32-bit address space
+
+    uint8_t *map = mmap(NULL, (size_t)size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+        return -1;
+    madvise(map, (size_t)size, MADV_SEQUENTIAL); // only a hint
+
+    int res = fn(ctx, map, (size_t)size) ? 1 : 0;
+    munmap(map, (size_t)size);
+    return res;
+}
+
+/** @copydoc fileio_stream */
+bool fileio_stream(const char *filename, FileIo io, FileIoChunkFn fn, void *ctx) {
+    if (filename == NULL || fn == NULL) {
+        fprintf(stderr, "[fileio_stream] Invalid parameters\n");
+        return false;
+    }
+
+    // stat before open: opening a fifo would block
+    // the size only picks the strategy, it is not trusted to be the content length
+    struct stat st;
+    if (stat(filename, &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+    uint64_t size = (uint64_t)st.st_size;
+    if (io == FILEIO_AUTO)
+        io = fileio_pick(size);
+
+    int fd = open(filename, O_RDONLY | (io == FILEIO_DIRECT ? O_DIRECT : 0));
+    if (fd < 0 && io == FILEIO_DIRECT && errno == EINVAL) {
+        io = FILEIO_READ; // no O_DIRECT on this file system
+        fd = open(filename, O_RDONLY);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "[fileio_stream] Cannot open %s: %s\n", filename, strerror(errno));
+        return false;
+    }
+
+    bool res = true;
+    if (io == FILEIO_MMAP && size > 0) {
+        int mapped = fileio_mmap(fd, size, fn, ctx);
+        res = mapped < 0 ? fileio_read_loop(fd, size, fn, ctx) : mapped == 1;
+    } else {
+        if (io == FILEIO_READ)
+            posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL); // only a hint
+        res = fileio_read_loop(fd, size, fn, ctx);
+    }
+
+    close(fd);
+    return res;
+}
@@ -0,0 +1,79 @@
+/**
+ * @brief Sequential whole-file reader with selectable I/O strategy
+ *
+ * fileio_stream hands the content of a file, in order, to a callback
+ * (a hash update, a checksum...). How the bytes get to memory depends on
+ * the strategy:
+ * - FILEIO_READ: read() into a 1 MB page aligned buffer, with
+ *   posix_fadvise(SEQUENTIAL) so the kernel reads ahead aggressively.
+ *   One syscall and one copy per MB.
+ * - FILEIO_MMAP: the whole file is mapped with MADV_SEQUENTIAL and given
+ *   to the callback in one call, no copy. The kernel reads ahead and
+ *   reclaims the pages behind the cursor first. The file must not be
+ *   truncated while it is read (SIGBUS), so it is never picked by
+ *   FILEIO_AUTO: only for callers that control the file. A file of size 0
+ *   is read instead (procfs and sysfs files have content anyway).
+ * - FILEIO_DIRECT: O_DIRECT reads into the aligned buffer, bypassing the
+ *   page cache. Slower on a file already cached, but reading a cold huge
+ *   file does not evict everything else. Falls back to FILEIO_READ on file
+ *   systems without O_DIRECT (tmpfs).
+ * - FILEIO_AUTO: chosen by file size, see fileio_pick.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef FILEIO_H
+#define FILEIO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define FILEIO_BUFF_LEN (1024 * 1024)             // read / direct buffer
+#define FILEIO_ALIGN 4096                         // buffer alignment (O_DIRECT)
+#define FILEIO_DIRECT_MIN ((uint64_t)4 << 30)     // auto: O_DIRECT from this size
+
+typedef enum {
+    FILEIO_AUTO,  // by file size
+    FILEIO_READ,  // read() + posix_fadvise(SEQUENTIAL)
+    FILEIO_MMAP,  // mmap + MADV_SEQUENTIAL
+    FILEIO_DIRECT // O_DIRECT, no page cache
+} FileIo;
+
+/**
+ * @brief Consume the next len bytes of the file
+ *
+ * @param[in] ctx caller context
+ * @param[in] data bytes, valid only during the call
+ * @param[in] len number of bytes (> 0)
+ * @return true to continue, false to stop (fileio_stream returns false)
+ */
+typedef bool (*FileIoChunkFn)(void *ctx, const uint8_t *data, size_t len);
+
+/**
+ * @brief Strategy used by FILEIO_AUTO for a file of size bytes
+ *
+ * - < FILEIO_DIRECT_MIN: FILEIO_READ, a read error is reported instead of
+ *   the SIGBUS of a mapping when the file is truncated meanwhile
+ * - otherwise FILEIO_DIRECT: such a file is rarely in cache and would
+ *   flush it
+ */
+FileIo fileio_pick(uint64_t size);
+
+/**
+ * @brief Strategy name, e.g. "mmap"
+ */
+const char *fileio_name(FileIo io);
+
+/**
+ * @brief Read a whole regular file through fn
+ *
+ * @param[in] filename file to read
+ * @param[in] io strategy
+ * @param[in] fn chunk consumer
+ * @param[in] ctx passed to fn
+ * @return true if the whole file has been consumed, false on error
+ *         (not a regular file, I/O error, fn returned false)
+ */
+bool fileio_stream(const char *filename, FileIo io, FileIoChunkFn fn, void *ctx);
+
+#endif // FILEIO_H
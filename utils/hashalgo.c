@@ -0,0 +1,91 @@
+#include "hashalgo.h"
+#include "fhpipe.h"
+#include "sha1mb.h"
+#include "sha1tree.h"
+#include "sha256mb.h"
+#include "xxh3.h"
+#include <stdio.h>
+#include <string.h>
+
+/** @copydoc hash_algo_parse */
+bool hash_algo_parse(const char *name, HashAlgo *algo) {
+    if (name == NULL || algo == NULL)
+        return false;
+    if (strcmp(name, "sha1") == 0) {
+        *algo = HASH_ALGO_SHA1;
+        return true;
+    }
+    if (strcmp(name, "sha1tree") == 0) {
+        *algo = HASH_ALGO_SHA1TREE;
+        return true;
+    }
+    if (strcmp(name, "sha256") == 0) {
+        *algo = HASH_ALGO_SHA256;
+        return true;
+    }
+    if (strcmp(name, "xxh3") == 0) {
+        *algo = HASH_ALGO_XXH3;
+        return true;
+    }
+    return false;
+}
+
+/** @copydoc hash_algo_name */
+const char *hash_algo_name(HashAlgo algo) {
+    switch (algo) {
+    case HASH_ALGO_SHA1:
+        return "sha1";
+    case HASH_ALGO_SHA1TREE:
+        return "sha1tree";
+    case HASH_ALGO_SHA256:
+        return "sha256";
+    case HASH_ALGO_XXH3:
+        return "xxh3";
+    }
+    return "unknown";
+}
+
+/** @copydoc hash_algo_length */
+size_t hash_algo_length(HashAlgo algo) {
+    switch (algo) {
+    case HASH_ALGO_SHA256:
+        return SHA256_LENGTH;
+    case HASH_ALGO_XXH3:
+        return XXH3_LENGTH;
+    default:
+        return SHA1_LENGTH;
+    }
+}
+
+/** @copydoc fhash_files */
+size_t fhash_files(Fhash *fhs, size_t count, bool ok[], HashAlgo algo, bool pipeline) {
+    // Fhash.hash fits the largest hash: clear the bytes the shorter ones leave
+    for (size_t ii = 0; ii < count; ii++)
+        memset(fhs[ii].hash, 0, sizeof(fhs[ii].hash));
+
+    if (algo == HASH_ALGO_SHA256)
+        return fhsha256_mb(fhs, count, ok); // many files at once, one per SIMD lane
+    if (algo == HASH_ALGO_SHA1) {
+        if (pipeline)
+            return fhsha1_pipeline(fhs, count, ok, NULL, NULL); // deep I/O queue
+        return fhsha1_mb(fhs, count, ok);                       // many files at once, one per SIMD lane
+    }
+
+    // one file at a time: xxh3 runs at memory speed, sha1tree uses every core on each file
+    size_t hashed = 0;
+    for (size_t ii = 0; ii < count; ii++) {
+        ok[ii] = algo == HASH_ALGO_SHA1TREE ? fhsha1tree(&fhs[ii]) : fhxxh3(&fhs[ii]);
+        if (ok[ii])
+            hashed++;
+    }
+    return hashed;
+}
+
+/** @copydoc fhprint_algo */
+void fhprint_algo(const Fhash *fh, HashAlgo algo) {
+    for (size_t ii = 0; ii < hash_algo_length(algo); ii++) {
+        // print in hex format
+        printf("%02x", fh->hash[ii]);
+    }
+    printf("  %s\n", fh->filename);
+}
@@ -0,0 +1,69 @@
+/**
+ * @brief Hash algorithm selection for the file tools
+ *
+ * deldup and hash work on Fhash arrays: this picks the algorithm that
+ * fills them and prints them, so the tools only parse a name.
+ * - sha1: cryptographic, multi-buffer or io_uring pipeline (see sha1mb.h, fhpipe.h)
+ * - sha1tree: SHA-1 Merkle tree, huge files on every core (see sha1tree.h)
+ * - sha256: cryptographic, collision resistant, multi-buffer (see sha256mb.h)
+ * - xxh3: non-cryptographic XXH3 128-bit, memory speed (see xxh3.h)
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef HASHALGO_H
+#define HASHALGO_H
+
+#include "sha1.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    HASH_ALGO_SHA1,     // SHA-1, 20 bytes
+    HASH_ALGO_SHA1TREE, // SHA-1 Merkle tree, 20 bytes
+    HASH_ALGO_SHA256,   // SHA-256, 32 bytes
+    HASH_ALGO_XXH3      // XXH3 128-bit, 16 bytes
+} HashAlgo;
+
+/**
+ * @brief Algorithm from its name ("sha1", "sha1tree", "sha256", "xxh3")
+ *
+ * @param[in] name algorithm name
+ * @param[out] algo parsed algorithm
+ * @returns false if the name is unknown
+ */
+bool hash_algo_parse(const char *name, HashAlgo *algo);
+
+/**
+ * @brief Algorithm name, e.g. "xxh3"
+ */
+const char *hash_algo_name(HashAlgo algo);
+
+/**
+ * @brief Hash length in bytes (at most FHASH_LENGTH, the size of Fhash.hash)
+ */
+size_t hash_algo_length(HashAlgo algo);
+
+/**
+ * @brief Hash many files with algo
+ *
+ * The bytes of fh->hash after the hash length are zeroed.
+ *
+ * @param[in,out] fhs files, hash is written for every hashed file
+ * @param[in] count number of files
+ * @param[out] ok per file result
+ * @param[in] algo algorithm
+ * @param[in] pipeline sha1 only: io_uring pipeline instead of multi-buffer
+ * @returns number of files hashed
+ */
+size_t fhash_files(Fhash *fhs, size_t count, bool ok[], HashAlgo algo, bool pipeline);
+
+/**
+ * @brief print fhash to stdout, like fhprint with the algo hash length
+ *
+ * 99aa06d3014798d86001c324468d497f  test.txt
+ * @param[in] fh hashed file
+ * @param[in] algo algorithm
+ */
+void fhprint_algo(const Fhash *fh, HashAlgo algo);
+
+#endif // HASHALGO_H
@@ -17,57 +17,114 @@ static int is_power_of_two(size_t n) {
 
 /** @copydoc hmap_create */
 HMap *hmap_create(size_t capacity) {
+    return hmap_create_with(capacity, NULL);
+}
+
+/** @copydoc hmap_create_with */
+HMap *hmap_create_with(size_t capacity, const Allocator *allocator) {
     if (capacity <= 0 || !is_power_of_two(capacity)) {
         fprintf(stderr, "[hmap_create] Invalid capacity\n");
         return NULL;
     }
 
-    HMap *map = calloc(1, sizeof(HMap));
+    allocator = allocator_or_default(allocator);
+    HMap *map = allocator_calloc(allocator, 1, sizeof(HMap));
     if (map == NULL) {
         perror("[hmap_create] Cannot create hmap: out of memory\n");
         return NULL;
     }
 
+    map->allocator = *allocator;
+    map->entry_allocator = *allocator;
     map->len = 0;
     map->capacity = capacity;
-    map->entries = calloc(capacity, sizeof(HEntry *));
+    map->entries = allocator_calloc(allocator, capacity, sizeof(HEntry *));
     if (map->entries == NULL) {
         perror("[hmap_create] Cannot create entries: out of memory\n");
-        free(map);
+        allocator_free(allocator, map, sizeof(HMap));
+        return NULL;
+    }
+    return map;
+}
+
+/** @copydoc hmap_create_pooled */
+HMap *hmap_create_pooled(size_t capacity, size_t slab_len) {
+    Pool *pool = POOL_CREATE(HEntry, slab_len);
+    if (pool == NULL)
+        return NULL;
+
+    HMap *map = hmap_create_with_pool(capacity, pool);
+    if (map == NULL) {
+        pool_destroy(pool);
         return NULL;
     }
+    map->owns_pool = 1;
+    return map;
+}
+
+/** @copydoc hmap_create_with_pool */
+HMap *hmap_create_with_pool(size_t capacity, Pool *pool) {
+    if (pool == NULL || pool->elem_size < sizeof(HEntry)) {
+        fprintf(stderr, "[hmap_create_with_pool] Invalid pool\n");
+        return NULL;
+    }
+
+    HMap *map = hmap_create(capacity);
+    if (map == NULL)
+        return NULL;
+    map->pool = pool;
+    map->entry_allocator = pool_allocator(pool);
     return map;
 }
 
+/**
+ * @brief create an hash map entry
+ *
+ * Allocate an entry with the entry allocator (the map pool when the map is pooled)
+ *
+ * @param[in] map
+ * @return entry or NULL in case of error
+ */
+static HEntry *hentry_create(HMap *map) {
+    return allocator_alloc(&map->entry_allocator, sizeof(HEntry));
+}
+
 /**
  * @brief destroy the hash map entry
  *
  * Free the memory of the hash map entry
  *
+ * @param[in] map
  * @param[in] entry to destroy
  */
-static void hentry_destroy(HEntry *entry) {
+static void hentry_destroy(HMap *map, HEntry *entry) {
     if (entry == NULL)
         return;
-    free(entry);
+    allocator_free(&map->entry_allocator, entry, sizeof(HEntry));
 }
 
 /** @copydoc hmap_destroy */
 void hmap_destroy(HMap *map) {
     if (map == NULL)
         return;
+    Allocator allocator = map->allocator; // the map itself is released last
     if (map->entries == NULL) {
-        free(map);
+        allocator_free(&allocator, map, sizeof(HMap));
         return;
     }
 
-    for (size_t ii = 0; ii < map->capacity; ii++) {
-        if (map->entries[ii] != NULL)
-            hentry_destroy(map->entries[ii]);
+    // an owned pool releases every entry at once
+    if (map->owns_pool) {
+        pool_destroy(map->pool);
+    } else {
+        for (size_t ii = 0; ii < map->capacity; ii++) {
+            if (map->entries[ii] != NULL)
+                hentry_destroy(map, map->entries[ii]);
+        }
     }
 
-    free(map->entries);
-    free(map);
+    allocator_free(&allocator, map->entries, sizeof(HEntry *) * map->capacity);
+    allocator_free(&allocator, map, sizeof(HMap));
 }
 
 /**
@@ -159,85 +216,73 @@ HEntry *hmap_get(HMap *map, char *key) {
 }
 
 /**
- * @brief Get HEntry given the index
+ * @brief Hash map rehash
  *
- * Return the HEntry given the main array index. In case of collision is returned the first one.
- * Set 1 to the out param needs_grow if input idx is out of bound
- *
- * @param[in] map
- * @param[in] idx
- * @param[out] needs_grow
- * @return Return description
- */
-static HEntry *hmap_get_by_idx(HMap *map, size_t idx, int *needs_grow) {
-    if (idx >= map->capacity) {
-        // index out of bound
-        (*needs_grow) = 1;
-        return NULL;
-    }
-    return map->entries[idx];
-}
-
-/**
- * @brief Hash map grow
- *
- * Increase hash map capacity
+ * Move the live entries to a new array of new_capacity slots and free the
+ * tombstones, so that probe chains are short again
  *
  * @param[in] map
+ * @param[in] new_capacity power of two, greater than map->len
  * @return new capacity or 0 in case of error
  */
-static size_t hmap_grow(HMap *map) {
-    // if capacity if full then resize
-    size_t new_capacity = map->capacity * 2;
-    void *temp = calloc(new_capacity, sizeof(HEntry *));
+static size_t hmap_rehash(HMap *map, size_t new_capacity) {
+    void *temp = allocator_calloc(&map->allocator, new_capacity, sizeof(HEntry *));
     if (!temp) {
-        perror("[hmap_grow] Reallocation failed! The old data are still valid");
+        perror("[hmap_rehash] Reallocation failed! The old data are still valid");
         return 0;
     }
 
-    // rehashing
     HEntry **new_entries = (HEntry **)temp;
-    size_t ele_count = map->len;
 
-    for (size_t ii = 0; ii < map->capacity && ele_count > 0; ii++) {
+    // every slot is visited: tombstones can follow the last live entry
+    for (size_t ii = 0; ii < map->capacity; ii++) {
         if (map->entries[ii] == NULL)
             continue;
 
         // Skip and free tombstones during rehashing
         if (map->entries[ii]->type == HE_TYPE_NULL) {
-            hentry_destroy(map->entries[ii]);
+            hentry_destroy(map, map->entries[ii]);
             continue;
         }
 
         size_t new_idx = hmap_build_idx(map->entries[ii]->key, new_capacity);
-
-        // Add bounds checking to prevent buffer overflow
-        while (new_entries[new_idx] != NULL) {
-            new_idx++;
-            if (new_idx >= new_capacity) // Bounds check
-                new_idx = 0;             // Wrap around
-        }
+        while (new_entries[new_idx] != NULL)
+            new_idx = (new_idx + 1) & (new_capacity - 1); // wrap around
 
         new_entries[new_idx] = map->entries[ii];
-        ele_count--;
     }
 
-    free(map->entries); // frees old entries
+    allocator_free(&map->allocator, map->entries, sizeof(HEntry *) * map->capacity); // frees old entries
 
     map->entries = new_entries;   // assign new ones
     map->capacity = new_capacity; // with new capacity
+    map->tombstones = 0;
 
     return map->capacity;
 }
 
+/**
+ * @brief Hash map grow
+ *
+ * Increase hash map capacity
+ *
+ * @param[in] map
+ * @return new capacity or 0 in case of error
+ */
+static size_t hmap_grow(HMap *map) {
+    return hmap_rehash(map, map->capacity * 2);
+}
+
 /** @copydoc hmap_add */
 int hmap_add(HMap *map, char *key, void *value, HEType type, uint32_t value_size) {
     if (map == NULL)
         return 0;
 
-    if (map->len > map->capacity / 2) {
-        // hash map grows when capacity is half of the occupied len
-        if (!hmap_grow(map))
+    if (map->len + map->tombstones > map->capacity / 2) {
+        // the occupied slots (live + tombstones) are more than half the capacity:
+        // mostly tombstones then clean up in place, else grow
+        size_t res = map->tombstones > map->len ? hmap_rehash(map, map->capacity) : hmap_grow(map);
+        if (!res)
             return 0;
     }
 
@@ -249,6 +294,7 @@ int hmap_add(HMap *map, char *key, void *value, HEType type, uint32_t value_size
         return 0;
     }
 
+    HEntry *reuse = NULL; // first tombstone of the probe chain
     size_t probes = 0;
 
     while (cur != NULL) {
@@ -258,18 +304,12 @@ int hmap_add(HMap *map, char *key, void *value, HEType type, uint32_t value_size
             return 0;
         }
 
-        // the spot is already occupied
         if (cur->type == HE_TYPE_NULL) {
-            // the previous element is deleted logically then override
-            cur->key = key; // reassign the key
-            cur->value = value;
-            cur->type = type;
-            cur->value_size = value_size;
-            map->len++;
-            return 1;
-        }
-
-        if (strcmp(cur->key, key) == 0) {
+            // the element is deleted logically: remember the spot but keep
+            // probing, the key can be further in the chain
+            if (reuse == NULL)
+                reuse = cur;
+        } else if (strcmp(cur->key, key) == 0) {
             // if the key is equals
             cur->value = value;
             cur->type = type;
@@ -278,37 +318,28 @@ int hmap_add(HMap *map, char *key, void *value, HEType type, uint32_t value_size
         }
 
         // else is a collision then go to the right one until one free is found
-        int needs_grow = 0;
-        HEntry *new_cur = hmap_get_by_idx(map, ++idx, &needs_grow);
-        if (needs_grow) {
-            // Grow and RESTART the insertion
-            if (!hmap_grow(map))
-                return 0;
-
-            // Restart from scratch with new capacity
-            idx = (size_t)-1;
-            cur = hmap_get_first(map, key, &idx);
-            probes = 0;
-            continue;
-        } else {
-            // increment the cursor
-            cur = new_cur;
-        }
+        idx = (idx + 1) & (map->capacity - 1); // wrap around
+        cur = map->entries[idx];
     }
 
-    // add element in the spot
-    HEntry *entry = calloc(1, sizeof(HEntry));
-    if (entry == NULL) {
-        perror("[hmap_add] Cannot allocate entry");
-        return 0;
+    HEntry *entry = reuse;
+    if (entry != NULL) {
+        // override the tombstone
+        map->tombstones--;
+    } else {
+        // add element in the spot
+        entry = hentry_create(map);
+        if (entry == NULL) {
+            perror("[hmap_add] Cannot allocate entry");
+            return 0;
+        }
+        map->entries[idx] = entry;
     }
 
     entry->key = key;
     entry->value = value;
     entry->type = type;
     entry->value_size = value_size;
-
-    map->entries[idx] = entry;
     map->len++;
     return 1;
 }
@@ -323,6 +354,7 @@ int hmap_remove(HMap *map, char *key) {
         return 0;
     entry->type = HE_TYPE_NULL;
     map->len--;
+    map->tombstones++;
     return 1;
 }
 
@@ -351,6 +383,8 @@ int hmap_print(HEntry *entry) {
         int64_t *value = (int64_t *)entry->value;
         for (size_t kk = 0; kk < entry->value_size; kk++)
             printf("%ld ", value[kk]);
+    } else if (entry->type == HE_TYPE_PTR) {
+        printf("%p ", entry->value);
     }
 
     printf("}\n");
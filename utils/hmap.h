@@ -3,11 +3,18 @@
  * @author Alberto Ielpo <alberto.ielpo@gmail.com>
  *
  * This hash map implementation does not own the data
+ *
+ * Entries can be carved from a slab pool (see pool.h) instead of one calloc
+ * per entry: see hmap_create_pooled and hmap_create_with_pool.
+ * hmap_create_with routes every internal allocation to a custom allocator
+ * (see allocator.h).
  */
 #ifndef HMAP_H
 #define HMAP_H
 #define FNV_OFFSET 14695981039346656037UL
 #define FNV_PRIME 1099511628211UL
+#include "allocator.h"
+#include "pool.h"
 #include <stdint.h>
 #include <stdlib.h>
 
@@ -17,7 +24,8 @@ typedef enum {
     HE_TYPE_INT8,  //  8-bit signed integer pointer
     HE_TYPE_INT16, // 16-bit signed integer pointer
     HE_TYPE_INT32, // 32-bit signed integer pointer
-    HE_TYPE_INT64  // 64-bit signed integer pointer
+    HE_TYPE_INT64, // 64-bit signed integer pointer
+    HE_TYPE_PTR    // opaque pointer (e.g. a struct owned by the caller)
 } HEType;
 
 typedef struct
@@ -35,6 +43,11 @@ typedef struct
     HEntry **entries; // entries pointer array
     size_t len;
     size_t capacity;
+    size_t tombstones;         // deleted entries still in the array (see hmap_remove)
+    Allocator allocator;       // allocator of the map structure and of the entries array
+    Allocator entry_allocator; // allocator of the entries (the pool one when pooled)
+    Pool *pool;                // entry pool (NULL: entries come from allocator)
+    int owns_pool;             // 1 if the pool is released together with the map
 } HMap;
 
 /**
@@ -47,6 +60,41 @@ typedef struct
  */
 HMap *hmap_create(size_t capacity);
 
+/**
+ * @brief Create an hash map using a custom allocator
+ *
+ * Same as hmap_create but the map, the entries array and the entries are
+ * allocated with allocator.
+ *
+ * @param[in] capacity must be a power of two
+ * @param[in] allocator allocator to use, NULL means libc
+ * @return hash map pointer or NULL
+ */
+HMap *hmap_create_with(size_t capacity, const Allocator *allocator);
+
+/**
+ * @brief Create an hash map backed by its own entry pool
+ *
+ * Entries are carved from slabs of slab_len entries and released in bulk by
+ * hmap_destroy.
+ *
+ * @param[in] capacity must be a power of two
+ * @param[in] slab_len entries per slab, 0 means POOL_DEFAULT_SLAB_LEN
+ * @return hash map pointer or NULL
+ */
+HMap *hmap_create_pooled(size_t capacity, size_t slab_len);
+
+/**
+ * @brief Create an hash map using a shared entry pool
+ *
+ * The pool is not owned: the caller destroys it after every map using it.
+ *
+ * @param[in] capacity must be a power of two
+ * @param[in] pool pool created with an element size of at least sizeof(HEntry)
+ * @return hash map pointer or NULL
+ */
+HMap *hmap_create_with_pool(size_t capacity, Pool *pool);
+
 /**
  * @brief Destroy an hash map
  *
@@ -84,7 +132,8 @@ HEntry *hmap_get(HMap *map, char *key);
 /**
  * @brief Remove an element given the key
  *
- * Hash map logical deletion
+ * Hash map logical deletion: the slot becomes a tombstone, reused by a
+ * later hmap_add and freed when the map is rehashed
  *
  * @param[in] map
  * @param[in] key
@@ -0,0 +1,215 @@
+/**
+ * @file ilist.h
+ * @brief Intrusive doubly linked list (header only)
+ *
+ * Unlike LList, the list does not allocate nodes: the caller embeds an ILink
+ * inside its own struct and the list links those structs together. Payload
+ * and links share one allocation (or none, for stack/static structs), and
+ * walking the list touches the payload directly instead of following an
+ * extra elem pointer.
+ *
+ * The enclosing struct is recovered from a link with container_of /
+ * ilist_entry. A struct can be in several lists at once by embedding one
+ * ILink per list.
+ *
+ * The list is circular around a sentinel link stored in IList, so insert and
+ * remove never branch on head/tail.
+ *
+ * Example:
+ * @code
+ * typedef struct {
+ *     int id;
+ *     ILink link;
+ * } Job;
+ *
+ * IList queue;
+ * ilist_init(&queue);
+ * Job a = {.id = 1};
+ * ilist_push_back(&queue, &a.link);
+ * ilist_foreach(&queue, it) {
+ *     Job *job = ilist_entry(it, Job, link);
+ *     printf("%d\n", job->id);
+ * }
+ * @endcode
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef ILIST_H
+#define ILIST_H
+
+#include <stddef.h>
+
+/**
+ * @brief Get the enclosing struct from a pointer to one of its members
+ *
+ * @param ptr pointer to the member
+ * @param type type of the enclosing struct
+ * @param member name of the member inside type
+ */
+#ifndef container_of
+#define container_of(ptr, type, member) \
+    ((type *)((char *)(ptr) - offsetof(type, member)))
+#endif
+
+/**
+ * @brief Get the struct embedding an ILink
+ */
+#define ilist_entry(link, type, member) container_of(link, type, member)
+
+/**
+ * @brief Iterate over every link from head to tail
+ * The current link must not be removed inside the loop (see ilist_foreach_safe)
+ */
+#define ilist_foreach(list, it) \
+    for (ILink *it = (list)->head.next; it != &(list)->head; it = it->next)
+
+/**
+ * @brief Iterate over every link from tail to head
+ */
+#define ilist_foreach_reverse(list, it) \
+    for (ILink *it = (list)->head.prev; it != &(list)->head; it = it->prev)
+
+/**
+ * @brief Iterate over every link, the current one can be removed
+ */
+#define ilist_foreach_safe(list, it, tmp)                          \
+    for (ILink *it = (list)->head.next, *tmp = it->next;           \
+         it != &(list)->head; it = tmp, tmp = it->next)
+
+/**
+ * @brief Link embedded in the caller struct
+ */
+typedef struct ilink {
+    struct ilink *prev; // Previous link (the sentinel for the first one)
+    struct ilink *next; // Next link (the sentinel for the last one)
+} ILink;
+
+/**
+ * @brief Intrusive list
+ */
+typedef struct
+{
+    ILink head;  // Sentinel: head.next is the first link, head.prev the last one
+    size_t size; // Number of linked elements
+} IList;
+
+/**
+ * @brief Initialize an empty list
+ * @param[in] list List pointer
+ */
+static inline void ilist_init(IList *list) {
+    list->head.prev = &list->head;
+    list->head.next = &list->head;
+    list->size = 0;
+}
+
+/**
+ * @brief Check if the list is empty
+ * @param[in] list List pointer
+ * @return 1 if empty, 0 otherwise
+ */
+static inline int ilist_is_empty(const IList *list) {
+    return list->head.next == &list->head;
+}
+
+/**
+ * @brief Insert link right after pos
+ * @param[in] list List pointer
+ * @param[in] pos Link already in the list, or &list->head to insert at the front
+ * @param[in] link Link to insert (must not be in a list)
+ */
+static inline void ilist_insert_after(IList *list, ILink *pos, ILink *link) {
+    link->prev = pos;
+    link->next = pos->next;
+    pos->next->prev = link;
+    pos->next = link;
+    list->size++;
+}
+
+/**
+ * @brief Insert link at the front
+ */
+static inline void ilist_push_front(IList *list, ILink *link) {
+    ilist_insert_after(list, &list->head, link);
+}
+
+/**
+ * @brief Insert link at the back
+ */
+static inline void ilist_push_back(IList *list, ILink *link) {
+    ilist_insert_after(list, list->head.prev, link);
+}
+
+/**
+ * @brief Unlink a link from the list
+ *
+ * O(1), the enclosing struct is not touched otherwise
+ *
+ * @param[in] list List pointer
+ * @param[in] link Link currently in the list
+ */
+static inline void ilist_remove(IList *list, ILink *link) {
+    link->prev->next = link->next;
+    link->next->prev = link->prev;
+    link->prev = NULL;
+    link->next = NULL;
+    list->size--;
+}
+
+/**
+ * @brief First link or NULL if empty
+ */
+static inline ILink *ilist_first(const IList *list) {
+    return ilist_is_empty(list) ? NULL : list->head.next;
+}
+
+/**
+ * @brief Last link or NULL if empty
+ */
+static inline ILink *ilist_last(const IList *list) {
+    return ilist_is_empty(list) ? NULL : list->head.prev;
+}
+
+/**
+ * @brief Next link or NULL at the end of the list
+ */
+static inline ILink *ilist_next(const IList *list, const ILink *link) {
+    return link->next == &list->head ? NULL : link->next;
+}
+
+/**
+ * @brief Previous link or NULL at the beginning of the list
+ */
+static inline ILink *ilist_prev(const IList *list, const ILink *link) {
+    return link->prev == &list->head ? NULL : link->prev;
+}
+
+/**
+ * @brief Unlink and return the first link, NULL if empty
+ */
+static inline ILink *ilist_pop_front(IList *list) {
+    ILink *link = ilist_first(list);
+    if (link != NULL)
+        ilist_remove(list, link);
+    return link;
+}
+
+/**
+ * @brief Unlink and return the last link, NULL if empty
+ */
+static inline ILink *ilist_pop_back(IList *list) {
+    ILink *link = ilist_last(list);
+    if (link != NULL)
+        ilist_remove(list, link);
+    return link;
+}
+
+/**
+ * @brief Move a link already in the list to the front (e.g. LRU touch)
+ */
+static inline void ilist_move_front(IList *list, ILink *link) {
+    ilist_remove(list, link);
+    ilist_push_front(list, link);
+}
+
+#endif // ILIST_H
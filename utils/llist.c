@@ -31,7 +31,15 @@ static size_t ll_decrement_size(LList *list) {
  * @copydoc ll_create
  */
 LList *ll_create(void) {
-    LList *cur = malloc(sizeof(LList));
+    return ll_create_with(NULL);
+}
+
+/**
+ * @copydoc ll_create_with
+ */
+LList *ll_create_with(const Allocator *allocator) {
+    allocator = allocator_or_default(allocator);
+    LList *cur = allocator_alloc(allocator, sizeof(LList));
     if (cur == NULL) {
         perror("[ll_create] Cannot create a new linked list");
         return NULL;
@@ -39,55 +47,118 @@ LList *ll_create(void) {
     cur->head = NULL;
     cur->tail = NULL;
     cur->size = 0;
+    cur->allocator = *allocator;
+    cur->node_allocator = *allocator;
+    cur->pool = NULL;
+    cur->owns_pool = 0;
     return cur;
 }
 
 /**
- * @copydoc ll_destroy
+ * @copydoc ll_create_pooled
  */
-void ll_destroy(LList *list) {
-    if (list == NULL)
-        return;
+LList *ll_create_pooled(size_t slab_len) {
+    Pool *pool = pool_create(sizeof(LLNode), slab_len);
+    if (pool == NULL)
+        return NULL;
 
-    LLNode *cur = list->head;
-    while (cur != NULL) {
-        LLNode *next = cur->next;
-        free(cur);
-        cur = next;
+    LList *list = ll_create_with_pool(pool);
+    if (list == NULL) {
+        pool_destroy(pool);
+        return NULL;
     }
-    free(list);
+    list->owns_pool = 1;
+    return list;
 }
 
 /**
- * @copydoc ll_destroy_deep
+ * @copydoc ll_create_with_pool
  */
-void ll_destroy_deep(LList *list) {
+LList *ll_create_with_pool(Pool *pool) {
+    if (pool == NULL || pool->elem_size < sizeof(LLNode)) {
+        fprintf(stderr, "[ll_create_with_pool] Invalid pool\n");
+        return NULL;
+    }
+
+    LList *list = ll_create();
     if (list == NULL)
-        return;
+        return NULL;
+    list->pool = pool;
+    list->node_allocator = pool_allocator(pool);
+    return list;
+}
 
+/**
+ * @brief Release a node
+ *
+ * Internal helper that gives the node back to the node allocator
+ * (the list pool when the list is pooled).
+ *
+ * @param[in] list A valid (non-NULL) LList pointer
+ * @param[in] node Node to release
+ */
+static void ll_free_node(LList *list, LLNode *node) {
+    allocator_free(&list->node_allocator, node, sizeof(LLNode));
+}
+
+/**
+ * @brief Release all nodes and the list structure
+ *
+ * Internal destroy implementation. An owned pool is released in bulk,
+ * otherwise every node is released one by one.
+ *
+ * @param[in] list A valid (non-NULL) LList pointer
+ * @param[in] deep If 1, free element data; if 0, keep element data
+ */
+static void ll_destroy_internal(LList *list, int deep) {
     LLNode *cur = list->head;
     while (cur != NULL) {
         LLNode *next = cur->next;
 
         // Free the element data if it exists
-        if (cur->elem != NULL)
+        if (deep && cur->elem != NULL)
             free(cur->elem);
 
-        // Free the node itself
-        free(cur);
+        // Free the node itself, unless the whole pool goes away below
+        if (!list->owns_pool)
+            ll_free_node(list, cur);
         cur = next;
     }
 
+    if (list->owns_pool)
+        pool_destroy(list->pool);
+
     // Free the list structure
-    free(list);
+    Allocator allocator = list->allocator;
+    allocator_free(&allocator, list, sizeof(LList));
+}
+
+/**
+ * @copydoc ll_destroy
+ */
+void ll_destroy(LList *list) {
+    if (list == NULL)
+        return;
+    ll_destroy_internal(list, 0);
+}
+
+/**
+ * @copydoc ll_destroy_deep
+ */
+void ll_destroy_deep(LList *list) {
+    if (list == NULL)
+        return;
+    ll_destroy_internal(list, 1);
 }
 
 /**
  * @brief Create a new linked list node
  *
  * Internal helper to allocate and initialize a new node with the given data.
- * Links the node to its neighbors in the list.
+ * Links the node to its neighbors in the list. The node comes from the list
+ * pool when the list is pooled.
  *
+ * @param[in] list A valid (non-NULL) LList pointer
  * @param[in] prev Pointer to previous node (NULL if first node)
  * @param[in] elem Pointer to element data
  * @param[in] elem_size Number of elements (1 for single value, >1 for array)
@@ -96,8 +167,8 @@ void ll_destroy_deep(LList *list) {
  *
  * @return Pointer to newly allocated LLNode, or NULL on allocation failure
  */
-static LLNode *ll_create_node(LLNode *prev, void *elem, uint32_t elem_size, LLNodeType type, LLNode *next) {
-    LLNode *node = malloc(sizeof(LLNode));
+static LLNode *ll_create_node(LList *list, LLNode *prev, void *elem, uint32_t elem_size, LLNodeType type, LLNode *next) {
+    LLNode *node = allocator_alloc(&list->node_allocator, sizeof(LLNode));
     if (node == NULL) {
         perror("[ll_create_node] Cannot create a new node");
         return NULL;
@@ -152,7 +223,7 @@ static int ll_remove_internal(LList *list, size_t idx, int deep) {
         free(node->elem);
 
     // Free the node and decrement size
-    free(node);
+    ll_free_node(list, node);
     ll_decrement_size(list);
 
     return 1;
@@ -196,7 +267,7 @@ LLNode *ll_add(LList *list, void *elem, uint32_t elem_size, LLNodeType type, siz
     if (idx == 0) {
         if (list->head == NULL) {
             // List is empty - create first node
-            LLNode *node = ll_create_node(NULL, elem, elem_size, type, NULL);
+            LLNode *node = ll_create_node(list, NULL, elem, elem_size, type, NULL);
             if (node == NULL)
                 return NULL;
             list->head = node;
@@ -206,7 +277,7 @@ LLNode *ll_add(LList *list, void *elem, uint32_t elem_size, LLNodeType type, siz
         }
 
         // List not empty - prepend to head
-        LLNode *node = ll_create_node(NULL, elem, elem_size, type, list->head);
+        LLNode *node = ll_create_node(list, NULL, elem, elem_size, type, list->head);
         if (node == NULL)
             return NULL;
         list->head->prev = node;
@@ -217,7 +288,7 @@ LLNode *ll_add(LList *list, void *elem, uint32_t elem_size, LLNodeType type, siz
 
     // Insert at tail (idx == size)
     if (idx == list->size) {
-        LLNode *node = ll_create_node(list->tail, elem, elem_size, type, NULL);
+        LLNode *node = ll_create_node(list, list->tail, elem, elem_size, type, NULL);
         if (node == NULL)
             return NULL;
         list->tail->next = node;
@@ -233,7 +304,7 @@ LLNode *ll_add(LList *list, void *elem, uint32_t elem_size, LLNodeType type, siz
         return NULL;
     }
 
-    LLNode *node = ll_create_node(cur->prev, elem, elem_size, type, cur);
+    LLNode *node = ll_create_node(list, cur->prev, elem, elem_size, type, cur);
     if (node == NULL)
         return NULL;
 
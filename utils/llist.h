@@ -11,6 +11,9 @@
  * - Type-tagged: Each node tracks its element type
  * - Array support: Nodes can point to single values or arrays
  * - Optimized access: Uses closest end (head/tail) for retrieval
+ * - Optional node pool: Nodes can be carved from a slab pool (see pool.h)
+ * - Pluggable allocator: list and nodes can come from any Allocator (see allocator.h)
+ *   instead of one malloc per node
  *
  * Memory Ownership Models:
  * 1. Non-owning mode: Element data managed externally (stack, static, or external heap)
@@ -26,6 +29,7 @@
 #ifndef LLIST_H
 #define LLIST_H
 
+#include "pool.h"
 #include <stddef.h>
 #include <stdint.h>
 
@@ -64,9 +68,13 @@ typedef struct llnode {
  */
 typedef struct
 {
-    LLNode *head; // Pointer to first node (NULL if empty)
-    LLNode *tail; // Pointer to last node (NULL if empty)
-    size_t size;  // Current number of nodes in the list
+    LLNode *head;             // Pointer to first node (NULL if empty)
+    LLNode *tail;             // Pointer to last node (NULL if empty)
+    size_t size;              // Current number of nodes in the list
+    Allocator allocator;      // Allocator of the list structure
+    Allocator node_allocator; // Allocator of the nodes (the pool one when pooled)
+    Pool *pool;               // Node pool (NULL: nodes come from allocator)
+    int owns_pool;            // 1 if the pool is released together with the list
 } LList;
 
 /**
@@ -89,6 +97,75 @@ typedef struct
  */
 LList *ll_create(void);
 
+/**
+ * @brief Create an empty linked list using a custom allocator
+ *
+ * Same as ll_create() but the list structure and the nodes are allocated
+ * with allocator (see allocator.h). Element data released by the *_deep
+ * functions is still freed with free().
+ *
+ * @param[in] allocator Allocator to use, NULL means libc
+ *
+ * @return Pointer to the newly created LList, or NULL if allocation fails
+ *
+ * Example:
+ * @code
+ * BumpArena *arena = bumparena_create(4096);
+ * Allocator allocator = bumparena_allocator(arena);
+ * LList *list = ll_create_with(&allocator);
+ * // ... use list ...
+ * bumparena_destroy(arena); // releases the list and its nodes
+ * @endcode
+ */
+LList *ll_create_with(const Allocator *allocator);
+
+/**
+ * @brief Create an empty linked list backed by its own node pool
+ *
+ * Nodes are carved from slabs of slab_len contiguous nodes and recycled
+ * through the pool free list on removal. ll_destroy() and ll_destroy_deep()
+ * release all slabs at once instead of freeing node by node.
+ *
+ * Use this for queue-style workloads with many add/remove cycles.
+ *
+ * @param[in] slab_len Nodes per slab, 0 for POOL_DEFAULT_SLAB_LEN
+ *
+ * @return Pointer to newly created LList, or NULL if allocation fails
+ *
+ * Example:
+ * @code
+ * LList *queue = ll_create_pooled(1024);
+ * ll_append(queue, job, 1, LL_TYPE_STR);
+ * ll_remove(queue, 0);  // node goes back to the pool
+ * ll_destroy(queue);    // releases every slab
+ * @endcode
+ */
+LList *ll_create_pooled(size_t slab_len);
+
+/**
+ * @brief Create an empty linked list using a shared node pool
+ *
+ * Several lists can draw nodes from the same pool. The pool is not owned by
+ * the list: ll_destroy() gives the nodes back to the pool and the caller
+ * releases the pool with pool_destroy() after every list using it.
+ *
+ * @param[in] pool Pool created with an element size of at least sizeof(LLNode)
+ *
+ * @return Pointer to newly created LList, or NULL on error
+ *
+ * Example:
+ * @code
+ * Pool *pool = pool_create(sizeof(LLNode), 0);
+ * LList *a = ll_create_with_pool(pool);
+ * LList *b = ll_create_with_pool(pool);
+ * // ...
+ * ll_destroy(a);
+ * ll_destroy(b);
+ * pool_destroy(pool);
+ * @endcode
+ */
+LList *ll_create_with_pool(Pool *pool);
+
 /**
  * @brief Destroy the linked list structure without freeing element data
  *
@@ -0,0 +1,412 @@
+#include "mbsched.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef MB_HAS_X86
+#include <cpuid.h>
+#endif
+
+#define MB_IDLE SIZE_MAX // job of a lane without a message
+
+#ifdef MB_HAS_X86
+/**
+ * @brief CPUID + XGETBV check: the CPU has the instructions and the OS saves the registers
+ */
+static bool mb_cpu_has(MbImpl impl) {
+    unsigned int eax, ebx, ecx, edx, xcr0_lo, xcr0_hi;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+        return false;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    (void)xcr0_hi;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+
+    switch (impl) {
+    case MB_IMPL_AVX2:
+        return (xcr0_lo & 0x06) == 0x06 && (ebx & bit_AVX2); // xmm, ymm
+    case MB_IMPL_AVX512:
+        return (xcr0_lo & 0xE6) == 0xE6 && (ebx & bit_AVX512F); // + opmask, zmm
+    default:
+        return false;
+    }
+}
+#else
+static bool mb_cpu_has(MbImpl impl) {
+    (void)impl;
+    return false;
+}
+#endif
+
+/** @copydoc mb_select_impl */
+bool mb_select_impl(MbImpl impl, bool serial_shani, MbImpl *selected) {
+    if (impl == MB_IMPL_AUTO) {
+        if (mb_cpu_has(MB_IMPL_AVX512))
+            impl = MB_IMPL_AVX512;
+        else if (serial_shani)
+            impl = MB_IMPL_SERIAL;
+        else if (mb_cpu_has(MB_IMPL_AVX2))
+            impl = MB_IMPL_AVX2;
+        else
+            impl = MB_IMPL_VEC4;
+    }
+
+    switch (impl) {
+    case MB_IMPL_SERIAL:
+    case MB_IMPL_VEC4:
+        break;
+    case MB_IMPL_AVX2:
+    case MB_IMPL_AVX512:
+        if (!mb_cpu_has(impl))
+            return false;
+        break;
+    default:
+        return false;
+    }
+    *selected = impl;
+    return true;
+}
+
+/** @copydoc mb_impl_lanes */
+size_t mb_impl_lanes(MbImpl impl) {
+    switch (impl) {
+    case MB_IMPL_VEC4:
+        return 4;
+    case MB_IMPL_AVX2:
+        return 8;
+    case MB_IMPL_AVX512:
+        return 16;
+    default:
+        return 1;
+    }
+}
+
+/** @copydoc mb_impl_name */
+const char *mb_impl_name(MbImpl impl) {
+    switch (impl) {
+    case MB_IMPL_AUTO:
+        return "auto";
+    case MB_IMPL_SERIAL:
+        return "serial";
+    case MB_IMPL_VEC4:
+        return "vec4";
+    case MB_IMPL_AVX2:
+        return "avx2";
+    case MB_IMPL_AVX512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief One message in one lane
+ */
+typedef struct
+{
+    size_t job;          // message index, MB_IDLE when the lane is free
+    const uint8_t *data; // next full block to hash
+    size_t blocks;       // full blocks available at data
+    const uint8_t *rest; // bytes after the last full block
+    size_t rest_len;     // < 64
+    uint64_t total;      // message length in bytes
+    bool eof;            // the whole message is in data + rest
+    bool padded;         // the padding blocks are queued
+    int fd;              // file source, -1 when closed
+    uint8_t *buf;        // file source read buffer (MB_FILE_BUFF)
+    uint8_t tail[128];   // last partial block + padding
+} MbLane;
+
+/**
+ * @brief Lane scheduler over a memory or a file source
+ */
+typedef struct
+{
+    const MbEngine *engine;                      // hash and transform
+    size_t lanes;                                // lanes of the engine
+    MbLane lane[MB_MAX_LANES];                   // lanes
+    uint32_t state[MB_MAX_WORDS * MB_MAX_LANES]; // lane major state
+    size_t next;                                 // next message to schedule
+    size_t count;                                // number of messages
+    const size_t *jobs;                          // message indexes to schedule, NULL: 0 .. count - 1
+    const uint8_t *const *data;                  // memory source
+    const size_t *lens;                          // memory source
+    uint8_t *hashes;                             // memory source output
+    Fhash *fhs;                                  // file source (in/out)
+    bool *ok;                                    // file source output (can be NULL)
+} MbSched;
+
+/**
+ * @brief Assign message job to lane ll and reset its state
+ */
+static void mb_lane_start(MbSched *sched, size_t ll, size_t job) {
+    MbLane *lane = &sched->lane[ll];
+
+    for (size_t ww = 0; ww < sched->engine->words; ww++)
+        sched->state[ww * sched->lanes + ll] = sched->engine->init[ww];
+    lane->job = job;
+    lane->data = lane->rest = NULL;
+    lane->blocks = lane->rest_len = 0;
+    lane->total = 0;
+    lane->eof = lane->padded = false;
+}
+
+/**
+ * @brief Queue the last partial block, 0x80, zeros and the bit length
+ */
+static void mb_lane_pad(MbLane *lane) {
+    size_t padded_len = lane->rest_len < 56 ? 64 : 128;
+    uint64_t bits = lane->total * 8;
+
+    if (lane->rest_len > 0)
+        memcpy(lane->tail, lane->rest, lane->rest_len);
+    lane->tail[lane->rest_len] = 0x80;
+    memset(lane->tail + lane->rest_len + 1, 0, padded_len - lane->rest_len - 1 - 8);
+    for (size_t ii = 0; ii < 8; ii++)
+        lane->tail[padded_len - 1 - ii] = (uint8_t)(bits >> (8 * ii));
+
+    lane->data = lane->tail;
+    lane->blocks = padded_len / 64;
+    lane->padded = true;
+}
+
+/**
+ * @brief Provide the next full blocks of the lane message
+ *
+ * Memory: the whole message at once. File: open on the first call, then
+ * fill the lane buffer (the rest of the previous read first).
+ *
+ * @return false if the message cannot be hashed
+ */
+static bool mb_lane_feed(MbSched *sched, MbLane *lane) {
+    if (sched->fhs == NULL) {
+        size_t len = sched->lens[lane->job];
+        lane->data = sched->data[lane->job];
+        lane->blocks = len / 64;
+        lane->rest = len > 0 ? lane->data + lane->blocks * 64 : NULL;
+        lane->rest_len = len % 64;
+        lane->total = len;
+        lane->eof = true;
+        return true;
+    }
+
+    if (lane->fd < 0) {
+        // same checks and messages of fsha1
+        const char *filename = sched->fhs[lane->job].filename;
+        struct stat st;
+        if (filename == NULL || stat(filename, &st) != 0 || !S_ISREG(st.st_mode))
+            return false;
+        lane->fd = open(filename, O_RDONLY);
+        if (lane->fd < 0) {
+            printf("Cannot open file with name %s\n", filename);
+            return false;
+        }
+    }
+
+    size_t have = lane->rest_len;
+    if (have > 0)
+        memmove(lane->buf, lane->rest, have);
+    while (have < MB_FILE_BUFF) {
+        ssize_t bytes_read = read(lane->fd, lane->buf + have, MB_FILE_BUFF - have);
+        if (bytes_read < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        if (bytes_read == 0) {
+            lane->eof = true;
+            break;
+        }
+        have += (size_t)bytes_read;
+        lane->total += (uint64_t)bytes_read;
+    }
+
+    lane->data = lane->buf;
+    lane->blocks = have / 64;
+    lane->rest = lane->buf + lane->blocks * 64;
+    lane->rest_len = have % 64;
+    return true;
+}
+
+/**
+ * @brief Release the lane message and store its result
+ */
+static void mb_lane_finish(MbSched *sched, size_t ll, bool ok) {
+    MbLane *lane = &sched->lane[ll];
+    size_t hash_len = sched->engine->words * 4;
+    uint8_t *hash = sched->fhs == NULL ? sched->hashes + lane->job * hash_len : sched->fhs[lane->job].hash;
+
+    if (ok) {
+        for (size_t ii = 0; ii < hash_len; ii++) {
+            uint32_t word = sched->state[(ii >> 2) * sched->lanes + ll];
+            hash[ii] = (uint8_t)(word >> ((3 - (ii & 3)) * 8));
+        }
+    }
+    if (sched->ok != NULL)
+        sched->ok[lane->job] = ok;
+    if (lane->fd >= 0) {
+        close(lane->fd);
+        lane->fd = -1;
+    }
+    lane->job = MB_IDLE;
+}
+
+/**
+ * @brief Run all the messages through the lanes
+ *
+ * Every step hashes, on all lanes at once, as many blocks as the shortest
+ * lane has available. A lane whose message is over takes the next message
+ * immediately. Free lanes (at the end) hash the data of a busy lane, their
+ * result is ignored.
+ *
+ * @return number of messages hashed
+ */
+static size_t mb_run(MbSched *sched) {
+    size_t hashed = 0;
+
+    for (;;) {
+        const uint8_t *ptrs[MB_MAX_LANES];
+        const uint8_t *busy = NULL;
+        size_t step = SIZE_MAX;
+
+        for (size_t ll = 0; ll < sched->lanes; ll++) {
+            MbLane *lane = &sched->lane[ll];
+            while (lane->blocks == 0) {
+                if (lane->job == MB_IDLE) {
+                    if (sched->next == sched->count)
+                        break;
+                    size_t job = sched->jobs != NULL ? sched->jobs[sched->next] : sched->next;
+                    sched->next++;
+                    mb_lane_start(sched, ll, job);
+                } else if (lane->padded) {
+                    mb_lane_finish(sched, ll, true);
+                    hashed++;
+                } else if (lane->eof) {
+                    mb_lane_pad(lane);
+                } else if (!mb_lane_feed(sched, lane)) {
+                    mb_lane_finish(sched, ll, false);
+                }
+            }
+            if (lane->blocks > 0) {
+                busy = lane->data;
+                if (lane->blocks < step)
+                    step = lane->blocks;
+            }
+        }
+        if (busy == NULL)
+            break; // all the lanes are idle
+
+        for (size_t ll = 0; ll < sched->lanes; ll++)
+            ptrs[ll] = sched->lane[ll].blocks > 0 ? sched->lane[ll].data : busy;
+        sched->engine->transform(sched->state, ptrs, step);
+        for (size_t ll = 0; ll < sched->lanes; ll++) {
+            if (sched->lane[ll].blocks > 0) {
+                sched->lane[ll].data += step * 64;
+                sched->lane[ll].blocks -= step;
+            }
+        }
+    }
+    return hashed;
+}
+
+/**
+ * @brief Create a scheduler for engine
+ *
+ * @param[in] with_files allocate the lanes read buffers
+ * @return scheduler or NULL in case of error
+ */
+static MbSched *mb_sched_create(const MbEngine *engine, size_t count, bool with_files) {
+    MbSched *sched = calloc(1, sizeof(MbSched));
+    if (sched == NULL) {
+        fprintf(stderr, "[%s] Cannot allocate the scheduler: %s\n", engine->name, strerror(errno));
+        return NULL;
+    }
+    sched->engine = engine;
+    sched->lanes = engine->lanes;
+    sched->count = count;
+
+    uint8_t *bufs = NULL;
+    if (with_files) {
+        bufs = malloc(sched->lanes * MB_FILE_BUFF);
+        if (bufs == NULL) {
+            fprintf(stderr, "[%s] Cannot allocate the read buffers: %s\n", engine->name, strerror(errno));
+            free(sched);
+            return NULL;
+        }
+    }
+    for (size_t ll = 0; ll < sched->lanes; ll++) {
+        sched->lane[ll].job = MB_IDLE;
+        sched->lane[ll].fd = -1;
+        sched->lane[ll].buf = bufs == NULL ? NULL : bufs + ll * MB_FILE_BUFF;
+    }
+    return sched;
+}
+
+/**
+ * @brief Destroy a scheduler
+ */
+static void mb_sched_destroy(MbSched *sched) {
+    free(sched->lane[0].buf);
+    free(sched);
+}
+
+/** @copydoc mb_hash_memory */
+bool mb_hash_memory(const MbEngine *engine, const uint8_t *const data[], const size_t lens[], size_t count,
+                    uint8_t *hashes) {
+    MbSched *sched = mb_sched_create(engine, count, false);
+    if (sched == NULL)
+        return false;
+    sched->data = data;
+    sched->lens = lens;
+    sched->hashes = hashes;
+    mb_run(sched);
+    mb_sched_destroy(sched);
+    return true;
+}
+
+/** @copydoc mb_hash_files */
+size_t mb_hash_files(const MbEngine *engine, Fhash *fhs, size_t count, bool ok[]) {
+    if (count == 0)
+        return 0;
+    size_t *jobs = malloc(count * sizeof(size_t));
+    if (jobs == NULL) {
+        fprintf(stderr, "[%s] Cannot allocate the jobs: %s\n", engine->name, strerror(errno));
+        return 0;
+    }
+
+    // big files one at a time with the serial hash, the others in the lanes
+    size_t lane_jobs = 0;
+    size_t hashed = 0;
+    for (size_t ii = 0; ii < count; ii++) {
+        struct stat st;
+        if (engine->file_hash != NULL && fhs[ii].filename != NULL && stat(fhs[ii].filename, &st) == 0 &&
+            S_ISREG(st.st_mode) && (uint64_t)st.st_size >= MB_SERIAL_MIN) {
+            bool res = engine->file_hash(&fhs[ii]);
+            if (ok != NULL)
+                ok[ii] = res;
+            hashed += res;
+        } else {
+            jobs[lane_jobs++] = ii;
+        }
+    }
+
+    MbSched *sched = lane_jobs > 0 ? mb_sched_create(engine, lane_jobs, true) : NULL;
+    if (sched != NULL) {
+        sched->fhs = fhs;
+        sched->ok = ok;
+        sched->jobs = jobs;
+        hashed += mb_run(sched);
+        mb_sched_destroy(sched);
+    } else {
+        // no lane job, or no scheduler: the lane files are not hashed
+        for (size_t ii = 0; ii < lane_jobs && ok != NULL; ii++)
+            ok[jobs[ii]] = false;
+    }
+    free(jobs);
+    return hashed;
+}
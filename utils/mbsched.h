@@ -0,0 +1,128 @@
+/**
+ * @brief Multi-buffer lane scheduler
+ *
+ * SHA-1 and SHA-256 share the message layout (64-byte blocks, 0x80 padding,
+ * 64-bit big endian bit length) and the output (big endian state words):
+ * only the lanes transform, the number of state words and their initial
+ * value change. This runs many messages (memory or files) through the
+ * lanes of such a transform. A lane takes the next message as soon as its
+ * message is finished, so short and long messages can be mixed freely.
+ *
+ * A big file would keep one lane busy long after the others ran out of
+ * files, every step hashing copies of it in the idle lanes: files from
+ * MB_SERIAL_MIN bytes skip the lanes and go through the serial file hash
+ * of the engine (SHA-NI when available).
+ *
+ * The engine selection (CPUID detection, lanes, names) is shared too.
+ *
+ * Used by sha1mb.h and sha256mb.h, not meant to be used directly.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef MBSCHED_H
+#define MBSCHED_H
+
+#include "sha1.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define MB_MAX_LANES 16             // widest engine (AVX-512)
+#define MB_MAX_WORDS 8              // largest state (SHA-256)
+#define MB_FILE_BUFF (64 * 1024)    // read buffer per lane
+#define MB_SERIAL_MIN (1024 * 1024) // files from this size skip the lanes
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define MB_HAS_X86 1 // the AVX2 and AVX-512 lanes transforms can be built
+#endif
+
+/**
+ * Engines, the values of Sha1MbImpl and Sha256MbImpl
+ */
+typedef enum {
+    MB_IMPL_AUTO,   // fastest supported by the running CPU
+    MB_IMPL_SERIAL, // one message at a time (serial transform)
+    MB_IMPL_VEC4,   // 4 lanes, portable vector extensions (SSE2/NEON)
+    MB_IMPL_AVX2,   // 8 lanes
+    MB_IMPL_AVX512  // 16 lanes
+} MbImpl;
+
+/**
+ * @brief Lanes transform: fold blocks * 64 bytes of data[lane] into every lane
+ *
+ * state is lane major: state[word * lanes + lane]
+ */
+typedef void (*MbTransformFn)(uint32_t *state, const uint8_t *const data[], size_t blocks);
+
+/**
+ * @brief Serial hash of one file, e.g. fhsha1
+ */
+typedef bool (*MbFileHashFn)(Fhash *fh);
+
+/**
+ * @brief A hash as seen by the scheduler
+ */
+typedef struct
+{
+    const char *name;        // prefix of the error messages, e.g. "sha1_mb"
+    MbTransformFn transform; // lanes transform
+    size_t lanes;            // lanes of the transform (<= MB_MAX_LANES)
+    size_t words;            // state words (<= MB_MAX_WORDS), the hash is words * 4 bytes
+    const uint32_t *init;    // initial state, words values
+    MbFileHashFn file_hash;  // files from MB_SERIAL_MIN bytes, NULL: every file in the lanes
+} MbEngine;
+
+/**
+ * @brief Resolve an engine and check that it can run here
+ *
+ * MB_IMPL_AUTO picks AVX-512, else the serial transform when it uses the
+ * SHA extensions (faster than 8 lanes), else AVX2, else VEC4. AVX2 and
+ * AVX-512 need CPUID and XGETBV to agree: the CPU has the instructions and
+ * the OS saves the registers.
+ *
+ * @param[in] impl requested engine
+ * @param[in] serial_shani the serial transform uses the SHA extensions
+ * @param[out] selected engine to use, never MB_IMPL_AUTO
+ * @returns false if impl is not supported by this CPU or build
+ */
+bool mb_select_impl(MbImpl impl, bool serial_shani, MbImpl *selected);
+
+/**
+ * @brief Lanes of an engine (1 for MB_IMPL_SERIAL)
+ */
+size_t mb_impl_lanes(MbImpl impl);
+
+/**
+ * @brief Engine name, e.g. "avx2"
+ */
+const char *mb_impl_name(MbImpl impl);
+
+/**
+ * @brief Hash count in-memory messages
+ *
+ * @param[in] engine hash and transform
+ * @param[in] data messages, data[ii] can be NULL only if lens[ii] is 0
+ * @param[in] lens message lengths in bytes
+ * @param[in] count number of messages
+ * @param[out] hashes count hashes of engine->words * 4 bytes, one after the other
+ * @returns true if the hashes are calculated else false
+ */
+bool mb_hash_memory(const MbEngine *engine, const uint8_t *const data[], const size_t lens[], size_t count,
+                    uint8_t *hashes);
+
+/**
+ * @brief Hash many files
+ *
+ * Files that cannot be hashed (not regular, cannot be opened or read) keep
+ * their hash untouched. Files from MB_SERIAL_MIN bytes are hashed one at a
+ * time with engine->file_hash.
+ *
+ * @param[in] engine hash and transform
+ * @param[in,out] fhs files, hash is written for every hashed file
+ * @param[in] count number of files
+ * @param[out] ok per file result (can be NULL)
+ * @returns number of files hashed
+ */
+size_t mb_hash_files(const MbEngine *engine, Fhash *fhs, size_t count, bool ok[]);
+
+#endif // MBSCHED_H
@@ -0,0 +1,51 @@
+#include "mpscq.h"
+
+/** @copydoc mpscq_init */
+void mpscq_init(MpscQueue *queue) {
+    atomic_init(&queue->stub.next, NULL);
+    atomic_init(&queue->head, &queue->stub);
+    queue->tail = &queue->stub;
+}
+
+/** @copydoc mpscq_push */
+void mpscq_push(MpscQueue *queue, MpscNode *node) {
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+    // serialization point between producers
+    MpscNode *prev = atomic_exchange_explicit(&queue->head, node, memory_order_acq_rel);
+    // link the previous node: from now on the consumer can reach node
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+/** @copydoc mpscq_pop */
+MpscNode *mpscq_pop(MpscQueue *queue) {
+    MpscNode *tail = queue->tail;
+    MpscNode *next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    // skip the stub
+    if (tail == &queue->stub) {
+        if (next == NULL)
+            return NULL; // empty
+        queue->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&next->next, memory_order_acquire);
+    }
+
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+
+    // tail is the last linked node: a producer may be in the middle of a push
+    MpscNode *head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    if (tail != head)
+        return NULL; // retry later
+
+    // tail is really the last one: push the stub behind it so tail can be detached
+    mpscq_push(queue, &queue->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if (next != NULL) {
+        queue->tail = next;
+        return tail;
+    }
+    return NULL;
+}
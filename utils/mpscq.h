@@ -0,0 +1,75 @@
+/**
+ * @brief Unbounded multi-producer single-consumer intrusive queue
+ *
+ * Dmitry Vyukov's non-intrusive-allocation MPSC queue: the caller embeds an
+ * MpscNode inside its own struct (see container_of in ilist.h) so pushing
+ * never allocates. Any number of threads can push, exactly one thread pops.
+ *
+ * - push is wait-free: one atomic exchange plus one release store
+ * - pop is lock-free for the consumer and never blocks producers
+ *
+ * While a producer is between its exchange and its store, the consumer can
+ * see the queue as momentarily empty (mpscq_pop returns NULL) even though an
+ * element is on its way; callers simply retry later.
+ *
+ * Producer side (head) and consumer side (tail) sit on different cache lines.
+ *
+ * Requires C11 atomics: compile with -std=c11 (or later).
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef MPSCQ_H
+#define MPSCQ_H
+
+#if !defined(__STDC_VERSION__) || __STDC_VERSION__ < 201112L
+#error "mpscq.h requires C11 atomics, compile with -std=c11"
+#endif
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * @brief Link embedded in the caller struct
+ */
+typedef struct mpscnode {
+    _Atomic(struct mpscnode *) next;
+} MpscNode;
+
+typedef struct
+{
+    _Alignas(CACHE_LINE_SIZE) _Atomic(MpscNode *) head; // last pushed node (producers)
+    _Alignas(CACHE_LINE_SIZE) MpscNode *tail;           // next node to pop (consumer)
+    MpscNode stub;                                      // placeholder keeping the list non empty
+} MpscQueue;
+
+/**
+ * @brief Initialize an empty queue
+ *
+ * The queue owns no memory, nothing to destroy.
+ * Allocate it with the CACHE_LINE_SIZE alignment (static, stack or aligned_alloc).
+ *
+ * @param[in] queue queue pointer
+ */
+void mpscq_init(MpscQueue *queue);
+
+/**
+ * @brief Push a node (any thread)
+ *
+ * @param[in] queue queue pointer
+ * @param[in] node node embedded in the element, must not be already queued
+ */
+void mpscq_push(MpscQueue *queue, MpscNode *node);
+
+/**
+ * @brief Pop a node (consumer thread only)
+ *
+ * @param[in] queue queue pointer
+ * @return the oldest node, or NULL if the queue is empty (or a push is in progress)
+ */
+MpscNode *mpscq_pop(MpscQueue *queue);
+
+#endif // MPSCQ_H
@@ -4,22 +4,29 @@
 
 /** @copydoc nal_create */
 NAList *nal_create(size_t capacity) {
-    if (capacity == 0) {
+    return nal_create_with(capacity, NULL);
+}
+
+/** @copydoc nal_create_with */
+NAList *nal_create_with(size_t capacity, const Allocator *allocator) {
+    if (capacity == 0 || capacity > SIZE_MAX / sizeof(size_t)) {
         fprintf(stderr, "[nal_create] Invalid capacity\n");
         return NULL;
     }
 
-    NAList *list = malloc(sizeof(NAList));
+    allocator = allocator_or_default(allocator);
+    NAList *list = allocator_alloc(allocator, sizeof(NAList));
     if (list == NULL) {
         perror("[nal_create] Cannot create a new array list");
         return NULL;
     }
+    list->allocator = *allocator;
     list->capacity = capacity;
     list->size = 0;
-    list->data = malloc(sizeof(size_t) * capacity);
+    list->data = allocator_alloc(allocator, sizeof(size_t) * capacity);
     if (list->data == NULL) {
         perror("[nal_create] Cannot create a new array list");
-        free(list);
+        allocator_free(allocator, list, sizeof(NAList));
         return NULL;
     }
     return list;
@@ -30,12 +37,13 @@ void nal_destroy(NAList *list) {
     if (list == NULL)
         return;
 
+    Allocator allocator = list->allocator; // the list itself is released last
     if (list->data != NULL)
-        free(list->data);
+        allocator_free(&allocator, list->data, sizeof(size_t) * list->capacity);
 
     list->capacity = 0;
     list->size = 0;
-    free(list);
+    allocator_free(&allocator, list, sizeof(NAList));
 }
 
 /**
@@ -49,7 +57,8 @@ void nal_destroy(NAList *list) {
 static size_t nal_grow(NAList *list) {
     // resize with double capacity
     size_t new_capacity = list->capacity * 2;
-    void *temp = realloc(list->data, sizeof(size_t) * new_capacity);
+    void *temp = allocator_realloc(&list->allocator, list->data, sizeof(size_t) * list->capacity,
+                                   sizeof(size_t) * new_capacity);
     if (!temp) {
         perror("[nal_grow] Reallocation failed! The old data are still valid");
         return 0;
@@ -76,7 +85,8 @@ static size_t nal_shrink(NAList *list) {
     if (new_capacity < 2)
         return list->capacity;
 
-    void *temp = realloc(list->data, sizeof(size_t) * new_capacity);
+    void *temp = allocator_realloc(&list->allocator, list->data, sizeof(size_t) * list->capacity,
+                                   sizeof(size_t) * new_capacity);
     if (!temp) {
         perror("[nal_shrink] Reallocation failed! The old data are still valid");
         return 0;
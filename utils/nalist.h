@@ -8,13 +8,15 @@
  */
 #ifndef NALIST_H
 #define NALIST_H
+#include "allocator.h"
 #include <stdlib.h>
 
 typedef struct
 {
-    size_t capacity; // max data length
-    size_t size;     // current data length
-    size_t *data;    // data array pointer which elements are size_t
+    size_t capacity;     // max data length
+    size_t size;         // current data length
+    size_t *data;        // data array pointer which elements are size_t
+    Allocator allocator; // allocator of the list structure and of the data array
 } NAList;
 
 /**
@@ -27,6 +29,18 @@ typedef struct
  */
 NAList *nal_create(size_t capacity);
 
+/**
+ * @brief Array list creation with a custom allocator
+ *
+ * Like nal_create but the list structure and the data array are allocated
+ * with allocator (see allocator.h).
+ *
+ * @param[in] capacity initial capacity
+ * @param[in] allocator allocator, NULL means libc
+ * @return Array list pointer
+ */
+NAList *nal_create_with(size_t capacity, const Allocator *allocator);
+
 /**
  * @brief Array list deallocation
  *
@@ -22,7 +22,13 @@ static size_t nll_decrement_size(NLList *list) {
 
 /** @copydoc nll_create */
 NLList *nll_create(void) {
-    NLList *cur = malloc(sizeof(NLList));
+    return nll_create_with(NULL);
+}
+
+/** @copydoc nll_create_with */
+NLList *nll_create_with(const Allocator *allocator) {
+    allocator = allocator_or_default(allocator);
+    NLList *cur = allocator_alloc(allocator, sizeof(NLList));
     if (cur == NULL) {
         fprintf(stderr, "[nll_create] Cannot create a new linked list");
         return NULL;
@@ -30,32 +36,84 @@ NLList *nll_create(void) {
     cur->head = NULL;
     cur->tail = NULL;
     cur->size = 0;
+    cur->allocator = *allocator;
+    cur->node_allocator = *allocator;
+    cur->pool = NULL;
+    cur->owns_pool = 0;
     return cur;
 }
 
+/** @copydoc nll_create_pooled */
+NLList *nll_create_pooled(size_t slab_len) {
+    Pool *pool = pool_create(sizeof(NLLNode), slab_len);
+    if (pool == NULL)
+        return NULL;
+
+    NLList *list = nll_create_with_pool(pool);
+    if (list == NULL) {
+        pool_destroy(pool);
+        return NULL;
+    }
+    list->owns_pool = 1;
+    return list;
+}
+
+/** @copydoc nll_create_with_pool */
+NLList *nll_create_with_pool(Pool *pool) {
+    if (pool == NULL || pool->elem_size < sizeof(NLLNode)) {
+        fprintf(stderr, "[nll_create_with_pool] Invalid pool\n");
+        return NULL;
+    }
+
+    NLList *list = nll_create();
+    if (list == NULL)
+        return NULL;
+    list->pool = pool;
+    list->node_allocator = pool_allocator(pool);
+    return list;
+}
+
+/**
+ * Release a node to the node allocator (the list pool when the list is pooled)
+ * @param[in] list A valid (non-NULL) NLList pointer
+ * @param[in] node Node to release
+ */
+static void nll_free_node(NLList *list, NLLNode *node) {
+    allocator_free(&list->node_allocator, node, sizeof(NLLNode));
+}
+
 /** @copydoc nll_destroy */
 void nll_destroy(NLList *list) {
     if (list == NULL)
         return;
 
+    Allocator allocator = list->allocator; // the list itself is released last
+    if (list->owns_pool) {
+        // bulk release: no need to walk the nodes
+        pool_destroy(list->pool);
+        allocator_free(&allocator, list, sizeof(NLList));
+        return;
+    }
+
     NLLNode *cur = list->head;
     while (cur != NULL) {
         NLLNode *next = cur->next;
-        free(cur);
+        nll_free_node(list, cur);
         cur = next;
     }
-    free(list);
+    allocator_free(&allocator, list, sizeof(NLList));
 }
 
 /**
  * Create a new numeric linked list node
+ * @param[in] list A valid (non-NULL) NLList pointer, the node comes from its pool if any
  * @param[in] prev Pointer to previous node (NULL if first node)
  * @param[in] elem Numeric value to store
  * @param[in] next Pointer to next node (NULL if last node)
  * @returns Pointer to newly allocated NLLNode, or NULL on allocation failure
  */
-static NLLNode *nll_create_node(NLLNode *prev, size_t elem, NLLNode *next) {
-    NLLNode *node = malloc(sizeof(NLLNode));
+static NLLNode *nll_create_node(NLList *list, NLLNode *prev, size_t elem, NLLNode *next) {
+    NLLNode *node = allocator_alloc(&list->node_allocator, sizeof(NLLNode));
     if (node == NULL) {
         perror("[nll_create_node] Cannot create a new node");
         return NULL;
@@ -73,7 +131,7 @@ static NLLNode *nll_create_node(NLLNode *prev, size_t elem, NLLNode *next) {
  * @returns The new list size after removal
  */
 static size_t nll_remove_node(NLList *list, NLLNode *node) {
-    free(node);
+    nll_free_node(list, node);
     return nll_decrement_size(list);
 }
 
@@ -111,7 +169,7 @@ NLLNode *nll_add(NLList *list, size_t elem, size_t idx) {
     if (idx == 0) {
         if (list->head == NULL) {
             // List is empty - create first node
-            NLLNode *node = nll_create_node(NULL, elem, NULL);
+            NLLNode *node = nll_create_node(list, NULL, elem, NULL);
             if (node == NULL)
                 return NULL;
             list->head = node;
@@ -121,7 +179,7 @@ NLLNode *nll_add(NLList *list, size_t elem, size_t idx) {
         }
 
         // List not empty - prepend to head
-        NLLNode *node = nll_create_node(NULL, elem, list->head);
+        NLLNode *node = nll_create_node(list, NULL, elem, list->head);
         if (node == NULL)
             return NULL;
         list->head->prev = node;
@@ -132,7 +190,7 @@ NLLNode *nll_add(NLList *list, size_t elem, size_t idx) {
 
     // Case 2: Insert at tail (idx == size)
     if (idx == list->size) {
-        NLLNode *node = nll_create_node(list->tail, elem, NULL);
+        NLLNode *node = nll_create_node(list, list->tail, elem, NULL);
         if (node == NULL)
             return NULL;
         list->tail->next = node;
@@ -148,7 +206,7 @@ NLLNode *nll_add(NLList *list, size_t elem, size_t idx) {
         return NULL;
     }
 
-    NLLNode *node = nll_create_node(cur->prev, elem, cur);
+    NLLNode *node = nll_create_node(list, cur->prev, elem, cur);
     if (node == NULL)
         return NULL;
 
@@ -3,12 +3,15 @@
  *
  * Numeric doubly linked list implementation
  * Stores size_t values directly in nodes (not pointers)
+ * Nodes can optionally be carved from a slab pool (see pool.h)
+ * or from any allocator (see allocator.h)
  *
  * @author Alberto Ielpo <alberto.ielpo@gmail.com>
  */
 #ifndef NLLIST_H
 #define NLLIST_H
 
+#include "pool.h"
 #include <stddef.h>
 
 /**
@@ -25,9 +28,13 @@ typedef struct nllnode {
  */
 typedef struct
 {
-    NLLNode *head; // Pointer to first node
-    NLLNode *tail; // Pointer to last node
-    size_t size;   // Number of elements in the list
+    NLLNode *head;            // Pointer to first node
+    NLLNode *tail;            // Pointer to last node
+    size_t size;              // Number of elements in the list
+    Allocator allocator;      // Allocator of the list structure
+    Allocator node_allocator; // Allocator of the nodes (the pool one when pooled)
+    Pool *pool;               // Node pool (NULL: nodes come from allocator)
+    int owns_pool;            // 1 if the pool is released together with the list
 } NLList;
 
 /**
@@ -36,6 +43,32 @@ typedef struct
  */
 NLList *nll_create(void);
 
+/**
+ * Create and initialize a new numeric linked list using a custom allocator
+ * The list structure and the nodes are allocated with allocator (see allocator.h)
+ * @param[in] allocator Allocator to use, NULL means libc
+ * @returns Pointer to new NLList, or NULL on allocation failure
+ */
+NLList *nll_create_with(const Allocator *allocator);
+
+/**
+ * Create a new numeric linked list backed by its own node pool
+ * Nodes are carved from slabs and recycled on removal, nll_destroy
+ * releases all slabs at once
+ * @param[in] slab_len Nodes per slab, 0 for POOL_DEFAULT_SLAB_LEN
+ * @returns Pointer to new NLList, or NULL on allocation failure
+ */
+NLList *nll_create_pooled(size_t slab_len);
+
+/**
+ * Create a new numeric linked list using a shared node pool
+ * The pool is not owned: nll_destroy gives the nodes back to the pool
+ * and the caller releases it with pool_destroy
+ * @param[in] pool Pool created with an element size of at least sizeof(NLLNode)
+ * @returns Pointer to new NLList, or NULL on error
+ */
+NLList *nll_create_with_pool(Pool *pool);
+
 /**
  * Deallocate linked list and all nodes
  * @param[in] list Pointer to the list to destroy (can be NULL)
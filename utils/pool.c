@@ -0,0 +1,356 @@
+#include "pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef POOL_DEBUG
+/**
+ * @brief Does ptr point to the start of a block handed out by the pool?
+ */
+static int pool_owns(const Pool *pool, const void *ptr) {
+    for (const PoolSlab *slab = pool->slabs; slab != NULL; slab = slab->next) {
+        const uint8_t *first = (const uint8_t *)slab + sizeof(PoolSlab);
+        const uint8_t *end = slab == pool->slabs ? pool->cursor : first + pool->elem_size * slab->len;
+        if ((const uint8_t *)ptr >= first && (const uint8_t *)ptr < end)
+            return ((size_t)((const uint8_t *)ptr - first) % pool->elem_size) == 0;
+    }
+    return 0;
+}
+
+/**
+ * @brief Is ptr already in the free list?
+ */
+static int pool_is_free(const Pool *pool, const void *ptr) {
+    for (void *it = pool->free_list; it != NULL; it = *(void **)it) {
+        if (it == ptr)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Check that a free block was not written after pool_free
+ *
+ * The first pointer of the block is the free list link, the rest must still
+ * hold POOL_POISON_FREE.
+ */
+static void pool_check_poison(const Pool *pool, const void *block) {
+    const uint8_t *bytes = (const uint8_t *)block;
+    for (size_t ii = sizeof(void *); ii < pool->elem_size; ii++) {
+        if (bytes[ii] != POOL_POISON_FREE) {
+            fprintf(stderr, "[pool_alloc] block %p modified after free (offset %zu)\n", block, ii);
+            return;
+        }
+    }
+}
+#endif
+
+/** @copydoc pool_create */
+Pool *pool_create(size_t elem_size, size_t slab_len) {
+    if (elem_size == 0) {
+        fprintf(stderr, "[pool_create] Invalid element size\n");
+        return NULL;
+    }
+
+    Pool *pool = malloc(sizeof(Pool));
+    if (pool == NULL) {
+        perror("[pool_create] Cannot create a new pool");
+        return NULL;
+    }
+    if (pthread_mutex_init(&pool->lock, NULL) != 0) {
+        fprintf(stderr, "[pool_create] Cannot init the mutex\n");
+        free(pool);
+        return NULL;
+    }
+
+    // a free block must be able to hold the free list pointer
+    if (elem_size < sizeof(void *))
+        elem_size = sizeof(void *);
+    // round up to pointer alignment so that every block is aligned
+    elem_size = (elem_size + sizeof(void *) - 1) & ~(sizeof(void *) - 1);
+
+    pool->elem_size = elem_size;
+    pool->slab_len = slab_len == 0 ? POOL_DEFAULT_SLAB_LEN : slab_len;
+    pool->capacity = 0;
+    pool->used = 0;
+    pool->slabs = NULL;
+    pool->free_list = NULL;
+    pool->cursor = NULL;
+    pool->end = NULL;
+    return pool;
+}
+
+/** @copydoc pool_destroy */
+void pool_destroy(Pool *pool) {
+    if (pool == NULL)
+        return;
+
+    PoolSlab *cur = pool->slabs;
+    while (cur != NULL) {
+        PoolSlab *next = cur->next;
+        free(cur);
+        cur = next;
+    }
+    pthread_mutex_destroy(&pool->lock);
+    free(pool);
+}
+
+/**
+ * @brief Allocate a new slab
+ *
+ * The new slab becomes the current one, its blocks are carved lazily by pool_alloc
+ *
+ * @param[in] pool Pool pointer
+ * @return 1 if OK, 0 in case of error
+ */
+static int pool_grow(Pool *pool) {
+    PoolSlab *slab = malloc(sizeof(PoolSlab) + pool->elem_size * pool->slab_len);
+    if (slab == NULL) {
+        perror("[pool_grow] Cannot allocate a new slab");
+        return 0;
+    }
+    slab->len = pool->slab_len;
+    slab->next = pool->slabs;
+    pool->slabs = slab;
+    pool->capacity += slab->len;
+
+    // blocks start right after the header
+    pool->cursor = (uint8_t *)slab + sizeof(PoolSlab);
+    pool->end = pool->cursor + pool->elem_size * slab->len;
+    return 1;
+}
+
+/** @copydoc pool_alloc */
+void *pool_alloc(Pool *pool) {
+    if (pool == NULL)
+        return NULL;
+
+    void *block;
+    if (pool->free_list != NULL) {
+        // reuse a freed block first
+        block = pool->free_list;
+        pool->free_list = *(void **)block;
+#ifdef POOL_DEBUG
+        pool_check_poison(pool, block);
+#endif
+    } else {
+        if (pool->cursor == pool->end && !pool_grow(pool))
+            return NULL;
+        block = pool->cursor;
+        pool->cursor += pool->elem_size;
+    }
+
+#ifdef POOL_DEBUG
+    memset(block, POOL_POISON_ALLOC, pool->elem_size);
+#endif
+    pool->used++;
+    return block;
+}
+
+/** @copydoc pool_free */
+void pool_free(Pool *pool, void *ptr) {
+    if (pool == NULL || ptr == NULL)
+        return;
+
+#ifdef POOL_DEBUG
+    if (!pool_owns(pool, ptr)) {
+        fprintf(stderr, "[pool_free] %p is not a block of this pool\n", ptr);
+        return;
+    }
+    if (pool_is_free(pool, ptr)) {
+        fprintf(stderr, "[pool_free] double free of %p\n", ptr);
+        return;
+    }
+    memset(ptr, POOL_POISON_FREE, pool->elem_size);
+#endif
+
+    // the block itself stores the next free pointer
+    *(void **)ptr = pool->free_list;
+    pool->free_list = ptr;
+    pool->used--;
+}
+
+/** @copydoc pool_cache_init */
+void pool_cache_init(PoolCache *cache, Pool *pool) {
+    cache->pool = pool;
+    cache->count = 0;
+}
+
+/** @copydoc pool_cache_alloc */
+void *pool_cache_alloc(PoolCache *cache) {
+    if (cache == NULL || cache->pool == NULL)
+        return NULL;
+
+    if (cache->count == 0) {
+        // refill half of the cache with a single lock
+        pthread_mutex_lock(&cache->pool->lock);
+        while (cache->count < POOL_CACHE_LEN / 2) {
+            void *block = pool_alloc(cache->pool);
+            if (block == NULL)
+                break;
+            cache->blocks[cache->count++] = block;
+        }
+        pthread_mutex_unlock(&cache->pool->lock);
+        if (cache->count == 0)
+            return NULL;
+    }
+    return cache->blocks[--cache->count];
+}
+
+/** @copydoc pool_cache_free */
+void pool_cache_free(PoolCache *cache, void *ptr) {
+    if (cache == NULL || ptr == NULL)
+        return;
+
+    if (cache->count == POOL_CACHE_LEN) {
+        // drain the older half with a single lock
+        pthread_mutex_lock(&cache->pool->lock);
+        for (size_t ii = 0; ii < POOL_CACHE_LEN / 2; ii++)
+            pool_free(cache->pool, cache->blocks[ii]);
+        pthread_mutex_unlock(&cache->pool->lock);
+        memmove(cache->blocks, cache->blocks + POOL_CACHE_LEN / 2,
+                (POOL_CACHE_LEN - POOL_CACHE_LEN / 2) * sizeof(void *));
+        cache->count -= POOL_CACHE_LEN / 2;
+    }
+    cache->blocks[cache->count++] = ptr;
+}
+
+/** @copydoc pool_cache_flush */
+void pool_cache_flush(PoolCache *cache) {
+    if (cache == NULL || cache->count == 0)
+        return;
+
+    pthread_mutex_lock(&cache->pool->lock);
+    while (cache->count > 0)
+        pool_free(cache->pool, cache->blocks[--cache->count]);
+    pthread_mutex_unlock(&cache->pool->lock);
+}
+
+/**
+ * @brief Allocator alloc adapter
+ */
+static void *pool_allocator_alloc(void *ctx, size_t size) {
+    Pool *pool = ctx;
+    if (size > pool->elem_size) {
+        fprintf(stderr, "[pool_allocator] %zu bytes do not fit in a %zu bytes block\n", size, pool->elem_size);
+        return NULL;
+    }
+    return pool_alloc(pool);
+}
+
+/**
+ * @brief Allocator realloc adapter: blocks cannot grow past elem_size
+ */
+static void *pool_allocator_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+    Pool *pool = ctx;
+    (void)old_size;
+    if (ptr == NULL)
+        return pool_allocator_alloc(ctx, new_size);
+    if (new_size > pool->elem_size) {
+        fprintf(stderr, "[pool_allocator] %zu bytes do not fit in a %zu bytes block\n", new_size, pool->elem_size);
+        return NULL;
+    }
+    return ptr;
+}
+
+/**
+ * @brief Allocator free adapter
+ */
+static void pool_allocator_free(void *ctx, void *ptr, size_t size) {
+    (void)size;
+    pool_free(ctx, ptr);
+}
+
+/** @copydoc pool_allocator */
+Allocator pool_allocator(Pool *pool) {
+    Allocator allocator = {pool_allocator_alloc, pool_allocator_realloc, pool_allocator_free, pool};
+    return allocator;
+}
+
+/** @copydoc poolset_create */
+PoolSet *poolset_create(size_t slab_len) {
+    PoolSet *set = calloc(1, sizeof(PoolSet));
+    if (set == NULL) {
+        perror("[poolset_create] Cannot create a new pool set");
+        return NULL;
+    }
+    for (size_t ii = 0; ii < POOLSET_CLASSES; ii++) {
+        set->classes[ii] = pool_create(POOLSET_MIN_SIZE << ii, slab_len);
+        if (set->classes[ii] == NULL) {
+            poolset_destroy(set);
+            return NULL;
+        }
+    }
+    return set;
+}
+
+/** @copydoc poolset_destroy */
+void poolset_destroy(PoolSet *set) {
+    if (set == NULL)
+        return;
+    for (size_t ii = 0; ii < POOLSET_CLASSES; ii++)
+        pool_destroy(set->classes[ii]);
+    free(set);
+}
+
+/**
+ * @brief Size class of a block
+ *
+ * @param[in] size block size in bytes
+ * @return class index, POOLSET_CLASSES if the block is too big for the set
+ */
+static size_t poolset_class(size_t size) {
+    size_t idx = 0;
+    while (idx < POOLSET_CLASSES && (POOLSET_MIN_SIZE << idx) < size)
+        idx++;
+    return idx;
+}
+
+/**
+ * @brief Allocator alloc adapter
+ */
+static void *poolset_allocator_alloc(void *ctx, size_t size) {
+    PoolSet *set = ctx;
+    size_t idx = poolset_class(size);
+    return idx < POOLSET_CLASSES ? pool_alloc(set->classes[idx]) : malloc(size);
+}
+
+/**
+ * @brief Allocator free adapter
+ */
+static void poolset_allocator_free(void *ctx, void *ptr, size_t size) {
+    PoolSet *set = ctx;
+    if (ptr == NULL)
+        return;
+    size_t idx = poolset_class(size);
+    if (idx < POOLSET_CLASSES)
+        pool_free(set->classes[idx], ptr);
+    else
+        free(ptr);
+}
+
+/**
+ * @brief Allocator realloc adapter
+ */
+static void *poolset_allocator_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size) {
+    if (ptr == NULL)
+        return poolset_allocator_alloc(ctx, new_size);
+
+    size_t old_idx = poolset_class(old_size);
+    size_t new_idx = poolset_class(new_size);
+    if (old_idx == new_idx)
+        return old_idx < POOLSET_CLASSES ? ptr : realloc(ptr, new_size);
+
+    void *res = poolset_allocator_alloc(ctx, new_size);
+    if (res == NULL)
+        return NULL;
+    memcpy(res, ptr, old_size < new_size ? old_size : new_size);
+    poolset_allocator_free(ctx, ptr, old_size);
+    return res;
+}
+
+/** @copydoc poolset_allocator */
+Allocator poolset_allocator(PoolSet *set) {
+    Allocator allocator = {poolset_allocator_alloc, poolset_allocator_realloc, poolset_allocator_free, set};
+    return allocator;
+}
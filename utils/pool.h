@@ -0,0 +1,223 @@
+/**
+ * @brief Fixed-size node pool (slab allocator)
+ *
+ * Pool hands out blocks of a single size carved from large contiguous slabs.
+ * Freed blocks go back to an intrusive free list (the free list pointer is
+ * stored inside the freed block itself) and are reused by the next allocation.
+ * Slabs are never returned to the system one by one: everything is released
+ * in bulk by pool_destroy().
+ *
+ * Compared to one malloc per node this gives:
+ * - O(1) alloc/free without touching the libc allocator in the steady state
+ * - nodes allocated one after another sit next to each other in memory
+ *
+ * pool_alloc/pool_free are not thread safe. A pool can be owned by a single
+ * container or shared by several containers that store nodes of the same size.
+ *
+ * Per-thread caches: to share a pool between threads every thread uses its
+ * own PoolCache (a small stack of free blocks). pool_cache_alloc and
+ * pool_cache_free work on the local stack with no lock; the pool mutex is
+ * taken only to refill or drain half of the stack at once. When threads share
+ * a pool, use only the pool_cache_* functions on it.
+ *
+ * Size classes: PoolSet groups one pool per power of two size class
+ * (POOLSET_MIN_SIZE .. POOLSET_MAX_SIZE bytes) to serve variable size blocks,
+ * bigger blocks go to libc. Use it through poolset_allocator.
+ *
+ * Debug: build with -DPOOL_DEBUG to poison blocks (POOL_POISON_ALLOC on
+ * alloc, POOL_POISON_FREE on free), detect double frees, frees of foreign
+ * pointers and writes to freed blocks (reported on stderr).
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef POOL_H
+#define POOL_H
+#include "allocator.h"
+#include <pthread.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define POOL_DEFAULT_SLAB_LEN 256 // default number of blocks per slab
+#define POOL_CACHE_LEN 64         // blocks kept by a per-thread PoolCache
+#define POOL_POISON_ALLOC 0xCD    // POOL_DEBUG: fresh block, not initialized by the caller
+#define POOL_POISON_FREE 0xDD     // POOL_DEBUG: freed block
+#define POOLSET_MIN_SHIFT 4       // smallest size class: 16 bytes
+#define POOLSET_CLASSES 8         // size classes: 16, 32, ..., 2048 bytes
+#define POOLSET_MIN_SIZE ((size_t)1 << POOLSET_MIN_SHIFT)
+#define POOLSET_MAX_SIZE ((size_t)1 << (POOLSET_MIN_SHIFT + POOLSET_CLASSES - 1))
+
+/**
+ * @brief Create a pool of T blocks
+ */
+#define POOL_CREATE(T, slab_len) pool_create(sizeof(T), (slab_len))
+
+/**
+ * @brief Allocate one uninitialized T from a pool created with POOL_CREATE(T, ...)
+ */
+#define POOL_NEW(pool, T) ((T *)pool_alloc(pool))
+
+/**
+ * Slab header. Block storage follows the header in the same allocation.
+ */
+typedef struct poolslab {
+    struct poolslab *next; // next slab (older one)
+    size_t len;            // number of blocks in this slab
+} PoolSlab;
+
+typedef struct
+{
+    size_t elem_size;     // block size in bytes (rounded up to pointer alignment)
+    size_t slab_len;      // blocks per slab
+    size_t capacity;      // total blocks across all slabs
+    size_t used;          // blocks currently handed out
+    PoolSlab *slabs;      // slab list (newest first)
+    void *free_list;      // intrusive list of freed blocks
+    uint8_t *cursor;      // next never-used block inside the newest slab
+    uint8_t *end;         // end of the newest slab
+    pthread_mutex_t lock; // taken by PoolCache refill/drain only
+} Pool;
+
+/**
+ * Per-thread cache of free blocks (see pool_cache_init)
+ */
+typedef struct
+{
+    Pool *pool;                   // shared pool
+    size_t count;                 // blocks in the cache
+    void *blocks[POOL_CACHE_LEN]; // free blocks (stack)
+} PoolCache;
+
+/**
+ * @brief Create a pool
+ *
+ * No slab is allocated until the first pool_alloc
+ *
+ * @param[in] elem_size size in bytes of every block (e.g. sizeof(LLNode))
+ * @param[in] slab_len blocks per slab, 0 means POOL_DEFAULT_SLAB_LEN
+ * @return Pool pointer or NULL in case of error
+ */
+Pool *pool_create(size_t elem_size, size_t slab_len);
+
+/**
+ * @brief Destroy a pool
+ *
+ * Release every slab at once. All blocks handed out become invalid.
+ *
+ * @param[in] pool Pool pointer (can be NULL)
+ */
+void pool_destroy(Pool *pool);
+
+/**
+ * @brief Allocate one block
+ *
+ * Reuse a freed block if any, otherwise carve a new one from the newest slab.
+ * A new slab is allocated only when the current one is exhausted.
+ * The block content is not initialized.
+ *
+ * @param[in] pool Pool pointer
+ * @return block pointer or NULL in case of error
+ */
+void *pool_alloc(Pool *pool);
+
+/**
+ * @brief Give a block back to the pool
+ *
+ * The block is pushed on the free list, memory is not returned to the system
+ *
+ * @param[in] pool Pool pointer
+ * @param[in] ptr block previously returned by pool_alloc of the same pool (can be NULL)
+ */
+void pool_free(Pool *pool, void *ptr);
+
+/**
+ * @brief Allocator adapter (see allocator.h)
+ *
+ * Serves blocks of at most pool->elem_size bytes, bigger requests fail.
+ * Not thread safe, like pool_alloc.
+ *
+ * @param[in] pool Pool pointer, must outlive the users of the allocator
+ * @return allocator using the pool
+ */
+Allocator pool_allocator(Pool *pool);
+
+/**
+ * Power of two size classes, one pool each (see poolset_create)
+ */
+typedef struct
+{
+    Pool *classes[POOLSET_CLASSES]; // classes[ii] serves blocks up to POOLSET_MIN_SIZE << ii bytes
+} PoolSet;
+
+/**
+ * @brief Create a set of size class pools
+ *
+ * No slab is allocated until the first allocation of a class.
+ * Like Pool, a PoolSet is not thread safe.
+ *
+ * @param[in] slab_len blocks per slab of every class, 0 means POOL_DEFAULT_SLAB_LEN
+ * @return PoolSet pointer or NULL in case of error
+ */
+PoolSet *poolset_create(size_t slab_len);
+
+/**
+ * @brief Destroy a set of size class pools
+ *
+ * Release every slab at once. Blocks bigger than POOLSET_MAX_SIZE are libc
+ * blocks and must have been freed before.
+ *
+ * @param[in] set PoolSet pointer (can be NULL)
+ */
+void poolset_destroy(PoolSet *set);
+
+/**
+ * @brief Allocator adapter (see allocator.h)
+ *
+ * Blocks up to POOLSET_MAX_SIZE come from the smallest fitting class,
+ * bigger ones from libc. realloc keeps the block when the class does not change.
+ *
+ * @param[in] set PoolSet pointer, must outlive the users of the allocator
+ * @return allocator using the set
+ */
+Allocator poolset_allocator(PoolSet *set);
+
+/**
+ * @brief Initialize a per-thread cache on a shared pool
+ *
+ * The cache belongs to one thread (keep it on the thread stack or in thread
+ * local storage) and must be flushed before the thread exits.
+ *
+ * @param[in] cache cache to initialize
+ * @param[in] pool shared pool
+ */
+void pool_cache_init(PoolCache *cache, Pool *pool);
+
+/**
+ * @brief Allocate one block through a per-thread cache
+ *
+ * Lock free while the cache has blocks, otherwise refill half of it under
+ * the pool lock.
+ *
+ * @param[in] cache cache pointer
+ * @return block pointer or NULL in case of error
+ */
+void *pool_cache_alloc(PoolCache *cache);
+
+/**
+ * @brief Give a block back through a per-thread cache
+ *
+ * Lock free while the cache is not full, otherwise drain half of it to the
+ * pool under the pool lock. The block can come from another thread cache.
+ *
+ * @param[in] cache cache pointer
+ * @param[in] ptr block of the same pool (can be NULL)
+ */
+void pool_cache_free(PoolCache *cache, void *ptr);
+
+/**
+ * @brief Give every cached block back to the pool
+ *
+ * @param[in] cache cache pointer
+ */
+void pool_cache_flush(PoolCache *cache);
+
+#endif // POOL_H
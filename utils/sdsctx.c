@@ -0,0 +1,73 @@
+#include "sdsctx.h"
+#include <stdio.h>
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define SDSCTX_THREAD_LOCAL _Thread_local
+#else
+#define SDSCTX_THREAD_LOCAL __thread // gcc/clang extension before C11
+#endif
+
+/**
+ * Block header: sds realloc/free do not pass the size nor the allocator
+ */
+typedef union {
+    struct
+    {
+        const Allocator *allocator; // allocator that made the block
+        size_t size;                // usable bytes after the header
+    } info;
+    unsigned char align[ALLOCATOR_ALIGN]; // keep the user pointer aligned like malloc
+} SdsBlock;
+
+// current allocator of the thread, NULL means libc
+static SDSCTX_THREAD_LOCAL const Allocator *current = NULL;
+
+/** @copydoc sds_set_allocator */
+const Allocator *sds_set_allocator(const Allocator *allocator) {
+    const Allocator *prev = sds_get_allocator();
+    current = allocator;
+    return prev;
+}
+
+/** @copydoc sds_get_allocator */
+const Allocator *sds_get_allocator(void) {
+    return allocator_or_default(current);
+}
+
+/** @copydoc sds_ctx_malloc */
+void *sds_ctx_malloc(size_t size) {
+    if (size > SIZE_MAX - sizeof(SdsBlock))
+        return NULL;
+    const Allocator *allocator = sds_get_allocator();
+    SdsBlock *block = allocator_alloc(allocator, sizeof(SdsBlock) + size);
+    if (block == NULL)
+        return NULL;
+    block->info.allocator = allocator;
+    block->info.size = size;
+    return block + 1;
+}
+
+/** @copydoc sds_ctx_realloc */
+void *sds_ctx_realloc(void *ptr, size_t size) {
+    if (ptr == NULL)
+        return sds_ctx_malloc(size);
+    if (size > SIZE_MAX - sizeof(SdsBlock))
+        return NULL;
+
+    // the block stays with the allocator that made it
+    SdsBlock *block = (SdsBlock *)ptr - 1;
+    const Allocator *allocator = block->info.allocator;
+    block = allocator_realloc(allocator, block, sizeof(SdsBlock) + block->info.size, sizeof(SdsBlock) + size);
+    if (block == NULL)
+        return NULL;
+    block->info.size = size;
+    return block + 1;
+}
+
+/** @copydoc sds_ctx_free */
+void sds_ctx_free(void *ptr) {
+    if (ptr == NULL)
+        return;
+    SdsBlock *block = (SdsBlock *)ptr - 1;
+    allocator_free(block->info.allocator, block, sizeof(SdsBlock) + block->info.size);
+}
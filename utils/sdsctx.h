@@ -0,0 +1,46 @@
+/**
+ * @brief Run time allocator selection for sds strings
+ *
+ * Build sds.c with -DSDS_ALLOCATOR (see third-party/sds/sdsalloc.h) and
+ * link sdsctx.c: every sds allocation then goes through the Allocator
+ * selected with sds_set_allocator (see allocator.h), e.g. a BumpArena to
+ * build millions of short strings with no libc call and release them all
+ * with a single bumparena_reset/bumparena_destroy.
+ *
+ * The selection is per thread. Every block records the allocator that made
+ * it, so a string can be grown (sdscat) or freed (sdsfree) after the
+ * selection has changed: the Allocator object passed to sds_set_allocator
+ * must outlive the strings it allocated.
+ *
+ * With an arena allocator sdsfree is almost free (only the last block is
+ * reclaimed) and growing the last string happens in place.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef SDSCTX_H
+#define SDSCTX_H
+#include "allocator.h"
+
+/**
+ * @brief Select the allocator of the next sds allocations of this thread
+ *
+ * @param[in] allocator allocator (not copied, must outlive its strings), NULL means libc
+ * @return previous allocator, never NULL (restore it at the end of the scope)
+ */
+const Allocator *sds_set_allocator(const Allocator *allocator);
+
+/**
+ * @brief Allocator of the next sds allocations of this thread
+ *
+ * @return current allocator, never NULL
+ */
+const Allocator *sds_get_allocator(void);
+
+/**
+ * @brief s_malloc/s_realloc/s_free of sds.c built with -DSDS_ALLOCATOR
+ */
+void *sds_ctx_malloc(size_t size);
+void *sds_ctx_realloc(void *ptr, size_t size);
+void sds_ctx_free(void *ptr);
+
+#endif // SDSCTX_H
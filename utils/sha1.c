@@ -1,97 +1,279 @@
 #include "sha1.h"
 #include <stdio.h>
 #include <string.h>
-#include <sys/stat.h>
-#include <unistd.h>
 
-typedef struct
-{
-    uint32_t state[5];
-    uint32_t count[2];
-    uint8_t buffer[64];
-} SHA1_CTX;
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SHA1_HAS_SHANI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
 
 #define ROTLEFT(a, b) (((a) << (b)) | ((a) >> (32 - (b))))
-#define FSHA_BUFF_LEN 8192 // // 8kb
-
-static void sha1_transform(SHA1_CTX *ctx, const uint8_t data[]) {
-    uint32_t a, b, c, d, e, i, j, t, m[80];
-
-    for (i = 0, j = 0; i < 16; ++i, j += 4)
-        m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
-    for (; i < 80; ++i)
-        m[i] = ROTLEFT((m[i - 3] ^ m[i - 8] ^ m[i - 14] ^ m[i - 16]), 1);
-
-    a = ctx->state[0];
-    b = ctx->state[1];
-    c = ctx->state[2];
-    d = ctx->state[3];
-    e = ctx->state[4];
-
-    for (i = 0; i < 20; ++i) {
-        t = ROTLEFT(a, 5) + ((b & c) ^ (~b & d)) + e + 0x5a827999 + m[i];
-        e = d;
-        d = c;
-        c = ROTLEFT(b, 30);
-        b = a;
-        a = t;
-    }
-    for (; i < 40; ++i) {
-        t = ROTLEFT(a, 5) + (b ^ c ^ d) + e + 0x6ed9eba1 + m[i];
-        e = d;
-        d = c;
-        c = ROTLEFT(b, 30);
-        b = a;
-        a = t;
-    }
-    for (; i < 60; ++i) {
-        t = ROTLEFT(a, 5) + ((b & c) ^ (b & d) ^ (c & d)) + e + 0x8f1bbcdc + m[i];
-        e = d;
-        d = c;
-        c = ROTLEFT(b, 30);
-        b = a;
-        a = t;
+
+/**
+ * @brief Block transform: fold blocks * 64 bytes of data into state
+ */
+typedef void (*Sha1TransformFn)(uint32_t state[5], const uint8_t *data, size_t blocks);
+
+/**
+ * @brief Big endian 32-bit load
+ */
+static inline uint32_t sha1_load_be32(const uint8_t *p) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t word;
+    memcpy(&word, p, sizeof(word));
+    return __builtin_bswap32(word);
+#else
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+#endif
+}
+
+/*
+ * Round macros: the schedule is a 16 words circular buffer, W[i] overwrites
+ * W[i-16]. The variables rotate through the macro arguments instead of being
+ * moved, so every round is straight line code on 5 registers + the schedule.
+ */
+#define SHA1_W0(i) (w[(i)] = sha1_load_be32(data + 4 * (i)))
+#define SHA1_W(i) (w[(i) & 15] = ROTLEFT(w[((i) + 13) & 15] ^ w[((i) + 8) & 15] ^ w[((i) + 2) & 15] ^ w[(i) & 15], 1))
+#define SHA1_STEP(v, x, z, f, wi, k)             \
+    do {                                         \
+        z += (f) + (wi) + (k) + ROTLEFT(v, 5);   \
+        x = ROTLEFT(x, 30);                      \
+    } while (0)
+#define SHA1_R0(v, x, y, u, z, i) SHA1_STEP(v, x, z, (x & (y ^ u)) ^ u, SHA1_W0(i), 0x5a827999u)
+#define SHA1_R1(v, x, y, u, z, i) SHA1_STEP(v, x, z, (x & (y ^ u)) ^ u, SHA1_W(i), 0x5a827999u)
+#define SHA1_R2(v, x, y, u, z, i) SHA1_STEP(v, x, z, x ^ y ^ u, SHA1_W(i), 0x6ed9eba1u)
+#define SHA1_R3(v, x, y, u, z, i) SHA1_STEP(v, x, z, ((x | y) & u) | (x & y), SHA1_W(i), 0x8f1bbcdcu)
+#define SHA1_R4(v, x, y, u, z, i) SHA1_STEP(v, x, z, x ^ y ^ u, SHA1_W(i), 0xca62c1d6u)
+
+/**
+ * @brief Portable transform, fully unrolled
+ */
+static void sha1_transform_block(uint32_t state[5], const uint8_t data[]) {
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    uint32_t w[16];
+
+    // clang-format off
+    SHA1_R0(a, b, c, d, e, 0); SHA1_R0(e, a, b, c, d, 1); SHA1_R0(d, e, a, b, c, 2); SHA1_R0(c, d, e, a, b, 3); SHA1_R0(b, c, d, e, a, 4);
+    SHA1_R0(a, b, c, d, e, 5); SHA1_R0(e, a, b, c, d, 6); SHA1_R0(d, e, a, b, c, 7); SHA1_R0(c, d, e, a, b, 8); SHA1_R0(b, c, d, e, a, 9);
+    SHA1_R0(a, b, c, d, e, 10); SHA1_R0(e, a, b, c, d, 11); SHA1_R0(d, e, a, b, c, 12); SHA1_R0(c, d, e, a, b, 13); SHA1_R0(b, c, d, e, a, 14);
+    SHA1_R0(a, b, c, d, e, 15); SHA1_R1(e, a, b, c, d, 16); SHA1_R1(d, e, a, b, c, 17); SHA1_R1(c, d, e, a, b, 18); SHA1_R1(b, c, d, e, a, 19);
+    SHA1_R2(a, b, c, d, e, 20); SHA1_R2(e, a, b, c, d, 21); SHA1_R2(d, e, a, b, c, 22); SHA1_R2(c, d, e, a, b, 23); SHA1_R2(b, c, d, e, a, 24);
+    SHA1_R2(a, b, c, d, e, 25); SHA1_R2(e, a, b, c, d, 26); SHA1_R2(d, e, a, b, c, 27); SHA1_R2(c, d, e, a, b, 28); SHA1_R2(b, c, d, e, a, 29);
+    SHA1_R2(a, b, c, d, e, 30); SHA1_R2(e, a, b, c, d, 31); SHA1_R2(d, e, a, b, c, 32); SHA1_R2(c, d, e, a, b, 33); SHA1_R2(b, c, d, e, a, 34);
+    SHA1_R2(a, b, c, d, e, 35); SHA1_R2(e, a, b, c, d, 36); SHA1_R2(d, e, a, b, c, 37); SHA1_R2(c, d, e, a, b, 38); SHA1_R2(b, c, d, e, a, 39);
+    SHA1_R3(a, b, c, d, e, 40); SHA1_R3(e, a, b, c, d, 41); SHA1_R3(d, e, a, b, c, 42); SHA1_R3(c, d, e, a, b, 43); SHA1_R3(b, c, d, e, a, 44);
+    SHA1_R3(a, b, c, d, e, 45); SHA1_R3(e, a, b, c, d, 46); SHA1_R3(d, e, a, b, c, 47); SHA1_R3(c, d, e, a, b, 48); SHA1_R3(b, c, d, e, a, 49);
+    SHA1_R3(a, b, c, d, e, 50); SHA1_R3(e, a, b, c, d, 51); SHA1_R3(d, e, a, b, c, 52); SHA1_R3(c, d, e, a, b, 53); SHA1_R3(b, c, d, e, a, 54);
+    SHA1_R3(a, b, c, d, e, 55); SHA1_R3(e, a, b, c, d, 56); SHA1_R3(d, e, a, b, c, 57); SHA1_R3(c, d, e, a, b, 58); SHA1_R3(b, c, d, e, a, 59);
+    SHA1_R4(a, b, c, d, e, 60); SHA1_R4(e, a, b, c, d, 61); SHA1_R4(d, e, a, b, c, 62); SHA1_R4(c, d, e, a, b, 63); SHA1_R4(b, c, d, e, a, 64);
+    SHA1_R4(a, b, c, d, e, 65); SHA1_R4(e, a, b, c, d, 66); SHA1_R4(d, e, a, b, c, 67); SHA1_R4(c, d, e, a, b, 68); SHA1_R4(b, c, d, e, a, 69);
+    SHA1_R4(a, b, c, d, e, 70); SHA1_R4(e, a, b, c, d, 71); SHA1_R4(d, e, a, b, c, 72); SHA1_R4(c, d, e, a, b, 73); SHA1_R4(b, c, d, e, a, 74);
+    SHA1_R4(a, b, c, d, e, 75); SHA1_R4(e, a, b, c, d, 76); SHA1_R4(d, e, a, b, c, 77); SHA1_R4(c, d, e, a, b, 78); SHA1_R4(b, c, d, e, a, 79);
+    // clang-format on
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
+
+#undef SHA1_R0
+#undef SHA1_R1
+#undef SHA1_R2
+#undef SHA1_R3
+#undef SHA1_R4
+#undef SHA1_STEP
+#undef SHA1_W
+#undef SHA1_W0
+
+/** @brief Portable transform over consecutive blocks */
+static void sha1_transform_generic(uint32_t state[5], const uint8_t *data, size_t blocks) {
+    for (; blocks > 0; blocks--, data += 64)
+        sha1_transform_block(state, data);
+}
+
+#ifdef SHA1_HAS_SHANI
+/**
+ * @brief One group of 4 rounds with the SHA extensions
+ *
+ * Message words are kept in 4 rolling registers: group i >= 4 derives
+ * W[i] from W[i-4..i-1] with sha1msg1/sha1msg2. e_next receives the E value
+ * of the next group, computed by sha1nexte from the abcd before this group.
+ */
+#define SHA1_NI_GROUP(i, func)                                                              \
+    do {                                                                                    \
+        if ((i) < 4) {                                                                      \
+            msg[(i)] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * (i))), \
+                                        bswap);                                             \
+        } else {                                                                            \
+            msg[(i) & 3] = _mm_sha1msg2_epu32(                                              \
+                _mm_xor_si128(_mm_sha1msg1_epu32(msg[(i) & 3], msg[((i) + 1) & 3]),         \
+                              msg[((i) + 2) & 3]),                                          \
+                msg[((i) + 3) & 3]);                                                        \
+        }                                                                                   \
+        e = (i) == 0 ? _mm_add_epi32(e, msg[0]) : _mm_sha1nexte_epu32(prev, msg[(i) & 3]);  \
+        prev = abcd;                                                                        \
+        abcd = _mm_sha1rnds4_epu32(abcd, e, (func));                                        \
+    } while (0)
+
+/**
+ * @brief Transform with the x86 SHA extensions (sha1rnds4/sha1msg1/sha1msg2)
+ *
+ * Compiled for the sha and sse4.1 targets only, it must be called when
+ * sha1_cpu_has_shani() is true.
+ */
+__attribute__((target("sha,sse4.1"))) static void sha1_transform_shani(uint32_t state[5], const uint8_t *data,
+                                                                        size_t blocks) {
+    const __m128i bswap = _mm_set_epi64x(0x0001020304050607LL, 0x08090a0b0c0d0e0fLL);
+    __m128i abcd, e, prev, abcd_save, e_save, msg[4];
+
+    // a in the highest lane, e alone in the highest lane
+    abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)state), 0x1B);
+    e = _mm_set_epi32((int)state[4], 0, 0, 0);
+
+    for (; blocks > 0; blocks--, data += 64) {
+        abcd_save = abcd;
+        e_save = e;
+
+        SHA1_NI_GROUP(0, 0);
+        SHA1_NI_GROUP(1, 0);
+        SHA1_NI_GROUP(2, 0);
+        SHA1_NI_GROUP(3, 0);
+        SHA1_NI_GROUP(4, 0);
+        SHA1_NI_GROUP(5, 1);
+        SHA1_NI_GROUP(6, 1);
+        SHA1_NI_GROUP(7, 1);
+        SHA1_NI_GROUP(8, 1);
+        SHA1_NI_GROUP(9, 1);
+        SHA1_NI_GROUP(10, 2);
+        SHA1_NI_GROUP(11, 2);
+        SHA1_NI_GROUP(12, 2);
+        SHA1_NI_GROUP(13, 2);
+        SHA1_NI_GROUP(14, 2);
+        SHA1_NI_GROUP(15, 3);
+        SHA1_NI_GROUP(16, 3);
+        SHA1_NI_GROUP(17, 3);
+        SHA1_NI_GROUP(18, 3);
+        SHA1_NI_GROUP(19, 3);
+
+        // e of the next block = rol(a before the last group, 30) + saved e
+        e = _mm_sha1nexte_epu32(prev, e_save);
+        abcd = _mm_add_epi32(abcd, abcd_save);
     }
-    for (; i < 80; ++i) {
-        t = ROTLEFT(a, 5) + (b ^ c ^ d) + e + 0xca62c1d6 + m[i];
-        e = d;
-        d = c;
-        c = ROTLEFT(b, 30);
-        b = a;
-        a = t;
+
+    _mm_storeu_si128((__m128i *)state, _mm_shuffle_epi32(abcd, 0x1B));
+    state[4] = (uint32_t)_mm_extract_epi32(e, 3);
+}
+
+#undef SHA1_NI_GROUP
+
+/**
+ * @brief CPUID check of the SHA extensions (plus SSSE3 and SSE4.1 used around them)
+ *
+ * cpuid is used directly: it also works in -static binaries and with
+ * compilers that do not know the "sha" feature of __builtin_cpu_supports.
+ */
+static bool sha1_cpu_has_shani(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    if (!(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1))
+        return false;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (ebx & bit_SHA) != 0;
+}
+#else
+static bool sha1_cpu_has_shani(void) {
+    return false;
+}
+#endif
+
+static Sha1Impl sha1_active_impl = SHA1_IMPL_GENERIC;
+static Sha1TransformFn sha1_transform = sha1_transform_generic;
+
+#ifdef __GNUC__
+/**
+ * @brief Pick the fastest transform before main (no lazy init, no race)
+ *
+ * With a priority it runs before the default constructors of the other
+ * modules (sha1mb.c relies on sha1_get_impl).
+ */
+__attribute__((constructor(101))) static void sha1_dispatch_init(void) {
+    sha1_set_impl(SHA1_IMPL_AUTO);
+}
+#endif
+
+/** @copydoc sha1_set_impl */
+bool sha1_set_impl(Sha1Impl impl) {
+    if (impl == SHA1_IMPL_AUTO)
+        impl = sha1_cpu_has_shani() ? SHA1_IMPL_SHANI : SHA1_IMPL_GENERIC;
+
+    switch (impl) {
+    case SHA1_IMPL_GENERIC:
+        sha1_transform = sha1_transform_generic;
+        break;
+#ifdef SHA1_HAS_SHANI
+    case SHA1_IMPL_SHANI:
+        if (!sha1_cpu_has_shani())
+            return false;
+        sha1_transform = sha1_transform_shani;
+        break;
+#endif
+    default:
+        return false;
     }
+    sha1_active_impl = impl;
+    return true;
+}
 
-    ctx->state[0] += a;
-    ctx->state[1] += b;
-    ctx->state[2] += c;
-    ctx->state[3] += d;
-    ctx->state[4] += e;
+/** @copydoc sha1_get_impl */
+Sha1Impl sha1_get_impl(void) {
+    return sha1_active_impl;
 }
 
-static void sha1_init(SHA1_CTX *ctx) {
+/** @copydoc sha1_impl_name */
+const char *sha1_impl_name(Sha1Impl impl) {
+    switch (impl) {
+    case SHA1_IMPL_AUTO:
+        return "auto";
+    case SHA1_IMPL_GENERIC:
+        return "generic";
+    case SHA1_IMPL_SHANI:
+        return "sha-ni";
+    }
+    return "unknown";
+}
+
+/** @copydoc sha1_init */
+void sha1_init(SHA1_CTX *ctx) {
     ctx->state[0] = 0x67452301;
     ctx->state[1] = 0xefcdab89;
     ctx->state[2] = 0x98badcfe;
     ctx->state[3] = 0x10325476;
     ctx->state[4] = 0xc3d2e1f0;
-    ctx->count[0] = ctx->count[1] = 0;
+    ctx->count = 0;
 }
 
-static void sha1_update(SHA1_CTX *ctx, const uint8_t data[], size_t len) {
-    uint32_t i, j;
+/** @copydoc sha1_update */
+void sha1_update(SHA1_CTX *ctx, const uint8_t data[], size_t len) {
+    size_t i, j;
 
-    j = (ctx->count[0] >> 3) & 63;
+    if (len == 0)
+        return;
 
-    if ((ctx->count[0] += len << 3) < (len << 3))
-        ctx->count[1]++;
-    ctx->count[1] += (len >> 29);
+    j = ctx->count & 63;
+    ctx->count += len;
 
     if ((j + len) > 63) {
         memcpy(&ctx->buffer[j], data, (i = 64 - j));
-        sha1_transform(ctx, ctx->buffer);
-        for (; i + 63 < len; i += 64) {
-            sha1_transform(ctx, &data[i]);
-        }
+        sha1_transform(ctx->state, ctx->buffer, 1);
+        // all the full blocks in one call, straight from the caller memory
+        size_t blocks = (len - i) / 64;
+        sha1_transform(ctx->state, &data[i], blocks);
+        i += blocks * 64;
         j = 0;
     } else
         i = 0;
@@ -99,25 +281,34 @@ static void sha1_update(SHA1_CTX *ctx, const uint8_t data[], size_t len) {
     memcpy(&ctx->buffer[j], &data[i], len - i);
 }
 
-static void sha1_final(SHA1_CTX *ctx, uint8_t hash[]) {
+/** @copydoc sha1_final */
+void sha1_final(SHA1_CTX *ctx, uint8_t hash[]) {
+    uint64_t bits = ctx->count << 3;
     uint32_t i;
-    uint8_t finalcount[8];
 
-    for (i = 0; i < 8; i++) {
-        finalcount[i] = (uint8_t)((ctx->count[(i >= 4 ? 0 : 1)] >> ((3 - (i & 3)) * 8)) & 255);
+    // 0x80, zeros up to 56 mod 64, bit count: one or two blocks in place
+    size_t used = ctx->count & 63;
+    ctx->buffer[used++] = 0x80;
+    if (used > 56) {
+        memset(&ctx->buffer[used], 0, 64 - used);
+        sha1_transform(ctx->state, ctx->buffer, 1);
+        used = 0;
     }
-
-    sha1_update(ctx, (const uint8_t *)"\200", 1);
-    while ((ctx->count[0] & 504) != 448) {
-        sha1_update(ctx, (const uint8_t *)"\0", 1);
-    }
-    sha1_update(ctx, finalcount, 8);
+    memset(&ctx->buffer[used], 0, 56 - used);
+    for (i = 0; i < 8; i++)
+        ctx->buffer[63 - i] = (uint8_t)(bits >> (i * 8));
+    sha1_transform(ctx->state, ctx->buffer, 1);
 
     for (i = 0; i < 20; i++) {
         hash[i] = (uint8_t)((ctx->state[i >> 2] >> ((3 - (i & 3)) * 8)) & 255);
     }
 }
 
+/** @copydoc sha1_clone */
+void sha1_clone(SHA1_CTX *dst, const SHA1_CTX *src) {
+    memcpy(dst, src, sizeof(SHA1_CTX));
+}
+
 /** @copydoc sha1 */
 bool sha1(const uint8_t *data, size_t len, uint8_t *hash) {
     if (data == NULL || len <= 0 || hash == NULL) {
@@ -134,55 +325,30 @@ bool sha1(const uint8_t *data, size_t len, uint8_t *hash) {
 }
 
 /**
- * @brief is a regular file?
- *
- * If path is not a regular file than return 0
- *
- * @param[in] path
- * @return >0 if is a regular file, 0 if is not
+ * @brief fileio_stream consumer
  */
-static int is_regular_file(const char *path) {
-    struct stat path_stat;
-    if (stat(path, &path_stat) != 0)
-        return 0; // stat failed
-
-    // check if is a regular file
-    return S_ISREG(path_stat.st_mode);
+static bool fsha1_chunk(void *ctx, const uint8_t *data, size_t len) {
+    sha1_update((SHA1_CTX *)ctx, data, len);
+    return true;
 }
 
 /** @copydoc fsha1 */
 bool fsha1(const char *filename, uint8_t *hash) {
+    return fsha1_io(filename, hash, FILEIO_AUTO);
+}
+
+/** @copydoc fsha1_io */
+bool fsha1_io(const char *filename, uint8_t *hash, FileIo io) {
     if (filename == NULL || hash == NULL) {
         printf("Invalid parameters! filename and hash output must be valid!\n");
         return false;
     }
 
-    if (!is_regular_file(filename)) {
-        // printf("%s is not a regular file\n", filename);
-        return false;
-    }
-
-    FILE *fd = fopen(filename, "r");
-    if (fd == NULL) {
-        printf("Cannot open file with name %s\n", filename);
-        return false;
-    }
-
-    // init
-    uint8_t buffer[FSHA_BUFF_LEN];
-    size_t bytes_read;
+    // sha1 is incremental, so is possible to compute in chunks
     SHA1_CTX ctx;
     sha1_init(&ctx);
-
-    // sha1 is incremental, so is possible to compute in chunks
-    while (1) {
-        bytes_read = fread(buffer, 1, sizeof(buffer), fd);
-        if (bytes_read <= 0)
-            break;
-        sha1_update(&ctx, buffer, bytes_read);
-    }
-
-    fclose(fd);             // close file immediately
+    if (!fileio_stream(filename, io, fsha1_chunk, &ctx))
+        return false;
     sha1_final(&ctx, hash); // finalize the sha
 
     return true;
@@ -3,23 +3,48 @@
  *
  * SHA-1 implementation + some utils
  *
+ * The streaming API (sha1_init, sha1_update, sha1_final) hashes data as it
+ * arrives (sockets, pipes) without buffering it: full blocks are hashed
+ * straight from the caller memory, only the last partial block is copied.
+ *
  * @note sha1_transform, sha1_init, sha1_update, sha1_final functions, are taken from public domain
  * @author Alberto Ielpo <alberto.ielpo@gmail.com>
  */
 #ifndef SHA1_H
 #define SHA1_H
 
+#include "fileio.h"
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 
 #define SHA1_LENGTH 20
 #define SHA1_LENGTH_CHAR 41 // 40 + \0
+#define FHASH_LENGTH 32      // Fhash room for the largest hash (SHA-256)
+
+/**
+ * SHA-1 block transform implementations
+ */
+typedef enum {
+    SHA1_IMPL_AUTO,    // fastest supported by the running CPU
+    SHA1_IMPL_GENERIC, // portable C
+    SHA1_IMPL_SHANI    // x86 SHA extensions (sha1rnds4/sha1msg1/sha1msg2)
+} Sha1Impl;
 
+/**
+ * Streaming context, to be initialized with sha1_init
+ */
 typedef struct
 {
-    uint8_t hash[SHA1_LENGTH]; // 20 bytes sha1 hash
-    char *filename;            // filename pointer
+    uint32_t state[5];  // intermediate hash
+    uint64_t count;     // bytes hashed so far
+    uint8_t buffer[64]; // pending partial block
+} SHA1_CTX;
+
+typedef struct
+{
+    uint8_t hash[FHASH_LENGTH]; // 20 bytes sha1 hash (other hashes: see hashalgo.h)
+    char *filename;             // filename pointer
 } Fhash;
 
 /**
@@ -45,6 +70,54 @@ typedef struct
  */
 bool sha1(const uint8_t *data, size_t len, uint8_t *hash);
 
+/**
+ * @brief Start a new streaming hash
+ *
+ * Example:
+ * @code
+ * SHA1_CTX ctx;
+ * uint8_t buf[4096], hash[SHA1_LENGTH];
+ * ssize_t n;
+ * sha1_init(&ctx);
+ * while ((n = read(fd, buf, sizeof(buf))) > 0)
+ *     sha1_update(&ctx, buf, n);
+ * sha1_final(&ctx, hash);
+ * @endcode
+ *
+ * @param[out] ctx context
+ */
+void sha1_init(SHA1_CTX *ctx);
+
+/**
+ * @brief Hash the next len bytes of the message
+ *
+ * @param[in,out] ctx context
+ * @param[in] data bytes (can be NULL only if len is 0)
+ * @param[in] len number of bytes, any size
+ */
+void sha1_update(SHA1_CTX *ctx, const uint8_t data[], size_t len);
+
+/**
+ * @brief Pad the message and write the hash
+ *
+ * The context is consumed: sha1_init it again before reusing it.
+ *
+ * @param[in,out] ctx context
+ * @param[out] hash 20 bytes hash
+ */
+void sha1_final(SHA1_CTX *ctx, uint8_t hash[]);
+
+/**
+ * @brief Copy a context
+ *
+ * Useful to take the hash of a prefix (clone then final) and keep going,
+ * or to hash many messages that share a common prefix.
+ *
+ * @param[out] dst destination context
+ * @param[in] src source context
+ */
+void sha1_clone(SHA1_CTX *dst, const SHA1_CTX *src);
+
 /**
  * @brief Computes the SHA-1 hash of a given file
  *
@@ -54,6 +127,18 @@ bool sha1(const uint8_t *data, size_t len, uint8_t *hash);
  */
 bool fsha1(const char *filename, uint8_t *hash);
 
+/**
+ * @brief Computes the SHA-1 hash of a given file with a given I/O strategy
+ *
+ * fsha1 is fsha1_io with FILEIO_AUTO (strategy by file size, see fileio.h)
+ *
+ * @param[in] filename The filename
+ * @param[out] hash  Pointer to buffer receiving the 20-byte hash. Must not be NULL.
+ * @param[in] io I/O strategy
+ * @returns true if the hash is calculated else false
+ */
+bool fsha1_io(const char *filename, uint8_t *hash, FileIo io);
+
 /**
  * @brief wrap of fsha1 using Fhash struct
  */
@@ -77,4 +162,26 @@ void fhprint(Fhash *fh);
  */
 bool hash_to_hex(const uint8_t *hash, size_t hash_len, char *hex_str, size_t hex_str_len);
 
+/**
+ * @brief Select the block transform
+ *
+ * The fastest implementation is selected at startup via CPUID, this is
+ * needed only to force one (benchmarks, cross checks).
+ * Not thread safe: call it before hashing from multiple threads.
+ *
+ * @param[in] impl implementation, SHA1_IMPL_AUTO to redo the CPU detection
+ * @returns true if selected, false if not supported by this CPU or build
+ */
+bool sha1_set_impl(Sha1Impl impl);
+
+/**
+ * @brief Active block transform (never SHA1_IMPL_AUTO)
+ */
+Sha1Impl sha1_get_impl(void);
+
+/**
+ * @brief Implementation name, e.g. "sha-ni"
+ */
+const char *sha1_impl_name(Sha1Impl impl);
+
 #endif // SHA1_H
\ No newline at end of file
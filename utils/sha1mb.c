@@ -0,0 +1,188 @@
+#include "sha1mb.h"
+#include "mbsched.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef uint32_t Sha1MbV4 __attribute__((vector_size(16)));
+typedef uint32_t Sha1MbV8 __attribute__((vector_size(32)));
+typedef uint32_t Sha1MbV16 __attribute__((vector_size(64)));
+
+#define SHA1_MB_ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+/**
+ * @brief One round on all lanes, with the 16 words rolling schedule
+ */
+#define SHA1_MB_ROUND(i, f, k)                                                           \
+    do {                                                                                 \
+        if ((i) >= 16)                                                                   \
+            w[(i) & 15] = SHA1_MB_ROL(w[((i) - 3) & 15] ^ w[((i) - 8) & 15] ^            \
+                                          w[((i) - 14) & 15] ^ w[(i) & 15],              \
+                                      1);                                                \
+        t = SHA1_MB_ROL(a, 5) + (f) + e + (k) + w[(i) & 15];                             \
+        e = d;                                                                           \
+        d = c;                                                                           \
+        c = SHA1_MB_ROL(b, 30);                                                          \
+        b = a;                                                                           \
+        a = t;                                                                           \
+    } while (0)
+
+/**
+ * @brief Define a lanes transform for the vector type V of L lanes
+ *
+ * The same C code is compiled once per width, ATTR enables the instruction
+ * set of the width.
+ */
+#define SHA1_MB_DEFINE_TRANSFORM(name, V, L, ATTR)                                               \
+    ATTR static void name(uint32_t *state, const uint8_t *const data[], size_t blocks) {         \
+        V a, b, c, d, e, t, w[16];                                                               \
+        memcpy(&a, state + 0 * (L), sizeof(V));                                                  \
+        memcpy(&b, state + 1 * (L), sizeof(V));                                                  \
+        memcpy(&c, state + 2 * (L), sizeof(V));                                                  \
+        memcpy(&d, state + 3 * (L), sizeof(V));                                                  \
+        memcpy(&e, state + 4 * (L), sizeof(V));                                                  \
+        for (size_t blk = 0; blk < blocks; blk++) {                                              \
+            V sa = a, sb = b, sc = c, sd = d, se = e;                                            \
+            /* transpose: word i of every lane in w[i] */                                       \
+            for (int i = 0; i < 16; i++) {                                                       \
+                for (int l = 0; l < (L); l++) {                                                  \
+                    uint32_t word;                                                               \
+                    memcpy(&word, data[l] + blk * 64 + 4 * i, sizeof(word));                     \
+                    w[i][l] = __builtin_bswap32(word);                                           \
+                }                                                                                \
+            }                                                                                    \
+            for (int i = 0; i < 20; i++)                                                         \
+                SHA1_MB_ROUND(i, d ^ (b & (c ^ d)), 0x5a827999u);                                \
+            for (int i = 20; i < 40; i++)                                                        \
+                SHA1_MB_ROUND(i, b ^ c ^ d, 0x6ed9eba1u);                                        \
+            for (int i = 40; i < 60; i++)                                                        \
+                SHA1_MB_ROUND(i, (b & c) | (d & (b | c)), 0x8f1bbcdcu);                          \
+            for (int i = 60; i < 80; i++)                                                        \
+                SHA1_MB_ROUND(i, b ^ c ^ d, 0xca62c1d6u);                                        \
+            a += sa;                                                                             \
+            b += sb;                                                                             \
+            c += sc;                                                                             \
+            d += sd;                                                                             \
+            e += se;                                                                             \
+        }                                                                                        \
+        memcpy(state + 0 * (L), &a, sizeof(V));                                                  \
+        memcpy(state + 1 * (L), &b, sizeof(V));                                                  \
+        memcpy(state + 2 * (L), &c, sizeof(V));                                                  \
+        memcpy(state + 3 * (L), &d, sizeof(V));                                                  \
+        memcpy(state + 4 * (L), &e, sizeof(V));                                                  \
+    }
+
+SHA1_MB_DEFINE_TRANSFORM(sha1_mb_transform_vec4, Sha1MbV4, 4, )
+#ifdef MB_HAS_X86
+SHA1_MB_DEFINE_TRANSFORM(sha1_mb_transform_avx2, Sha1MbV8, 8, __attribute__((target("avx2"))))
+SHA1_MB_DEFINE_TRANSFORM(sha1_mb_transform_avx512, Sha1MbV16, 16, __attribute__((target("avx512f"))))
+#endif
+
+#undef SHA1_MB_DEFINE_TRANSFORM
+#undef SHA1_MB_ROUND
+
+/**
+ * @brief Lanes transform of every engine, NULL for SHA1_MB_SERIAL
+ */
+static const MbTransformFn sha1_mb_transforms[SHA1_MB_AVX512 + 1] = {
+    [SHA1_MB_VEC4] = sha1_mb_transform_vec4,
+#ifdef MB_HAS_X86
+    [SHA1_MB_AVX2] = sha1_mb_transform_avx2,
+    [SHA1_MB_AVX512] = sha1_mb_transform_avx512,
+#endif
+};
+
+static Sha1MbImpl sha1_mb_active_impl = SHA1_MB_VEC4;
+static MbTransformFn sha1_mb_transform = sha1_mb_transform_vec4;
+static size_t sha1_mb_active_lanes = 4;
+
+#ifdef __GNUC__
+/**
+ * @brief Pick the fastest engine before main
+ */
+__attribute__((constructor)) static void sha1_mb_dispatch_init(void) {
+    sha1_mb_set_impl(SHA1_MB_AUTO);
+}
+#endif
+
+/** @copydoc sha1_mb_set_impl */
+bool sha1_mb_set_impl(Sha1MbImpl impl) {
+    MbImpl selected;
+    if (!mb_select_impl((MbImpl)impl, sha1_get_impl() == SHA1_IMPL_SHANI, &selected))
+        return false;
+    sha1_mb_transform = sha1_mb_transforms[selected];
+    sha1_mb_active_lanes = mb_impl_lanes(selected);
+    sha1_mb_active_impl = (Sha1MbImpl)selected;
+    return true;
+}
+
+/** @copydoc sha1_mb_get_impl */
+Sha1MbImpl sha1_mb_get_impl(void) {
+    return sha1_mb_active_impl;
+}
+
+/** @copydoc sha1_mb_impl_name */
+const char *sha1_mb_impl_name(Sha1MbImpl impl) {
+    return mb_impl_name((MbImpl)impl);
+}
+
+/** @copydoc sha1_mb_lanes */
+size_t sha1_mb_lanes(void) {
+    return sha1_mb_active_lanes;
+}
+
+/**
+ * @brief Active engine as seen by the lane scheduler
+ */
+static MbEngine sha1_mb_engine(void) {
+    static const uint32_t init[5] = {0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+    MbEngine engine = {"sha1_mb", sha1_mb_transform, sha1_mb_active_lanes, 5, init, fhsha1};
+    return engine;
+}
+
+/** @copydoc sha1_mb */
+bool sha1_mb(const uint8_t *const data[], const size_t lens[], size_t count, uint8_t hashes[][SHA1_LENGTH]) {
+    if ((data == NULL || lens == NULL || hashes == NULL) && count > 0) {
+        fprintf(stderr, "[sha1_mb] Invalid parameters\n");
+        return false;
+    }
+    for (size_t ii = 0; ii < count; ii++) {
+        if (data[ii] == NULL && lens[ii] > 0) {
+            fprintf(stderr, "[sha1_mb] Invalid parameters\n");
+            return false;
+        }
+    }
+
+    if (sha1_mb_transform == NULL) {
+        // SHA1_MB_SERIAL
+        for (size_t ii = 0; ii < count; ii++) {
+            SHA1_CTX ctx;
+            sha1_init(&ctx);
+            sha1_update(&ctx, data[ii], lens[ii]);
+            sha1_final(&ctx, hashes[ii]);
+        }
+        return true;
+    }
+
+    MbEngine engine = sha1_mb_engine();
+    return mb_hash_memory(&engine, data, lens, count, (uint8_t *)hashes);
+}
+
+/** @copydoc fhsha1_mb */
+size_t fhsha1_mb(Fhash *fhs, size_t count, bool ok[]) {
+    if (fhs == NULL || count == 0)
+        return 0;
+
+    if (sha1_mb_transform == NULL) {
+        size_t hashed = 0;
+        for (size_t ii = 0; ii < count; ii++) {
+            bool res = fhsha1(&fhs[ii]);
+            if (ok != NULL)
+                ok[ii] = res;
+            hashed += res;
+        }
+        return hashed;
+    }
+
+    MbEngine engine = sha1_mb_engine();
+    return mb_hash_files(&engine, fhs, count, ok);
+}
@@ -0,0 +1,91 @@
+/**
+ * @brief Multi-buffer SHA-1
+ *
+ * Hashes many independent messages at once: every vector lane carries one
+ * message, 4 lanes with 128-bit vectors (any CPU, GCC vector extensions),
+ * 8 lanes with AVX2 and 16 lanes with AVX-512. A lane scheduler (mbsched.h)
+ * refills a lane with the next message as soon as its message is finished,
+ * so short and long messages can be mixed freely.
+ *
+ * This is meant for many small files, where a single stream is bound by the
+ * per block latency of the transform. With one big message only one lane
+ * works: use sha1/fsha1 instead. fhsha1_mb does it on its own for the files
+ * from MB_SERIAL_MIN bytes.
+ *
+ * The engine is selected at startup via CPUID. On CPUs with the SHA
+ * extensions but without AVX-512 the serial SHA-NI transform is faster than
+ * 8 lanes, so SHA1_MB_SERIAL (one message at a time through sha1.h) is used.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef SHA1MB_H
+#define SHA1MB_H
+
+#include "mbsched.h"
+#include "sha1.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA1_MB_MAX_LANES MB_MAX_LANES // widest engine (AVX-512)
+#define SHA1_MB_FILE_BUFF MB_FILE_BUFF // read buffer per lane
+
+typedef enum {
+    SHA1_MB_AUTO = MB_IMPL_AUTO,     // fastest supported by the running CPU
+    SHA1_MB_SERIAL = MB_IMPL_SERIAL, // one message at a time (sha1.h transform)
+    SHA1_MB_VEC4 = MB_IMPL_VEC4,     // 4 lanes, portable vector extensions (SSE2/NEON)
+    SHA1_MB_AVX2 = MB_IMPL_AVX2,     // 8 lanes
+    SHA1_MB_AVX512 = MB_IMPL_AVX512  // 16 lanes
+} Sha1MbImpl;
+
+/**
+ * @brief Select the engine
+ *
+ * Not thread safe: call it before hashing from multiple threads.
+ *
+ * @param[in] impl engine, SHA1_MB_AUTO to redo the CPU detection
+ * @returns true if selected, false if not supported by this CPU or build
+ */
+bool sha1_mb_set_impl(Sha1MbImpl impl);
+
+/**
+ * @brief Active engine (never SHA1_MB_AUTO)
+ */
+Sha1MbImpl sha1_mb_get_impl(void);
+
+/**
+ * @brief Engine name, e.g. "avx2"
+ */
+const char *sha1_mb_impl_name(Sha1MbImpl impl);
+
+/**
+ * @brief Number of lanes of the active engine (1 for SHA1_MB_SERIAL)
+ */
+size_t sha1_mb_lanes(void);
+
+/**
+ * @brief Computes the SHA-1 of count in-memory messages
+ *
+ * @param[in] data messages, data[ii] can be NULL only if lens[ii] is 0
+ * @param[in] lens message lengths in bytes
+ * @param[in] count number of messages
+ * @param[out] hashes one 20-byte hash per message
+ * @returns true if the hashes are calculated else false
+ */
+bool sha1_mb(const uint8_t *const data[], const size_t lens[], size_t count, uint8_t hashes[][SHA1_LENGTH]);
+
+/**
+ * @brief Computes the SHA-1 of many files, like fhsha1 on each of them
+ *
+ * Files that cannot be hashed (not regular, cannot be opened or read) keep
+ * their hash untouched. Files from MB_SERIAL_MIN bytes are hashed with
+ * fhsha1, the SHA-NI transform when available, instead of a single lane.
+ *
+ * @param[in,out] fhs files, hash is written for every hashed file
+ * @param[in] count number of files
+ * @param[out] ok per file result (can be NULL)
+ * @returns number of files hashed
+ */
+size_t fhsha1_mb(Fhash *fhs, size_t count, bool ok[]);
+
+#endif // SHA1MB_H
@@ -0,0 +1,309 @@
+#define _POSIX_C_SOURCE 200809L // pread, posix_fadvise
+#include "sha1tree.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const uint8_t sha1tree_leaf_prefix = 0x00;
+static const uint8_t sha1tree_node_prefix = 0x01;
+
+/**
+ * @brief Start a leaf hash: SHA1(0x00 || ...)
+ */
+static void sha1tree_leaf_start(SHA1_CTX *leaf) {
+    sha1_init(leaf);
+    sha1_update(leaf, &sha1tree_leaf_prefix, 1);
+}
+
+/**
+ * @brief Inner node: SHA1(0x01 || left || right), out can be left
+ */
+static void sha1tree_node(const uint8_t left[], const uint8_t right[], uint8_t out[]) {
+    SHA1_CTX ctx;
+    sha1_init(&ctx);
+    sha1_update(&ctx, &sha1tree_node_prefix, 1);
+    sha1_update(&ctx, left, SHA1_LENGTH);
+    sha1_update(&ctx, right, SHA1_LENGTH);
+    sha1_final(&ctx, out);
+}
+
+/**
+ * @brief Subtrees in the stack: one per bit set in leaves
+ */
+static size_t sha1tree_depth(uint64_t leaves) {
+    size_t depth = 0;
+    for (; leaves != 0; leaves &= leaves - 1)
+        depth++;
+    return depth;
+}
+
+/**
+ * @brief Append the next leaf hash, merging the complete subtrees of the same size
+ *
+ * Like a binary counter increment: every trailing zero of the new leaf
+ * count is a carry, two subtrees of the same size merged into one.
+ */
+static void sha1tree_push(SHA1TREE_CTX *ctx, const uint8_t leaf_hash[]) {
+    size_t depth = sha1tree_depth(ctx->leaves);
+    memcpy(ctx->stack[depth++], leaf_hash, SHA1_LENGTH);
+    ctx->leaves++;
+    for (uint64_t carry = ctx->leaves; (carry & 1) == 0; carry >>= 1) {
+        depth--;
+        sha1tree_node(ctx->stack[depth - 1], ctx->stack[depth], ctx->stack[depth - 1]);
+    }
+}
+
+/** @copydoc sha1tree_init */
+void sha1tree_init(SHA1TREE_CTX *ctx) {
+    ctx->leaves = 0;
+    ctx->leaf_fill = 0;
+    sha1tree_leaf_start(&ctx->leaf);
+}
+
+/** @copydoc sha1tree_update */
+void sha1tree_update(SHA1TREE_CTX *ctx, const uint8_t data[], size_t len) {
+    while (len > 0) {
+        size_t take = SHA1TREE_LEAF_LEN - ctx->leaf_fill;
+        if (take > len)
+            take = len;
+        sha1_update(&ctx->leaf, data, take);
+        data += take;
+        len -= take;
+        ctx->leaf_fill += take;
+
+        if (ctx->leaf_fill == SHA1TREE_LEAF_LEN) {
+            uint8_t leaf_hash[SHA1_LENGTH];
+            sha1_final(&ctx->leaf, leaf_hash);
+            sha1tree_push(ctx, leaf_hash);
+            sha1tree_leaf_start(&ctx->leaf);
+            ctx->leaf_fill = 0;
+        }
+    }
+}
+
+/** @copydoc sha1tree_final */
+void sha1tree_final(SHA1TREE_CTX *ctx, uint8_t hash[]) {
+    if (ctx->leaf_fill > 0) {
+        uint8_t leaf_hash[SHA1_LENGTH];
+        sha1_final(&ctx->leaf, leaf_hash);
+        sha1tree_push(ctx, leaf_hash);
+    }
+
+    if (ctx->leaves == 0) {
+        // empty content: SHA1 of nothing
+        sha1_init(&ctx->leaf);
+        sha1_final(&ctx->leaf, hash);
+        return;
+    }
+
+    // fold the subtrees right to left: smaller ones are the right children
+    size_t depth = sha1tree_depth(ctx->leaves);
+    uint8_t root[SHA1_LENGTH];
+    memcpy(root, ctx->stack[depth - 1], SHA1_LENGTH);
+    for (size_t ii = depth - 1; ii > 0; ii--)
+        sha1tree_node(ctx->stack[ii - 1], root, root);
+    memcpy(hash, root, SHA1_LENGTH);
+}
+
+/** @copydoc sha1tree */
+bool sha1tree(const uint8_t *data, size_t len, uint8_t *hash) {
+    if ((data == NULL && len > 0) || hash == NULL) {
+        printf("Invalid parameters! data and hash output must be valid!\n");
+        return false;
+    }
+
+    SHA1TREE_CTX ctx;
+    sha1tree_init(&ctx);
+    sha1tree_update(&ctx, data, len);
+    sha1tree_final(&ctx, hash);
+    return true;
+}
+
+/**
+ * @brief Leaves of a file hashed by a pool of threads
+ */
+typedef struct
+{
+    const char *filename;
+    int fd;
+    uint64_t size;                  // file size
+    uint64_t first;                 // first leaf of the round
+    size_t count;                   // leaves in the round
+    size_t next;                    // next leaf of the round to hash
+    bool failed;                    // a leaf cannot be read
+    uint8_t (*hashes)[SHA1_LENGTH]; // leaf hashes of the round
+    pthread_mutex_t lock;           // protects next and failed
+} Sha1TreeRound;
+
+/**
+ * @brief pread the whole leaf
+ *
+ * @return 0 or the errno (EIO if the file is shorter than expected)
+ */
+static int sha1tree_read_leaf(int fd, uint8_t *buffer, size_t len, uint64_t offset) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t bytes_read = pread(fd, buffer + done, len - done, (off_t)(offset + done));
+        if (bytes_read < 0 && errno == EINTR)
+            continue;
+        if (bytes_read < 0)
+            return errno;
+        if (bytes_read == 0)
+            return EIO; // truncated while hashing
+        done += (size_t)bytes_read;
+    }
+    return 0;
+}
+
+static void *sha1tree_worker(void *arg) {
+    Sha1TreeRound *round = (Sha1TreeRound *)arg;
+    uint8_t *buffer = malloc(SHA1TREE_LEAF_LEN);
+    if (buffer == NULL) {
+        perror("[fsha1tree] Cannot allocate the leaf buffer");
+        pthread_mutex_lock(&round->lock);
+        round->failed = true;
+        pthread_mutex_unlock(&round->lock);
+        return NULL;
+    }
+
+    for (;;) {
+        pthread_mutex_lock(&round->lock);
+        size_t job = !round->failed && round->next < round->count ? round->next++ : round->count;
+        pthread_mutex_unlock(&round->lock);
+        if (job == round->count)
+            break;
+
+        uint64_t offset = (round->first + job) * SHA1TREE_LEAF_LEN;
+        size_t len = round->size - offset < SHA1TREE_LEAF_LEN ? (size_t)(round->size - offset) : SHA1TREE_LEAF_LEN;
+        int err = sha1tree_read_leaf(round->fd, buffer, len, offset);
+        if (err != 0) {
+            fprintf(stderr, "[fsha1tree] Cannot read %s: %s\n", round->filename, strerror(err));
+            pthread_mutex_lock(&round->lock);
+            round->failed = true;
+            pthread_mutex_unlock(&round->lock);
+            break;
+        }
+
+        SHA1_CTX leaf;
+        sha1tree_leaf_start(&leaf);
+        sha1_update(&leaf, buffer, len);
+        sha1_final(&leaf, round->hashes[job]);
+    }
+
+    free(buffer);
+    return NULL;
+}
+
+/**
+ * @brief Hash the leaves of the round on threads workers
+ */
+static void sha1tree_run_round(Sha1TreeRound *round, size_t threads) {
+    if (threads > round->count)
+        threads = round->count;
+
+    pthread_t *tids = threads > 1 ? calloc(threads, sizeof(pthread_t)) : NULL;
+    size_t started = 0;
+    if (tids != NULL) {
+        for (; started < threads; started++) {
+            if (pthread_create(&tids[started], NULL, sha1tree_worker, round) != 0)
+                break;
+        }
+    }
+    if (started == 0)
+        sha1tree_worker(round); // single leaf or no thread at all: do it here
+    for (size_t ii = 0; ii < started; ii++)
+        pthread_join(tids[ii], NULL);
+    free(tids);
+}
+
+/**
+ * @brief fileio_stream callback: feed the streaming tree
+ */
+static bool sha1tree_stream_chunk(void *ctx, const uint8_t *data, size_t len) {
+    sha1tree_update((SHA1TREE_CTX *)ctx, data, len);
+    return true;
+}
+
+/** @copydoc fsha1tree */
+bool fsha1tree(const char *filename, uint8_t *hash) {
+    return fsha1tree_threads(filename, hash, 0);
+}
+
+/** @copydoc fsha1tree_threads */
+bool fsha1tree_threads(const char *filename, uint8_t *hash, size_t threads) {
+    if (filename == NULL || hash == NULL) {
+        printf("Invalid parameters! filename and hash output must be valid!\n");
+        return false;
+    }
+
+    // stat before open: opening a fifo would block (same as fileio_stream)
+    struct stat st;
+    if (stat(filename, &st) != 0 || !S_ISREG(st.st_mode))
+        return false;
+    if (st.st_size == 0) {
+        // procfs, sysfs: size 0 but content anyway, no leaf offsets to split
+        SHA1TREE_CTX ctx;
+        sha1tree_init(&ctx);
+        if (!fileio_stream(filename, FILEIO_READ, sha1tree_stream_chunk, &ctx))
+            return false;
+        sha1tree_final(&ctx, hash);
+        return true;
+    }
+
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "[fsha1tree] Cannot open %s: %s\n", filename, strerror(errno));
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL); // only a hint
+
+    if (threads == 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = cpus > 0 ? (size_t)cpus : 1;
+    }
+
+    uint64_t size = (uint64_t)st.st_size;
+    uint64_t leaves = (size + SHA1TREE_LEAF_LEN - 1) / SHA1TREE_LEAF_LEN;
+    size_t round_max = leaves < SHA1TREE_ROUND_LEAVES ? (size_t)leaves : SHA1TREE_ROUND_LEAVES;
+    Sha1TreeRound round = {.filename = filename, .fd = fd, .size = size};
+    round.hashes = malloc((round_max > 0 ? round_max : 1) * sizeof(*round.hashes));
+    if (round.hashes == NULL) {
+        perror("[fsha1tree] Cannot allocate the leaf hashes");
+        close(fd);
+        return false;
+    }
+    pthread_mutex_init(&round.lock, NULL);
+
+    // rounds of leaves hashed in parallel, combined in order here
+    SHA1TREE_CTX ctx;
+    sha1tree_init(&ctx);
+    for (uint64_t first = 0; first < leaves && !round.failed; first += round.count) {
+        round.first = first;
+        round.count = leaves - first < round_max ? (size_t)(leaves - first) : round_max;
+        round.next = 0;
+        sha1tree_run_round(&round, threads);
+        for (size_t ii = 0; ii < round.count && !round.failed; ii++)
+            sha1tree_push(&ctx, round.hashes[ii]);
+    }
+    if (!round.failed)
+        sha1tree_final(&ctx, hash);
+
+    pthread_mutex_destroy(&round.lock);
+    free(round.hashes);
+    close(fd);
+    return !round.failed;
+}
+
+/** @copydoc fhsha1tree */
+bool fhsha1tree(Fhash *fh) {
+    if (fh == NULL || fh->filename == NULL) {
+        printf("Invalid parameters! filename and hash output must be valid!\n");
+        return false;
+    }
+    return fsha1tree(fh->filename, fh->hash);
+}
@@ -0,0 +1,109 @@
+/**
+ * @brief SHA-1 Merkle tree hash, leaves hashed in parallel
+ *
+ * fsha1 is a single chain of blocks: one core, whatever the file size.
+ * The tree hash splits the content in SHA1TREE_LEAF_LEN leaves, hashes them
+ * independently (on every core) and combines them into a root digest.
+ *
+ * Construction (RFC 6962 Merkle Tree Hash, with SHA-1):
+ * - leaves: d[0..n-1], SHA1TREE_LEAF_LEN bytes each, the last one shorter
+ * - MTH({})     = SHA1()                                  (empty content)
+ * - MTH({d0})   = SHA1(0x00 || d0)                        (leaf)
+ * - MTH(d[0:n]) = SHA1(0x01 || MTH(d[0:k]) || MTH(d[k:n]))
+ *   with k the largest power of two smaller than n (left subtree complete)
+ *
+ * The 0x00 / 0x01 prefixes keep leaves and nodes apart (no second
+ * preimage by presenting a node as a leaf). The digest is not the SHA-1
+ * of the file: it only compares with other sha1tree digests, and changes
+ * if SHA1TREE_LEAF_LEN changes.
+ *
+ * @see https://www.rfc-editor.org/rfc/rfc6962#section-2.1
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef SHA1TREE_H
+#define SHA1TREE_H
+
+#include "sha1.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA1TREE_LEAF_LEN (1024 * 1024) // leaf size, part of the digest definition
+#define SHA1TREE_ROUND_LEAVES 4096      // fsha1tree: leaves hashed per round (bounded memory)
+
+/**
+ * Streaming context, to be initialized with sha1tree_init
+ */
+typedef struct
+{
+    uint8_t stack[64][SHA1_LENGTH]; // roots of the complete subtrees, largest first
+    uint64_t leaves;                // leaves pushed, its bits are the subtrees in stack
+    SHA1_CTX leaf;                  // current leaf
+    size_t leaf_fill;               // bytes in the current leaf
+} SHA1TREE_CTX;
+
+/**
+ * @brief Computes the tree hash of the given data (single thread)
+ *
+ * @param[in]  data  bytes (can be NULL only if len is 0)
+ * @param[in]  len   number of bytes
+ * @param[out] hash  20 bytes hash
+ * @returns true if the hash is calculated else false
+ */
+bool sha1tree(const uint8_t *data, size_t len, uint8_t *hash);
+
+/**
+ * @brief Start a new streaming tree hash
+ *
+ * @param[out] ctx context
+ */
+void sha1tree_init(SHA1TREE_CTX *ctx);
+
+/**
+ * @brief Hash the next len bytes of the message
+ *
+ * @param[in,out] ctx context
+ * @param[in] data bytes (can be NULL only if len is 0)
+ * @param[in] len number of bytes, any size
+ */
+void sha1tree_update(SHA1TREE_CTX *ctx, const uint8_t data[], size_t len);
+
+/**
+ * @brief Combine the subtrees and write the root hash
+ *
+ * The context is consumed: sha1tree_init it again before reusing it.
+ *
+ * @param[in,out] ctx context
+ * @param[out] hash 20 bytes hash
+ */
+void sha1tree_final(SHA1TREE_CTX *ctx, uint8_t hash[]);
+
+/**
+ * @brief Computes the tree hash of a given file, one thread per online CPU
+ *
+ * @param[in] filename The filename
+ * @param[out] hash 20 bytes hash
+ * @returns true if the hash is calculated else false
+ */
+bool fsha1tree(const char *filename, uint8_t *hash);
+
+/**
+ * @brief Computes the tree hash of a given file with a given number of threads
+ *
+ * Every thread reads (pread) and hashes whole leaves, so the storage sees
+ * up to threads reads in flight. The leaf hashes of a round of
+ * SHA1TREE_ROUND_LEAVES leaves are combined in order by the caller thread.
+ *
+ * @param[in] filename The filename
+ * @param[out] hash 20 bytes hash
+ * @param[in] threads worker threads (0 = online CPUs)
+ * @returns true if the hash is calculated else false
+ */
+bool fsha1tree_threads(const char *filename, uint8_t *hash, size_t threads);
+
+/**
+ * @brief wrap of fsha1tree using Fhash struct
+ */
+bool fhsha1tree(Fhash *fh);
+
+#endif // SHA1TREE_H
@@ -0,0 +1,380 @@
+#include "sha256.h"
+#include <stdio.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SHA256_HAS_SHANI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#define SHA256_ROTR(a, b) (((a) >> (b)) | ((a) << (32 - (b))))
+
+/**
+ * @brief Block transform: fold blocks * 64 bytes of data into state
+ */
+typedef void (*Sha256TransformFn)(uint32_t state[8], const uint8_t *data, size_t blocks);
+
+/**
+ * @brief Round constants: first 32 bits of the fractional parts of the cube roots of the first 64 primes
+ */
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+/**
+ * @brief Big endian 32-bit load
+ */
+static inline uint32_t sha256_load_be32(const uint8_t *p) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t word;
+    memcpy(&word, p, sizeof(word));
+    return __builtin_bswap32(word);
+#else
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+#endif
+}
+
+/*
+ * Round macros, same scheme of sha1.c: the schedule is a 16 words circular
+ * buffer and the 8 variables rotate through the macro arguments, so 8
+ * rounds in a row bring them back in place.
+ */
+#define SHA256_S0(x) (SHA256_ROTR(x, 2) ^ SHA256_ROTR(x, 13) ^ SHA256_ROTR(x, 22))
+#define SHA256_S1(x) (SHA256_ROTR(x, 6) ^ SHA256_ROTR(x, 11) ^ SHA256_ROTR(x, 25))
+#define SHA256_G0(x) (SHA256_ROTR(x, 7) ^ SHA256_ROTR(x, 18) ^ ((x) >> 3))
+#define SHA256_G1(x) (SHA256_ROTR(x, 17) ^ SHA256_ROTR(x, 19) ^ ((x) >> 10))
+#define SHA256_W0(i) (w[(i)] = sha256_load_be32(data + 4 * (i)))
+#define SHA256_W(i) (w[(i) & 15] += SHA256_G1(w[((i) - 2) & 15]) + w[((i) - 7) & 15] + SHA256_G0(w[((i) - 15) & 15]))
+#define SHA256_STEP(a, b, c, d, e, f, g, h, wi, i)                                 \
+    do {                                                                           \
+        uint32_t t1 = h + SHA256_S1(e) + (g ^ (e & (f ^ g))) + sha256_k[i] + (wi); \
+        d += t1;                                                                   \
+        h = t1 + SHA256_S0(a) + ((a & b) | (c & (a | b)));                         \
+    } while (0)
+#define SHA256_R0(a, b, c, d, e, f, g, h, i) SHA256_STEP(a, b, c, d, e, f, g, h, SHA256_W0(i), i)
+#define SHA256_R1(a, b, c, d, e, f, g, h, i) SHA256_STEP(a, b, c, d, e, f, g, h, SHA256_W(i), i)
+
+/**
+ * @brief Portable transform, fully unrolled
+ */
+static void sha256_transform_block(uint32_t state[8], const uint8_t data[]) {
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    uint32_t w[16];
+
+    // clang-format off
+    SHA256_R0(a, b, c, d, e, f, g, h, 0); SHA256_R0(h, a, b, c, d, e, f, g, 1); SHA256_R0(g, h, a, b, c, d, e, f, 2); SHA256_R0(f, g, h, a, b, c, d, e, 3);
+    SHA256_R0(e, f, g, h, a, b, c, d, 4); SHA256_R0(d, e, f, g, h, a, b, c, 5); SHA256_R0(c, d, e, f, g, h, a, b, 6); SHA256_R0(b, c, d, e, f, g, h, a, 7);
+    SHA256_R0(a, b, c, d, e, f, g, h, 8); SHA256_R0(h, a, b, c, d, e, f, g, 9); SHA256_R0(g, h, a, b, c, d, e, f, 10); SHA256_R0(f, g, h, a, b, c, d, e, 11);
+    SHA256_R0(e, f, g, h, a, b, c, d, 12); SHA256_R0(d, e, f, g, h, a, b, c, 13); SHA256_R0(c, d, e, f, g, h, a, b, 14); SHA256_R0(b, c, d, e, f, g, h, a, 15);
+    SHA256_R1(a, b, c, d, e, f, g, h, 16); SHA256_R1(h, a, b, c, d, e, f, g, 17); SHA256_R1(g, h, a, b, c, d, e, f, 18); SHA256_R1(f, g, h, a, b, c, d, e, 19);
+    SHA256_R1(e, f, g, h, a, b, c, d, 20); SHA256_R1(d, e, f, g, h, a, b, c, 21); SHA256_R1(c, d, e, f, g, h, a, b, 22); SHA256_R1(b, c, d, e, f, g, h, a, 23);
+    SHA256_R1(a, b, c, d, e, f, g, h, 24); SHA256_R1(h, a, b, c, d, e, f, g, 25); SHA256_R1(g, h, a, b, c, d, e, f, 26); SHA256_R1(f, g, h, a, b, c, d, e, 27);
+    SHA256_R1(e, f, g, h, a, b, c, d, 28); SHA256_R1(d, e, f, g, h, a, b, c, 29); SHA256_R1(c, d, e, f, g, h, a, b, 30); SHA256_R1(b, c, d, e, f, g, h, a, 31);
+    SHA256_R1(a, b, c, d, e, f, g, h, 32); SHA256_R1(h, a, b, c, d, e, f, g, 33); SHA256_R1(g, h, a, b, c, d, e, f, 34); SHA256_R1(f, g, h, a, b, c, d, e, 35);
+    SHA256_R1(e, f, g, h, a, b, c, d, 36); SHA256_R1(d, e, f, g, h, a, b, c, 37); SHA256_R1(c, d, e, f, g, h, a, b, 38); SHA256_R1(b, c, d, e, f, g, h, a, 39);
+    SHA256_R1(a, b, c, d, e, f, g, h, 40); SHA256_R1(h, a, b, c, d, e, f, g, 41); SHA256_R1(g, h, a, b, c, d, e, f, 42); SHA256_R1(f, g, h, a, b, c, d, e, 43);
+    SHA256_R1(e, f, g, h, a, b, c, d, 44); SHA256_R1(d, e, f, g, h, a, b, c, 45); SHA256_R1(c, d, e, f, g, h, a, b, 46); SHA256_R1(b, c, d, e, f, g, h, a, 47);
+    SHA256_R1(a, b, c, d, e, f, g, h, 48); SHA256_R1(h, a, b, c, d, e, f, g, 49); SHA256_R1(g, h, a, b, c, d, e, f, 50); SHA256_R1(f, g, h, a, b, c, d, e, 51);
+    SHA256_R1(e, f, g, h, a, b, c, d, 52); SHA256_R1(d, e, f, g, h, a, b, c, 53); SHA256_R1(c, d, e, f, g, h, a, b, 54); SHA256_R1(b, c, d, e, f, g, h, a, 55);
+    SHA256_R1(a, b, c, d, e, f, g, h, 56); SHA256_R1(h, a, b, c, d, e, f, g, 57); SHA256_R1(g, h, a, b, c, d, e, f, 58); SHA256_R1(f, g, h, a, b, c, d, e, 59);
+    SHA256_R1(e, f, g, h, a, b, c, d, 60); SHA256_R1(d, e, f, g, h, a, b, c, 61); SHA256_R1(c, d, e, f, g, h, a, b, 62); SHA256_R1(b, c, d, e, f, g, h, a, 63);
+    // clang-format on
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+    state[5] += f;
+    state[6] += g;
+    state[7] += h;
+}
+
+#undef SHA256_R1
+#undef SHA256_R0
+#undef SHA256_STEP
+#undef SHA256_W
+#undef SHA256_W0
+#undef SHA256_G1
+#undef SHA256_G0
+#undef SHA256_S1
+#undef SHA256_S0
+
+/** @brief Portable transform over consecutive blocks */
+static void sha256_transform_generic(uint32_t state[8], const uint8_t *data, size_t blocks) {
+    for (; blocks > 0; blocks--, data += 64)
+        sha256_transform_block(state, data);
+}
+
+#ifdef SHA256_HAS_SHANI
+/**
+ * @brief One group of 4 rounds with the SHA extensions
+ *
+ * sha256rnds2 does 2 rounds on the state split in ABEF and CDGH. Message
+ * words are kept in 4 rolling registers: while group g runs, W of group
+ * g + 1 is completed (sha256msg2) and W of group g + 3 is started
+ * (sha256msg1).
+ */
+#define SHA256_NI_GROUP(g)                                                                        \
+    do {                                                                                          \
+        if ((g) < 4)                                                                              \
+            msg[(g)] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(data + 16 * (g))), bswap); \
+        wk = _mm_add_epi32(msg[(g) & 3], _mm_loadu_si128((const __m128i *)&sha256_k[4 * (g)]));   \
+        cdgh = _mm_sha256rnds2_epu32(cdgh, abef, wk);                                             \
+        if ((g) >= 3 && (g) < 15) {                                                               \
+            tmp = _mm_alignr_epi8(msg[(g) & 3], msg[((g) + 3) & 3], 4);                           \
+            msg[((g) + 1) & 3] = _mm_sha256msg2_epu32(_mm_add_epi32(msg[((g) + 1) & 3], tmp),     \
+                                                      msg[(g) & 3]);                              \
+        }                                                                                         \
+        abef = _mm_sha256rnds2_epu32(abef, cdgh, _mm_shuffle_epi32(wk, 0x0E));                    \
+        if ((g) >= 1 && (g) < 13)                                                                 \
+            msg[((g) + 3) & 3] = _mm_sha256msg1_epu32(msg[((g) + 3) & 3], msg[(g) & 3]);          \
+    } while (0)
+
+/**
+ * @brief Transform with the x86 SHA extensions (sha256rnds2/sha256msg1/sha256msg2)
+ *
+ * Compiled for the sha and sse4.1 targets only, it must be called when
+ * sha256_cpu_has_shani() is true.
+ */
+__attribute__((target("sha,sse4.1"))) static void sha256_transform_shani(uint32_t state[8], const uint8_t *data,
+                                                                          size_t blocks) {
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bLL, 0x0405060700010203LL);
+    __m128i abef, cdgh, abef_save, cdgh_save, wk, tmp, msg[4];
+
+    // state words to the ABEF / CDGH layout of sha256rnds2
+    tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[0]), 0xB1);  // CDAB
+    cdgh = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&state[4]), 0x1B); // EFGH
+    abef = _mm_alignr_epi8(tmp, cdgh, 8);
+    cdgh = _mm_blend_epi16(cdgh, tmp, 0xF0);
+
+    for (; blocks > 0; blocks--, data += 64) {
+        abef_save = abef;
+        cdgh_save = cdgh;
+
+        SHA256_NI_GROUP(0);
+        SHA256_NI_GROUP(1);
+        SHA256_NI_GROUP(2);
+        SHA256_NI_GROUP(3);
+        SHA256_NI_GROUP(4);
+        SHA256_NI_GROUP(5);
+        SHA256_NI_GROUP(6);
+        SHA256_NI_GROUP(7);
+        SHA256_NI_GROUP(8);
+        SHA256_NI_GROUP(9);
+        SHA256_NI_GROUP(10);
+        SHA256_NI_GROUP(11);
+        SHA256_NI_GROUP(12);
+        SHA256_NI_GROUP(13);
+        SHA256_NI_GROUP(14);
+        SHA256_NI_GROUP(15);
+
+        abef = _mm_add_epi32(abef, abef_save);
+        cdgh = _mm_add_epi32(cdgh, cdgh_save);
+    }
+
+    // back to ABCD / EFGH
+    tmp = _mm_shuffle_epi32(abef, 0x1B);  // FEBA
+    cdgh = _mm_shuffle_epi32(cdgh, 0xB1); // DCHG
+    _mm_storeu_si128((__m128i *)&state[0], _mm_blend_epi16(tmp, cdgh, 0xF0));
+    _mm_storeu_si128((__m128i *)&state[4], _mm_alignr_epi8(cdgh, tmp, 8));
+}
+
+#undef SHA256_NI_GROUP
+
+/**
+ * @brief CPUID check of the SHA extensions (plus SSSE3 and SSE4.1 used around them)
+ */
+static bool sha256_cpu_has_shani(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    if (!(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1))
+        return false;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (ebx & bit_SHA) != 0;
+}
+#else
+static bool sha256_cpu_has_shani(void) {
+    return false;
+}
+#endif
+
+static Sha256Impl sha256_active_impl = SHA256_IMPL_GENERIC;
+static Sha256TransformFn sha256_transform = sha256_transform_generic;
+
+#ifdef __GNUC__
+/**
+ * @brief Pick the fastest transform before main (sha256mb.c relies on sha256_get_impl)
+ */
+__attribute__((constructor(101))) static void sha256_dispatch_init(void) {
+    sha256_set_impl(SHA256_IMPL_AUTO);
+}
+#endif
+
+/** @copydoc sha256_set_impl */
+bool sha256_set_impl(Sha256Impl impl) {
+    if (impl == SHA256_IMPL_AUTO)
+        impl = sha256_cpu_has_shani() ? SHA256_IMPL_SHANI : SHA256_IMPL_GENERIC;
+
+    switch (impl) {
+    case SHA256_IMPL_GENERIC:
+        sha256_transform = sha256_transform_generic;
+        break;
+#ifdef SHA256_HAS_SHANI
+    case SHA256_IMPL_SHANI:
+        if (!sha256_cpu_has_shani())
+            return false;
+        sha256_transform = sha256_transform_shani;
+        break;
+#endif
+    default:
+        return false;
+    }
+    sha256_active_impl = impl;
+    return true;
+}
+
+/** @copydoc sha256_get_impl */
+Sha256Impl sha256_get_impl(void) {
+    return sha256_active_impl;
+}
+
+/** @copydoc sha256_impl_name */
+const char *sha256_impl_name(Sha256Impl impl) {
+    switch (impl) {
+    case SHA256_IMPL_AUTO:
+        return "auto";
+    case SHA256_IMPL_GENERIC:
+        return "generic";
+    case SHA256_IMPL_SHANI:
+        return "sha-ni";
+    }
+    return "unknown";
+}
+
+/** @copydoc sha256_init */
+void sha256_init(SHA256_CTX *ctx) {
+    ctx->state[0] = 0x6a09e667;
+    ctx->state[1] = 0xbb67ae85;
+    ctx->state[2] = 0x3c6ef372;
+    ctx->state[3] = 0xa54ff53a;
+    ctx->state[4] = 0x510e527f;
+    ctx->state[5] = 0x9b05688c;
+    ctx->state[6] = 0x1f83d9ab;
+    ctx->state[7] = 0x5be0cd19;
+    ctx->count = 0;
+}
+
+/** @copydoc sha256_update */
+void sha256_update(SHA256_CTX *ctx, const uint8_t data[], size_t len) {
+    if (len == 0)
+        return;
+
+    size_t used = ctx->count & 63;
+    ctx->count += len;
+
+    if (used > 0) {
+        size_t take = 64 - used;
+        if (take > len) {
+            memcpy(&ctx->buffer[used], data, len);
+            return;
+        }
+        memcpy(&ctx->buffer[used], data, take);
+        sha256_transform(ctx->state, ctx->buffer, 1);
+        data += take;
+        len -= take;
+    }
+
+    // all the full blocks in one call, straight from the caller memory
+    size_t blocks = len / 64;
+    sha256_transform(ctx->state, data, blocks);
+    if (len % 64 > 0)
+        memcpy(ctx->buffer, data + blocks * 64, len % 64);
+}
+
+/** @copydoc sha256_final */
+void sha256_final(SHA256_CTX *ctx, uint8_t hash[]) {
+    uint64_t bits = ctx->count << 3;
+
+    // 0x80, zeros up to 56 mod 64, bit count: one or two blocks in place
+    size_t used = ctx->count & 63;
+    ctx->buffer[used++] = 0x80;
+    if (used > 56) {
+        memset(&ctx->buffer[used], 0, 64 - used);
+        sha256_transform(ctx->state, ctx->buffer, 1);
+        used = 0;
+    }
+    memset(&ctx->buffer[used], 0, 56 - used);
+    for (size_t ii = 0; ii < 8; ii++)
+        ctx->buffer[63 - ii] = (uint8_t)(bits >> (ii * 8));
+    sha256_transform(ctx->state, ctx->buffer, 1);
+
+    for (size_t ii = 0; ii < SHA256_LENGTH; ii++)
+        hash[ii] = (uint8_t)(ctx->state[ii >> 2] >> ((3 - (ii & 3)) * 8));
+}
+
+/** @copydoc sha256_clone */
+void sha256_clone(SHA256_CTX *dst, const SHA256_CTX *src) {
+    memcpy(dst, src, sizeof(SHA256_CTX));
+}
+
+/** @copydoc sha256 */
+bool sha256(const uint8_t *data, size_t len, uint8_t *hash) {
+    if ((data == NULL && len > 0) || hash == NULL) {
+        printf("Invalid parameters! data and hash output must be valid!\n");
+        return false;
+    }
+
+    SHA256_CTX ctx;
+    sha256_init(&ctx);
+    sha256_update(&ctx, data, len);
+    sha256_final(&ctx, hash);
+    return true;
+}
+
+/**
+ * @brief fileio_stream consumer
+ */
+static bool fsha256_chunk(void *ctx, const uint8_t *data, size_t len) {
+    sha256_update((SHA256_CTX *)ctx, data, len);
+    return true;
+}
+
+/** @copydoc fsha256 */
+bool fsha256(const char *filename, uint8_t *hash) {
+    return fsha256_io(filename, hash, FILEIO_AUTO);
+}
+
+/** @copydoc fsha256_io */
+bool fsha256_io(const char *filename, uint8_t *hash, FileIo io) {
+    if (filename == NULL || hash == NULL) {
+        printf("Invalid parameters! filename and hash output must be valid!\n");
+        return false;
+    }
+
+    SHA256_CTX ctx;
+    sha256_init(&ctx);
+    if (!fileio_stream(filename, io, fsha256_chunk, &ctx))
+        return false;
+    sha256_final(&ctx, hash);
+    return true;
+}
+
+/** @copydoc fhsha256 */
+bool fhsha256(Fhash *fh) {
+    if (fh == NULL || fh->filename == NULL) {
+        printf("Invalid parameters! filename and hash output must be valid!\n");
+        return false;
+    }
+    return fsha256(fh->filename, fh->hash);
+}
@@ -0,0 +1,149 @@
+/**
+ * @brief SHA-256 implementation
+ *
+ * Same API shape of sha1.h: one-shot, streaming (sha256_init,
+ * sha256_update, sha256_final) and file hashing. SHA-256 has no known
+ * practical collision, unlike SHA-1, at about twice the cost per byte in
+ * portable C.
+ *
+ * The block transform is selected at startup via CPUID: the x86 SHA
+ * extensions (sha256rnds2/sha256msg1/sha256msg2) when available, else
+ * portable C. For many files at once see sha256mb.h.
+ *
+ * @see FIPS 180-4
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef SHA256_H
+#define SHA256_H
+
+#include "fileio.h"
+#include "sha1.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHA256_LENGTH 32
+#define SHA256_LENGTH_CHAR 65 // 64 + \0
+
+/**
+ * SHA-256 block transform implementations
+ */
+typedef enum {
+    SHA256_IMPL_AUTO,    // fastest supported by the running CPU
+    SHA256_IMPL_GENERIC, // portable C
+    SHA256_IMPL_SHANI    // x86 SHA extensions (sha256rnds2/sha256msg1/sha256msg2)
+} Sha256Impl;
+
+/**
+ * Streaming context, to be initialized with sha256_init
+ */
+typedef struct
+{
+    uint32_t state[8];  // intermediate hash
+    uint64_t count;     // bytes hashed so far
+    uint8_t buffer[64]; // pending partial block
+} SHA256_CTX;
+
+/**
+ * @brief Computes the SHA-256 hash of the given data
+ *
+ * @param[in]  data  bytes (can be NULL only if len is 0)
+ * @param[in]  len   number of bytes
+ * @param[out] hash  32 bytes hash
+ * @returns true if the hash is calculated else false
+ *
+ * Example:
+ * @code
+ * uint8_t hash[SHA256_LENGTH];
+ * const char *message = "hello world";
+ * sha256((uint8_t*)message, strlen(message), hash);
+ * @endcode
+ */
+bool sha256(const uint8_t *data, size_t len, uint8_t *hash);
+
+/**
+ * @brief Start a new streaming hash
+ *
+ * @param[out] ctx context
+ */
+void sha256_init(SHA256_CTX *ctx);
+
+/**
+ * @brief Hash the next len bytes of the message
+ *
+ * Full blocks are hashed straight from the caller memory, only the last
+ * partial block is copied.
+ *
+ * @param[in,out] ctx context
+ * @param[in] data bytes (can be NULL only if len is 0)
+ * @param[in] len number of bytes, any size
+ */
+void sha256_update(SHA256_CTX *ctx, const uint8_t data[], size_t len);
+
+/**
+ * @brief Pad the message and write the hash
+ *
+ * The context is consumed: sha256_init it again before reusing it.
+ *
+ * @param[in,out] ctx context
+ * @param[out] hash 32 bytes hash
+ */
+void sha256_final(SHA256_CTX *ctx, uint8_t hash[]);
+
+/**
+ * @brief Copy a context (see sha1_clone)
+ *
+ * @param[out] dst destination context
+ * @param[in] src source context
+ */
+void sha256_clone(SHA256_CTX *dst, const SHA256_CTX *src);
+
+/**
+ * @brief Computes the SHA-256 hash of a given file
+ *
+ * @param[in] filename The filename
+ * @param[out] hash 32 bytes hash
+ * @returns true if the hash is calculated else false
+ */
+bool fsha256(const char *filename, uint8_t *hash);
+
+/**
+ * @brief Computes the SHA-256 hash of a given file with a given I/O strategy
+ *
+ * fsha256 is fsha256_io with FILEIO_AUTO (strategy by file size, see fileio.h)
+ *
+ * @param[in] filename The filename
+ * @param[out] hash 32 bytes hash
+ * @param[in] io I/O strategy
+ * @returns true if the hash is calculated else false
+ */
+bool fsha256_io(const char *filename, uint8_t *hash, FileIo io);
+
+/**
+ * @brief wrap of fsha256 using Fhash struct
+ */
+bool fhsha256(Fhash *fh);
+
+/**
+ * @brief Select the block transform
+ *
+ * The fastest implementation is selected at startup via CPUID, this is
+ * needed only to force one (benchmarks, cross checks).
+ * Not thread safe: call it before hashing from multiple threads.
+ *
+ * @param[in] impl implementation, SHA256_IMPL_AUTO to redo the CPU detection
+ * @returns true if selected, false if not supported by this CPU or build
+ */
+bool sha256_set_impl(Sha256Impl impl);
+
+/**
+ * @brief Active block transform (never SHA256_IMPL_AUTO)
+ */
+Sha256Impl sha256_get_impl(void);
+
+/**
+ * @brief Implementation name, e.g. "sha-ni"
+ */
+const char *sha256_impl_name(Sha256Impl impl);
+
+#endif // SHA256_H
@@ -0,0 +1,200 @@
+#include "sha256mb.h"
+#include "mbsched.h"
+#include <stdio.h>
+#include <string.h>
+
+typedef uint32_t Sha256MbV4 __attribute__((vector_size(16)));
+typedef uint32_t Sha256MbV8 __attribute__((vector_size(32)));
+typedef uint32_t Sha256MbV16 __attribute__((vector_size(64)));
+
+/**
+ * @brief Round constants (FIPS 180-4, same of sha256.c)
+ */
+static const uint32_t sha256_mb_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+#define SHA256_MB_ROR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/**
+ * @brief One round on all lanes, with the 16 words rolling schedule
+ */
+#define SHA256_MB_ROUND(i)                                                                         \
+    do {                                                                                           \
+        if ((i) >= 16) {                                                                           \
+            V w2 = w[((i) - 2) & 15], w15 = w[((i) - 15) & 15];                                    \
+            w[(i) & 15] += (SHA256_MB_ROR(w2, 17) ^ SHA256_MB_ROR(w2, 19) ^ (w2 >> 10)) +          \
+                           w[((i) - 7) & 15] +                                                     \
+                           (SHA256_MB_ROR(w15, 7) ^ SHA256_MB_ROR(w15, 18) ^ (w15 >> 3));          \
+        }                                                                                          \
+        t1 = h + (SHA256_MB_ROR(e, 6) ^ SHA256_MB_ROR(e, 11) ^ SHA256_MB_ROR(e, 25)) +             \
+             (g ^ (e & (f ^ g))) + sha256_mb_k[(i)] + w[(i) & 15];                                 \
+        t2 = (SHA256_MB_ROR(a, 2) ^ SHA256_MB_ROR(a, 13) ^ SHA256_MB_ROR(a, 22)) +                 \
+             ((a & b) | (c & (a | b)));                                                            \
+        h = g;                                                                                     \
+        g = f;                                                                                     \
+        f = e;                                                                                     \
+        e = d + t1;                                                                                \
+        d = c;                                                                                     \
+        c = b;                                                                                     \
+        b = a;                                                                                     \
+        a = t1 + t2;                                                                               \
+    } while (0)
+
+/**
+ * @brief Define a lanes transform for the vector type V of L lanes
+ *
+ * The same C code is compiled once per width, ATTR enables the instruction
+ * set of the width.
+ */
+#define SHA256_MB_DEFINE_TRANSFORM(name, VT, L, ATTR)                                            \
+    ATTR static void name(uint32_t *state, const uint8_t *const data[], size_t blocks) {         \
+        typedef VT V;                                                                            \
+        V s[8], a, b, c, d, e, f, g, h, t1, t2, w[16];                                           \
+        memcpy(s, state, sizeof(s));                                                             \
+        for (size_t blk = 0; blk < blocks; blk++) {                                              \
+            a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];      \
+            /* transpose: word i of every lane in w[i] */                                       \
+            for (int i = 0; i < 16; i++) {                                                       \
+                for (int l = 0; l < (L); l++) {                                                  \
+                    uint32_t word;                                                               \
+                    memcpy(&word, data[l] + blk * 64 + 4 * i, sizeof(word));                     \
+                    w[i][l] = __builtin_bswap32(word);                                           \
+                }                                                                                \
+            }                                                                                    \
+            for (int i = 0; i < 64; i++)                                                         \
+                SHA256_MB_ROUND(i);                                                              \
+            s[0] += a;                                                                           \
+            s[1] += b;                                                                           \
+            s[2] += c;                                                                           \
+            s[3] += d;                                                                           \
+            s[4] += e;                                                                           \
+            s[5] += f;                                                                           \
+            s[6] += g;                                                                           \
+            s[7] += h;                                                                           \
+        }                                                                                        \
+        memcpy(state, s, sizeof(s));                                                             \
+    }
+
+SHA256_MB_DEFINE_TRANSFORM(sha256_mb_transform_vec4, Sha256MbV4, 4, )
+#ifdef MB_HAS_X86
+SHA256_MB_DEFINE_TRANSFORM(sha256_mb_transform_avx2, Sha256MbV8, 8, __attribute__((target("avx2"))))
+SHA256_MB_DEFINE_TRANSFORM(sha256_mb_transform_avx512, Sha256MbV16, 16, __attribute__((target("avx512f"))))
+#endif
+
+#undef SHA256_MB_DEFINE_TRANSFORM
+#undef SHA256_MB_ROUND
+
+/**
+ * @brief Lanes transform of every engine, NULL for SHA256_MB_SERIAL
+ */
+static const MbTransformFn sha256_mb_transforms[SHA256_MB_AVX512 + 1] = {
+    [SHA256_MB_VEC4] = sha256_mb_transform_vec4,
+#ifdef MB_HAS_X86
+    [SHA256_MB_AVX2] = sha256_mb_transform_avx2,
+    [SHA256_MB_AVX512] = sha256_mb_transform_avx512,
+#endif
+};
+
+static Sha256MbImpl sha256_mb_active_impl = SHA256_MB_VEC4;
+static MbTransformFn sha256_mb_transform = sha256_mb_transform_vec4;
+static size_t sha256_mb_active_lanes = 4;
+
+#ifdef __GNUC__
+/**
+ * @brief Pick the fastest engine before main
+ */
+__attribute__((constructor)) static void sha256_mb_dispatch_init(void) {
+    sha256_mb_set_impl(SHA256_MB_AUTO);
+}
+#endif
+
+/** @copydoc sha256_mb_set_impl */
+bool sha256_mb_set_impl(Sha256MbImpl impl) {
+    MbImpl selected;
+    if (!mb_select_impl((MbImpl)impl, sha256_get_impl() == SHA256_IMPL_SHANI, &selected))
+        return false;
+    sha256_mb_transform = sha256_mb_transforms[selected];
+    sha256_mb_active_lanes = mb_impl_lanes(selected);
+    sha256_mb_active_impl = (Sha256MbImpl)selected;
+    return true;
+}
+
+/** @copydoc sha256_mb_get_impl */
+Sha256MbImpl sha256_mb_get_impl(void) {
+    return sha256_mb_active_impl;
+}
+
+/** @copydoc sha256_mb_impl_name */
+const char *sha256_mb_impl_name(Sha256MbImpl impl) {
+    return mb_impl_name((MbImpl)impl);
+}
+
+/** @copydoc sha256_mb_lanes */
+size_t sha256_mb_lanes(void) {
+    return sha256_mb_active_lanes;
+}
+
+/**
+ * @brief Active engine as seen by the lane scheduler
+ */
+static MbEngine sha256_mb_engine(void) {
+    static const uint32_t init[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                                     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+    MbEngine engine = {"sha256_mb", sha256_mb_transform, sha256_mb_active_lanes, 8, init, fhsha256};
+    return engine;
+}
+
+/** @copydoc sha256_mb */
+bool sha256_mb(const uint8_t *const data[], const size_t lens[], size_t count, uint8_t hashes[][SHA256_LENGTH]) {
+    if ((data == NULL || lens == NULL || hashes == NULL) && count > 0) {
+        fprintf(stderr, "[sha256_mb] Invalid parameters\n");
+        return false;
+    }
+    for (size_t ii = 0; ii < count; ii++) {
+        if (data[ii] == NULL && lens[ii] > 0) {
+            fprintf(stderr, "[sha256_mb] Invalid parameters\n");
+            return false;
+        }
+    }
+
+    if (sha256_mb_transform == NULL) {
+        // SHA256_MB_SERIAL
+        for (size_t ii = 0; ii < count; ii++) {
+            SHA256_CTX ctx;
+            sha256_init(&ctx);
+            sha256_update(&ctx, data[ii], lens[ii]);
+            sha256_final(&ctx, hashes[ii]);
+        }
+        return true;
+    }
+
+    MbEngine engine = sha256_mb_engine();
+    return mb_hash_memory(&engine, data, lens, count, (uint8_t *)hashes);
+}
+
+/** @copydoc fhsha256_mb */
+size_t fhsha256_mb(Fhash *fhs, size_t count, bool ok[]) {
+    if (fhs == NULL || count == 0)
+        return 0;
+
+    if (sha256_mb_transform == NULL) {
+        size_t hashed = 0;
+        for (size_t ii = 0; ii < count; ii++) {
+            bool res = fhsha256(&fhs[ii]);
+            if (ok != NULL)
+                ok[ii] = res;
+            hashed += res;
+        }
+        return hashed;
+    }
+
+    MbEngine engine = sha256_mb_engine();
+    return mb_hash_files(&engine, fhs, count, ok);
+}
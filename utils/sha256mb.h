@@ -0,0 +1,86 @@
+/**
+ * @brief Multi-buffer SHA-256
+ *
+ * Same scheme of sha1mb.h: every vector lane carries one message, 4 lanes
+ * with 128-bit vectors (any CPU, GCC vector extensions), 8 lanes with AVX2
+ * and 16 lanes with AVX-512, run by the lane scheduler of mbsched.h.
+ *
+ * Meant for many small files. With one big message only one lane works:
+ * use sha256/fsha256 instead. fhsha256_mb does it on its own for the files
+ * from MB_SERIAL_MIN bytes.
+ *
+ * The engine is selected at startup via CPUID. On CPUs with the SHA
+ * extensions but without AVX-512 the serial SHA-NI transform is faster than
+ * 8 lanes, so SHA256_MB_SERIAL (one message at a time through sha256.h) is
+ * used.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef SHA256MB_H
+#define SHA256MB_H
+
+#include "mbsched.h"
+#include "sha256.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    SHA256_MB_AUTO = MB_IMPL_AUTO,     // fastest supported by the running CPU
+    SHA256_MB_SERIAL = MB_IMPL_SERIAL, // one message at a time (sha256.h transform)
+    SHA256_MB_VEC4 = MB_IMPL_VEC4,     // 4 lanes, portable vector extensions (SSE2/NEON)
+    SHA256_MB_AVX2 = MB_IMPL_AVX2,     // 8 lanes
+    SHA256_MB_AVX512 = MB_IMPL_AVX512  // 16 lanes
+} Sha256MbImpl;
+
+/**
+ * @brief Select the engine
+ *
+ * Not thread safe: call it before hashing from multiple threads.
+ *
+ * @param[in] impl engine, SHA256_MB_AUTO to redo the CPU detection
+ * @returns true if selected, false if not supported by this CPU or build
+ */
+bool sha256_mb_set_impl(Sha256MbImpl impl);
+
+/**
+ * @brief Active engine (never SHA256_MB_AUTO)
+ */
+Sha256MbImpl sha256_mb_get_impl(void);
+
+/**
+ * @brief Engine name, e.g. "avx2"
+ */
+const char *sha256_mb_impl_name(Sha256MbImpl impl);
+
+/**
+ * @brief Number of lanes of the active engine (1 for SHA256_MB_SERIAL)
+ */
+size_t sha256_mb_lanes(void);
+
+/**
+ * @brief Computes the SHA-256 of count in-memory messages
+ *
+ * @param[in] data messages, data[ii] can be NULL only if lens[ii] is 0
+ * @param[in] lens message lengths in bytes
+ * @param[in] count number of messages
+ * @param[out] hashes one 32-byte hash per message
+ * @returns true if the hashes are calculated else false
+ */
+bool sha256_mb(const uint8_t *const data[], const size_t lens[], size_t count, uint8_t hashes[][SHA256_LENGTH]);
+
+/**
+ * @brief Computes the SHA-256 of many files, like fhsha256 on each of them
+ *
+ * Files that cannot be hashed (not regular, cannot be opened or read) keep
+ * their hash untouched. Files from MB_SERIAL_MIN bytes are hashed with
+ * fhsha256, the SHA-NI transform when available, instead of a single lane.
+ *
+ * @param[in,out] fhs files, hash is written for every hashed file
+ * @param[in] count number of files
+ * @param[out] ok per file result (can be NULL)
+ * @returns number of files hashed
+ */
+size_t fhsha256_mb(Fhash *fhs, size_t count, bool ok[]);
+
+#endif // SHA256MB_H
@@ -0,0 +1,374 @@
+#include "skiplist.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * Allocate a node with the given number of levels
+ * @param[in] elem Numeric value to store
+ * @param[in] level Number of forward links
+ * @returns Pointer to newly allocated SkipNode, or NULL on allocation failure
+ */
+static SkipNode *skl_create_node(size_t elem, size_t level) {
+    SkipNode *node = malloc(sizeof(SkipNode) + level * sizeof(SkipLink));
+    if (node == NULL) {
+        perror("[skl_create_node] Cannot create a new node");
+        return NULL;
+    }
+    node->elem = elem;
+    node->prev = NULL;
+    node->level = level;
+    for (size_t ii = 0; ii < level; ii++) {
+        node->links[ii].next = NULL;
+        node->links[ii].span = 0;
+    }
+    return node;
+}
+
+/**
+ * Random level for a new node: level l+1 with probability 1/4^l
+ * @param[in] list A valid (non-NULL) SkipList pointer
+ * @returns level in range [1, SKL_MAX_LEVEL]
+ */
+static size_t skl_random_level(SkipList *list) {
+    // xorshift64
+    uint64_t x = list->seed;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    list->seed = x;
+
+    // every pair of bits set to 00 adds a level (p = 1/4)
+    size_t level = 1;
+    while (level < SKL_MAX_LEVEL && (x & 3) == 0) {
+        level++;
+        x >>= 2;
+    }
+    return level;
+}
+
+/** @copydoc skl_create */
+SkipList *skl_create(void) {
+    SkipList *list = malloc(sizeof(SkipList));
+    if (list == NULL) {
+        perror("[skl_create] Cannot create a new skip list");
+        return NULL;
+    }
+
+    list->head = skl_create_node(0, SKL_MAX_LEVEL);
+    if (list->head == NULL) {
+        free(list);
+        return NULL;
+    }
+    list->tail = NULL;
+    list->size = 0;
+    list->level = 1;
+    list->seed = 0x9e3779b97f4a7c15ULL;
+    return list;
+}
+
+/** @copydoc skl_destroy */
+void skl_destroy(SkipList *list) {
+    if (list == NULL)
+        return;
+
+    SkipNode *cur = list->head;
+    while (cur != NULL) {
+        SkipNode *next = cur->links[0].next;
+        free(cur);
+        cur = next;
+    }
+    free(list);
+}
+
+/**
+ * Link a new node after update[l] at every level
+ * @param[in] list A valid (non-NULL) SkipList pointer
+ * @param[in] elem Numeric value to insert
+ * @param[in] update Rightmost node before the insertion point, per level
+ * @param[in] rank Position (number of nodes passed) of update[l], per level.
+ *                 rank[0] is the index of the new node
+ * @returns Pointer to newly created node, or NULL on failure
+ */
+static SkipNode *skl_insert_at(SkipList *list, size_t elem, SkipNode **update, size_t *rank) {
+    size_t level = skl_random_level(list);
+    if (level > list->level) {
+        // new levels start from the head and span the whole list
+        for (size_t ll = list->level; ll < level; ll++) {
+            rank[ll] = 0;
+            update[ll] = list->head;
+            update[ll]->links[ll].span = list->size;
+        }
+        list->level = level;
+    }
+
+    SkipNode *node = skl_create_node(elem, level);
+    if (node == NULL)
+        return NULL;
+
+    for (size_t ll = 0; ll < level; ll++) {
+        node->links[ll].next = update[ll]->links[ll].next;
+        update[ll]->links[ll].next = node;
+
+        // split the span of the previous link around the new node
+        node->links[ll].span = update[ll]->links[ll].span - (rank[0] - rank[ll]);
+        update[ll]->links[ll].span = (rank[0] - rank[ll]) + 1;
+    }
+
+    // levels above the new node now jump over one more node
+    for (size_t ll = level; ll < list->level; ll++)
+        update[ll]->links[ll].span++;
+
+    node->prev = update[0] == list->head ? NULL : update[0];
+    if (node->links[0].next != NULL)
+        node->links[0].next->prev = node;
+    else
+        list->tail = node;
+
+    list->size++;
+    return node;
+}
+
+/**
+ * Unlink a node and free its memory
+ * @param[in] list A valid (non-NULL) SkipList pointer
+ * @param[in] node Node to remove
+ * @param[in] update Rightmost node before node, per level
+ */
+static void skl_delete_node(SkipList *list, SkipNode *node, SkipNode **update) {
+    for (size_t ll = 0; ll < list->level; ll++) {
+        if (update[ll]->links[ll].next == node) {
+            update[ll]->links[ll].span += node->links[ll].span - 1;
+            update[ll]->links[ll].next = node->links[ll].next;
+        } else {
+            update[ll]->links[ll].span--;
+        }
+    }
+
+    if (node->links[0].next != NULL)
+        node->links[0].next->prev = node->prev;
+    else
+        list->tail = node->prev;
+
+    // drop empty top levels
+    while (list->level > 1 && list->head->links[list->level - 1].next == NULL)
+        list->level--;
+
+    free(node);
+    list->size--;
+}
+
+/**
+ * Collect, for every level, the rightmost node having less than idx nodes before it
+ * @param[in] list A valid (non-NULL) SkipList pointer
+ * @param[in] idx Zero-based position
+ * @param[out] update Rightmost node before position idx, per level
+ * @param[out] rank Position of update[l], per level
+ */
+static void skl_find_idx(const SkipList *list, size_t idx, SkipNode **update, size_t *rank) {
+    SkipNode *cur = list->head;
+    size_t traversed = 0;
+    for (size_t ll = list->level; ll > 0; ll--) {
+        while (cur->links[ll - 1].next != NULL && traversed + cur->links[ll - 1].span <= idx) {
+            traversed += cur->links[ll - 1].span;
+            cur = cur->links[ll - 1].next;
+        }
+        update[ll - 1] = cur;
+        rank[ll - 1] = traversed;
+    }
+}
+
+/**
+ * Collect, for every level, the rightmost node whose value is lower than elem
+ * (or lower or equal when inclusive is 1)
+ * @param[in] list A valid (non-NULL) SkipList pointer
+ * @param[in] elem Numeric value
+ * @param[in] inclusive 1 to pass over equal values too
+ * @param[out] update Rightmost node before the value, per level
+ * @param[out] rank Position of update[l], per level
+ */
+static void skl_find_elem(const SkipList *list, size_t elem, int inclusive, SkipNode **update, size_t *rank) {
+    SkipNode *cur = list->head;
+    size_t traversed = 0;
+    for (size_t ll = list->level; ll > 0; ll--) {
+        SkipNode *next = cur->links[ll - 1].next;
+        while (next != NULL && (next->elem < elem || (inclusive && next->elem == elem))) {
+            traversed += cur->links[ll - 1].span;
+            cur = next;
+            next = cur->links[ll - 1].next;
+        }
+        update[ll - 1] = cur;
+        rank[ll - 1] = traversed;
+    }
+}
+
+/** @copydoc skl_get */
+SkipNode *skl_get(const SkipList *list, size_t idx) {
+    if (list == NULL || list->size <= idx) {
+        fprintf(stderr, "[skl_get] Index %zu not valid because size is %zu\n", idx, list ? list->size : 0);
+        return NULL;
+    }
+
+    // walk until exactly idx + 1 nodes have been passed
+    SkipNode *cur = list->head;
+    size_t traversed = 0;
+    for (size_t ll = list->level; ll > 0; ll--) {
+        while (cur->links[ll - 1].next != NULL && traversed + cur->links[ll - 1].span <= idx + 1) {
+            traversed += cur->links[ll - 1].span;
+            cur = cur->links[ll - 1].next;
+        }
+        if (traversed == idx + 1)
+            return cur;
+    }
+    return NULL;
+}
+
+/** @copydoc skl_add */
+SkipNode *skl_add(SkipList *list, size_t elem, size_t idx) {
+    if (list == NULL || idx > list->size) {
+        fprintf(stderr, "[skl_add] Index %zu out of bounds (size: %zu)\n", idx, list ? list->size : 0);
+        return NULL;
+    }
+
+    SkipNode *update[SKL_MAX_LEVEL];
+    size_t rank[SKL_MAX_LEVEL];
+    skl_find_idx(list, idx, update, rank);
+    return skl_insert_at(list, elem, update, rank);
+}
+
+/** @copydoc skl_remove */
+int skl_remove(SkipList *list, size_t idx) {
+    if (list == NULL || idx >= list->size) {
+        fprintf(stderr, "[skl_remove] Index %zu not valid because size is %zu\n", idx, list ? list->size : 0);
+        return 0;
+    }
+
+    SkipNode *update[SKL_MAX_LEVEL];
+    size_t rank[SKL_MAX_LEVEL];
+    skl_find_idx(list, idx, update, rank);
+    skl_delete_node(list, update[0]->links[0].next, update);
+    return 1;
+}
+
+/** @copydoc skl_insert_sorted */
+SkipNode *skl_insert_sorted(SkipList *list, size_t elem, size_t *res_idx) {
+    if (list == NULL) {
+        fprintf(stderr, "[skl_insert_sorted] List is NULL\n");
+        return NULL;
+    }
+
+    SkipNode *update[SKL_MAX_LEVEL];
+    size_t rank[SKL_MAX_LEVEL];
+    skl_find_elem(list, elem, 1, update, rank);
+    if (res_idx != NULL)
+        *res_idx = rank[0];
+    return skl_insert_at(list, elem, update, rank);
+}
+
+/** @copydoc skl_lower_bound */
+size_t skl_lower_bound(const SkipList *list, size_t elem) {
+    if (list == NULL)
+        return 0;
+
+    SkipNode *update[SKL_MAX_LEVEL];
+    size_t rank[SKL_MAX_LEVEL];
+    skl_find_elem(list, elem, 0, update, rank);
+    return rank[0];
+}
+
+/** @copydoc skl_find */
+int skl_find(const SkipList *list, size_t elem, size_t *res_idx) {
+    if (list == NULL)
+        return 0;
+
+    SkipNode *update[SKL_MAX_LEVEL];
+    size_t rank[SKL_MAX_LEVEL];
+    skl_find_elem(list, elem, 0, update, rank);
+
+    SkipNode *found = update[0]->links[0].next;
+    if (found == NULL || found->elem != elem)
+        return 0;
+    if (res_idx != NULL)
+        *res_idx = rank[0];
+    return 1;
+}
+
+/** @copydoc skl_remove_value */
+int skl_remove_value(SkipList *list, size_t elem) {
+    if (list == NULL)
+        return 0;
+
+    SkipNode *update[SKL_MAX_LEVEL];
+    size_t rank[SKL_MAX_LEVEL];
+    skl_find_elem(list, elem, 0, update, rank);
+
+    SkipNode *found = update[0]->links[0].next;
+    if (found == NULL || found->elem != elem)
+        return 0;
+    skl_delete_node(list, found, update);
+    return 1;
+}
+
+/** @copydoc skl_print */
+void skl_print(const SkipList *list) {
+    if (list == NULL) {
+        fprintf(stderr, "[skl_print] (empty list)\n");
+        return;
+    }
+
+    for (SkipNode *cur = list->head->links[0].next; cur != NULL; cur = cur->links[0].next)
+        printf("%zu ", cur->elem);
+    printf("\n");
+}
+
+/** @copydoc skl_print_reverse */
+void skl_print_reverse(const SkipList *list) {
+    if (list == NULL) {
+        fprintf(stderr, "[skl_print_reverse] (empty list)\n");
+        return;
+    }
+
+    for (SkipNode *cur = list->tail; cur != NULL; cur = cur->prev)
+        printf("%zu ", cur->elem);
+    printf("\n");
+}
+
+/** @copydoc skl_is_empty */
+int skl_is_empty(const SkipList *list) {
+    return (list == NULL || list->size == 0) ? 1 : 0;
+}
+
+/** @copydoc skl_get_size */
+size_t skl_get_size(const SkipList *list) {
+    return list == NULL ? 0 : list->size;
+}
+
+/** @copydoc skl_append */
+SkipNode *skl_append(SkipList *list, size_t elem) {
+    return skl_add(list, elem, list->size);
+}
+
+/** @copydoc skl_prepend */
+SkipNode *skl_prepend(SkipList *list, size_t elem) {
+    return skl_add(list, elem, 0);
+}
+
+/** @copydoc skl_pop */
+int skl_pop(SkipList *list, size_t *res) {
+    if (skl_is_empty(list)) {
+        fprintf(stderr, "[skl_pop] Cannot get element\n");
+        return 0;
+    }
+    *res = list->tail->elem;
+    return skl_remove(list, list->size - 1);
+}
+
+/** @copydoc skl_get_value */
+int skl_get_value(SkipList *list, size_t idx, size_t *res) {
+    SkipNode *node = skl_get(list, idx);
+    if (node == NULL) {
+        fprintf(stderr, "[skl_get_value] Cannot get element\n");
+        return 0;
+    }
+    *res = node->elem;
+    return 1;
+}
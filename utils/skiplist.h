@@ -0,0 +1,197 @@
+/**
+ * @brief Indexable skip list implementation
+ *
+ * Numeric sequence of size_t values stored in a skip list where every forward
+ * link also records its span (how many level 0 hops it jumps over). Summing
+ * spans while descending the levels gives the position of a node, so all the
+ * positional operations are O(log n) on average instead of the O(n) walk of
+ * LList/NLList:
+ * - skl_get / skl_add / skl_remove by index
+ *
+ * When the sequence is kept sorted (only skl_insert_sorted is used to add
+ * values) the same structure works as an ordered set with ranks:
+ * - skl_insert_sorted, skl_lower_bound, skl_find, skl_remove_value
+ *
+ * Node levels are chosen randomly (p = 1/4) with a per-list xorshift
+ * generator, so a given sequence of operations always builds the same list.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef SKIPLIST_H
+#define SKIPLIST_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define SKL_MAX_LEVEL 32 // enough for 4^32 elements with p = 1/4
+
+struct sklnode;
+
+/**
+ * Forward link of a node at one level
+ */
+typedef struct
+{
+    struct sklnode *next; // Next node at this level (NULL at the end)
+    size_t span;          // Level 0 hops covered by this link
+} SkipLink;
+
+/**
+ * Skip list node. The links array has one entry per level of the node
+ */
+typedef struct sklnode {
+    size_t elem;           // Numeric element value
+    struct sklnode *prev;  // Previous node at level 0 (NULL for the first node)
+    size_t level;          // Number of levels (links) of this node
+    SkipLink links[];      // Forward links, links[0] is the plain linked list
+} SkipNode;
+
+/**
+ * Skip list structure
+ */
+typedef struct
+{
+    SkipNode *head; // Sentinel node with SKL_MAX_LEVEL links (holds no value)
+    SkipNode *tail; // Pointer to last node (NULL if empty)
+    size_t size;    // Number of elements in the list
+    size_t level;   // Highest level currently in use (>= 1)
+    uint64_t seed;  // Random generator state for node levels
+} SkipList;
+
+/**
+ * Create and initialize a new skip list
+ * @returns Pointer to new SkipList, or NULL on allocation failure
+ */
+SkipList *skl_create(void);
+
+/**
+ * Deallocate skip list and all nodes
+ * @param[in] list Pointer to the list to destroy (can be NULL)
+ */
+void skl_destroy(SkipList *list);
+
+/**
+ * Get node at specified index
+ * @param[in] list Pointer to the list
+ * @param[in] idx Zero-based index
+ * @returns Pointer to node if found, NULL if index out of bounds
+ * @note O(log n) on average
+ */
+SkipNode *skl_get(const SkipList *list, size_t idx);
+
+/**
+ * Insert element at specified index
+ * @param[in] list Pointer to the list
+ * @param[in] elem Numeric value to insert
+ * @param[in] idx Zero-based index (0 = prepend, size = append)
+ * @returns Pointer to newly created node, or NULL on failure
+ * @note idx must be in range [0, size]. O(log n) on average
+ */
+SkipNode *skl_add(SkipList *list, size_t elem, size_t idx);
+
+/**
+ * Remove element at specified index
+ * @param[in] list Pointer to the list
+ * @param[in] idx Zero-based index
+ * @returns 0 in case of error , 1 OK
+ * @note O(log n) on average
+ */
+int skl_remove(SkipList *list, size_t idx);
+
+/**
+ * Insert element keeping the sequence sorted (ascending)
+ * Equal values are inserted after the existing ones
+ * @param[in] list Pointer to a sorted list
+ * @param[in] elem Numeric value to insert
+ * @param[out] res_idx Index where the value has been inserted (can be NULL)
+ * @returns Pointer to newly created node, or NULL on failure
+ */
+SkipNode *skl_insert_sorted(SkipList *list, size_t elem, size_t *res_idx);
+
+/**
+ * Index of the first element greater or equal than elem
+ * @param[in] list Pointer to a sorted list
+ * @param[in] elem Numeric value to search
+ * @returns Index in range [0, size], size if every element is lower
+ */
+size_t skl_lower_bound(const SkipList *list, size_t elem);
+
+/**
+ * Search an element in a sorted list
+ * @param[in] list Pointer to a sorted list
+ * @param[in] elem Numeric value to search
+ * @param[out] res_idx Index (rank) of the first occurrence (can be NULL)
+ * @returns 1 if found, 0 otherwise
+ */
+int skl_find(const SkipList *list, size_t elem, size_t *res_idx);
+
+/**
+ * Remove the first occurrence of an element from a sorted list
+ * @param[in] list Pointer to a sorted list
+ * @param[in] elem Numeric value to remove
+ * @returns 1 if removed, 0 if not found
+ */
+int skl_remove_value(SkipList *list, size_t elem);
+
+/**
+ * Print list from head to tail
+ * @param[in] list Pointer to the list
+ * @note Prints to stdout with space-separated values
+ */
+void skl_print(const SkipList *list);
+
+/**
+ * Print list from tail to head
+ * @param[in] list Pointer to the list
+ * @note Prints to stdout with space-separated values
+ */
+void skl_print_reverse(const SkipList *list);
+
+/**
+ * Check if list is empty
+ * @param[in] list Pointer to the list
+ * @returns 1 if is empty or 0 otherwise
+ */
+int skl_is_empty(const SkipList *list);
+
+/**
+ * Get size of list
+ * @param[in] list Pointer to the list
+ * @returns Number of elements in list, 0 if NULL
+ */
+size_t skl_get_size(const SkipList *list);
+
+/**
+ * Insert element at the end
+ * @param[in] list Pointer to the list
+ * @param[in] elem Numeric value to insert
+ * @returns Pointer to newly created node, or NULL on failure
+ */
+SkipNode *skl_append(SkipList *list, size_t elem);
+
+/**
+ * Insert element at the beginning
+ * @param[in] list Pointer to the list
+ * @param[in] elem Numeric value to insert
+ * @returns Pointer to newly created node, or NULL on failure
+ */
+SkipNode *skl_prepend(SkipList *list, size_t elem);
+
+/**
+ * Pop last element from the list
+ * @param[in] list Pointer to the list
+ * @param[out] res The popped element
+ * @returns 0 in case of error, 1 ok
+ */
+int skl_pop(SkipList *list, size_t *res);
+
+/**
+ * Get an element from the list given the index
+ * @param[in] list Pointer to the list
+ * @param[in] idx Index
+ * @param[out] res The retrived
+ * @returns 1 ok, 0 error
+ */
+int skl_get_value(SkipList *list, size_t idx, size_t *res);
+
+#endif // SKIPLIST_H
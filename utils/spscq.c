@@ -0,0 +1,85 @@
+#include "spscq.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/** @copydoc spscq_create */
+SpscQueue *spscq_create(size_t capacity) {
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0) {
+        fprintf(stderr, "[spscq_create] Invalid capacity\n");
+        return NULL;
+    }
+
+    // the struct is cache line aligned, malloc does not guarantee it
+    size_t size = (sizeof(SpscQueue) + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    SpscQueue *queue = aligned_alloc(CACHE_LINE_SIZE, size);
+    if (queue == NULL) {
+        perror("[spscq_create] Cannot create a new queue");
+        return NULL;
+    }
+
+    queue->slots = malloc(sizeof(void *) * capacity);
+    if (queue->slots == NULL) {
+        perror("[spscq_create] Cannot create a new queue");
+        free(queue);
+        return NULL;
+    }
+
+    atomic_init(&queue->head, 0);
+    atomic_init(&queue->tail, 0);
+    queue->cached_head = 0;
+    queue->cached_tail = 0;
+    queue->capacity = capacity;
+    queue->mask = capacity - 1;
+    return queue;
+}
+
+/** @copydoc spscq_destroy */
+void spscq_destroy(SpscQueue *queue) {
+    if (queue == NULL)
+        return;
+    free(queue->slots);
+    free(queue);
+}
+
+/** @copydoc spscq_push */
+int spscq_push(SpscQueue *queue, void *elem) {
+    // only the producer writes tail: relaxed load is enough
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_relaxed);
+
+    if (tail - queue->cached_head == queue->capacity) {
+        // looks full: refresh the copy of the consumer index
+        queue->cached_head = atomic_load_explicit(&queue->head, memory_order_acquire);
+        if (tail - queue->cached_head == queue->capacity)
+            return 0;
+    }
+
+    queue->slots[tail & queue->mask] = elem;
+    // publish the slot content together with the new tail
+    atomic_store_explicit(&queue->tail, tail + 1, memory_order_release);
+    return 1;
+}
+
+/** @copydoc spscq_pop */
+int spscq_pop(SpscQueue *queue, void **res) {
+    // only the consumer writes head: relaxed load is enough
+    size_t head = atomic_load_explicit(&queue->head, memory_order_relaxed);
+
+    if (head == queue->cached_tail) {
+        // looks empty: refresh the copy of the producer index
+        queue->cached_tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+        if (head == queue->cached_tail)
+            return 0;
+    }
+
+    *res = queue->slots[head & queue->mask];
+    // give the slot back to the producer
+    atomic_store_explicit(&queue->head, head + 1, memory_order_release);
+    return 1;
+}
+
+/** @copydoc spscq_size */
+size_t spscq_size(SpscQueue *queue) {
+    size_t tail = atomic_load_explicit(&queue->tail, memory_order_acquire);
+    size_t head = atomic_load_explicit(&queue->head, memory_order_acquire);
+    return tail - head;
+}
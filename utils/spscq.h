@@ -0,0 +1,92 @@
+/**
+ * @brief Bounded single-producer single-consumer lock-free queue
+ *
+ * Ring buffer of void* slots shared by exactly one producer thread and one
+ * consumer thread. Push and pop are wait-free: no lock, no CAS, only an
+ * acquire load and a release store on the index owned by the other side.
+ *
+ * The producer index (tail) and the consumer index (head) live on separate
+ * cache lines, each next to a private cached copy of the other index, so the
+ * two threads only exchange a cache line when the cached copy is stale
+ * (queue looks full or empty) instead of on every operation.
+ *
+ * Requires C11 atomics: compile with -std=c11 (or later).
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef SPSCQ_H
+#define SPSCQ_H
+
+#if !defined(__STDC_VERSION__) || __STDC_VERSION__ < 201112L
+#error "spscq.h requires C11 atomics, compile with -std=c11"
+#endif
+
+#include <stdatomic.h>
+#include <stddef.h>
+
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+typedef struct
+{
+    // consumer side
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t head; // next slot to pop
+    size_t cached_tail;                           // consumer copy of tail
+
+    // producer side
+    _Alignas(CACHE_LINE_SIZE) atomic_size_t tail; // next slot to push
+    size_t cached_head;                           // producer copy of head
+
+    // read only after creation
+    _Alignas(CACHE_LINE_SIZE) size_t capacity; // number of slots (power of two)
+    size_t mask;                               // capacity - 1
+    void **slots;                              // ring buffer
+} SpscQueue;
+
+/**
+ * @brief Create a queue
+ *
+ * @param[in] capacity max number of queued elements, must be a power of two
+ * @return queue pointer or NULL in case of error
+ */
+SpscQueue *spscq_create(size_t capacity);
+
+/**
+ * @brief Destroy a queue
+ *
+ * Queued elements are not freed. No thread must be using the queue.
+ *
+ * @param[in] queue queue pointer (can be NULL)
+ */
+void spscq_destroy(SpscQueue *queue);
+
+/**
+ * @brief Push an element (producer thread only)
+ *
+ * @param[in] queue queue pointer
+ * @param[in] elem element to push
+ * @return 1 if pushed, 0 if the queue is full
+ */
+int spscq_push(SpscQueue *queue, void *elem);
+
+/**
+ * @brief Pop an element (consumer thread only)
+ *
+ * @param[in] queue queue pointer
+ * @param[out] res popped element
+ * @return 1 if popped, 0 if the queue is empty
+ */
+int spscq_pop(SpscQueue *queue, void **res);
+
+/**
+ * @brief Number of queued elements
+ *
+ * Only a snapshot when the other thread is running
+ *
+ * @param[in] queue queue pointer
+ * @return number of queued elements
+ */
+size_t spscq_size(SpscQueue *queue);
+
+#endif // SPSCQ_H
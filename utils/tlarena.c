@@ -0,0 +1,103 @@
+#include "tlarena.h"
+#include <stdio.h>
+
+// current arena of the thread
+static TLARENA_THREAD_LOCAL BumpArena *tl_arena = NULL;
+// arena created by tlarena_get, owned by tlarena even while swapped out
+static TLARENA_THREAD_LOCAL BumpArena *tl_lazy = NULL;
+
+/** @copydoc sharedarena_create */
+SharedArena *sharedarena_create(size_t capacity) {
+    SharedArena *shared = malloc(sizeof(SharedArena));
+    if (shared == NULL) {
+        perror("[sharedarena_create] out of memory");
+        return NULL;
+    }
+    shared->arena = bumparena_create(capacity);
+    if (shared->arena == NULL) {
+        free(shared);
+        return NULL;
+    }
+    if (pthread_mutex_init(&shared->lock, NULL) != 0) {
+        fprintf(stderr, "[sharedarena_create] Cannot init the mutex\n");
+        bumparena_destroy(shared->arena);
+        free(shared);
+        return NULL;
+    }
+    return shared;
+}
+
+/** @copydoc sharedarena_destroy */
+void sharedarena_destroy(SharedArena *shared) {
+    if (shared == NULL)
+        return;
+    pthread_mutex_destroy(&shared->lock);
+    bumparena_destroy(shared->arena);
+    free(shared);
+}
+
+/** @copydoc sharedarena_alloc */
+void *sharedarena_alloc(SharedArena *shared, size_t len, size_t align) {
+    if (shared == NULL)
+        return NULL;
+    pthread_mutex_lock(&shared->lock);
+    void *ptr = bumparena_alloc_aligned(shared->arena, len, align);
+    pthread_mutex_unlock(&shared->lock);
+    return ptr;
+}
+
+/** @copydoc tlarena_get */
+BumpArena *tlarena_get(void) {
+    if (tl_arena == NULL) {
+        if (tl_lazy == NULL)
+            tl_lazy = bumparena_create(TLARENA_DEFAULT_CAPACITY);
+        tl_arena = tl_lazy;
+    }
+    return tl_arena;
+}
+
+/** @copydoc tlarena_set */
+BumpArena *tlarena_set(BumpArena *arena) {
+    BumpArena *prev = tl_arena;
+    tl_arena = arena; // restoring the lazy arena restores its ownership
+    return prev;
+}
+
+/** @copydoc tlarena_alloc */
+void *tlarena_alloc(size_t len) {
+    return bumparena_alloc(tlarena_get(), len);
+}
+
+/** @copydoc tlarena_alloc_aligned */
+void *tlarena_alloc_aligned(size_t len, size_t align) {
+    return bumparena_alloc_aligned(tlarena_get(), len, align);
+}
+
+/** @copydoc tlarena_handoff */
+int tlarena_handoff(SharedArena *shared) {
+    if (shared == NULL)
+        return 0;
+    if (tl_arena == NULL)
+        return 1; // nothing allocated
+
+    pthread_mutex_lock(&shared->lock);
+    int res = bumparena_absorb(shared->arena, tl_arena);
+    pthread_mutex_unlock(&shared->lock);
+    if (!res)
+        return 0;
+
+    // the chunks now belong to the shared arena, only the empty header is left
+    if (tl_arena == tl_lazy) {
+        bumparena_destroy(tl_lazy);
+        tl_lazy = NULL;
+    }
+    tl_arena = NULL;
+    return 1;
+}
+
+/** @copydoc tlarena_destroy */
+void tlarena_destroy(void) {
+    bumparena_destroy(tl_lazy); // also when swapped out by tlarena_set
+    tl_lazy = NULL;
+    tl_arena = NULL;
+}
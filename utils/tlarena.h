@@ -0,0 +1,141 @@
+/**
+ * @brief Thread-local BumpArena
+ *
+ * Every thread gets its own current arena, created lazily on the first
+ * allocation, so workers allocate with no lock and no atomic on the hot path
+ * (the arena pointer lives in thread local storage).
+ *
+ * When a worker is done, tlarena_handoff moves all its chunks into a shared
+ * arena under a mutex: the data allocated by the worker stays valid and is
+ * freed with the shared arena. The handoff only relinks chunk lists, nothing
+ * is copied.
+ *
+ * A thread that does not hand off must call tlarena_destroy before exiting,
+ * otherwise its arena leaks.
+ *
+ * tlarena_set lets a thread swap its current arena (e.g. a per-request
+ * scratch arena) and restore the previous one afterwards.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef TLARENA_H
+#define TLARENA_H
+
+#include "bumparena.h"
+#include <pthread.h>
+#include <stddef.h>
+
+#define TLARENA_DEFAULT_CAPACITY (64 * 1024) // first chunk of a lazily created arena
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+#define TLARENA_THREAD_LOCAL _Thread_local
+#else
+#define TLARENA_THREAD_LOCAL __thread // gcc/clang extension before C11
+#endif
+
+/**
+ * Arena shared between threads, target of tlarena_handoff
+ */
+typedef struct
+{
+    BumpArena *arena;     // owned arena, absorbs the chunks of the workers
+    pthread_mutex_t lock; // protects arena
+} SharedArena;
+
+/**
+ * @brief Create a shared arena
+ *
+ * @param[in] capacity bytes of the first chunk
+ * @return shared arena pointer or NULL in case of error
+ */
+SharedArena *sharedarena_create(size_t capacity);
+
+/**
+ * @brief Destroy a shared arena and everything handed off to it
+ *
+ * @param[in] shared shared arena pointer (can be NULL)
+ */
+void sharedarena_destroy(SharedArena *shared);
+
+/**
+ * @brief Allocate from a shared arena (locks)
+ *
+ * @param[in] shared shared arena pointer
+ * @param[in] len bytes
+ * @param[in] align power of two
+ * @return aligned pointer or NULL in case of error
+ */
+void *sharedarena_alloc(SharedArena *shared, size_t len, size_t align);
+
+/**
+ * @brief Current arena of the calling thread
+ *
+ * Created with TLARENA_DEFAULT_CAPACITY on the first call.
+ *
+ * @return arena pointer or NULL in case of error
+ */
+BumpArena *tlarena_get(void);
+
+/**
+ * @brief Replace the current arena of the calling thread
+ *
+ * The arena is not owned: the caller restores the previous one and destroys
+ * its own arena. The lazily created arena stays owned by the thread while it
+ * is swapped out, and is owned again once restored.
+ *
+ * @param[in] arena new current arena (NULL to fall back to the lazily created one)
+ * @return previous current arena (can be NULL)
+ */
+BumpArena *tlarena_set(BumpArena *arena);
+
+/**
+ * @brief Allocate from the current arena of the calling thread
+ *
+ * @param[in] len bytes
+ * @return pointer with no alignment or NULL in case of error
+ */
+void *tlarena_alloc(size_t len);
+
+/**
+ * @brief Allocate aligned from the current arena of the calling thread
+ *
+ * @param[in] len bytes
+ * @param[in] align power of two
+ * @return aligned pointer or NULL in case of error
+ */
+void *tlarena_alloc_aligned(size_t len, size_t align);
+
+/**
+ * @brief Allocate one uninitialized T from the current thread arena
+ */
+#define TLARENA_NEW(T) ((T *)tlarena_alloc_aligned(sizeof(T), BUMPARENA_ALIGNOF(T)))
+
+/**
+ * @brief Allocate an uninitialized array of n T from the current thread arena
+ */
+#define TLARENA_ARRAY(T, n) \
+    ((n) > SIZE_MAX / sizeof(T) ? NULL : (T *)tlarena_alloc_aligned((n) * sizeof(T), BUMPARENA_ALIGNOF(T)))
+
+/**
+ * @brief Move the current arena of the calling thread into a shared arena
+ *
+ * All the memory allocated by the thread stays valid until
+ * sharedarena_destroy. The thread can keep allocating: a new arena is created
+ * on the next tlarena_alloc. An arena installed with tlarena_set is emptied
+ * (see bumparena_absorb) and stays owned by the caller.
+ *
+ * @param[in] shared shared arena pointer
+ * @return 1 if good, 0 in case of error (the thread arena is left untouched)
+ */
+int tlarena_handoff(SharedArena *shared);
+
+/**
+ * @brief Destroy the lazily created arena of the calling thread
+ *
+ * Everything allocated by the thread in it is released, also when it is
+ * swapped out by tlarena_set. An arena installed with tlarena_set is left to
+ * its owner.
+ */
+void tlarena_destroy(void);
+
+#endif // TLARENA_H
@@ -0,0 +1,333 @@
+#include "ullist.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/** @copydoc ull_create */
+ULList *ull_create(void) {
+    ULList *cur = malloc(sizeof(ULList));
+    if (cur == NULL) {
+        perror("[ull_create] Cannot create a new linked list");
+        return NULL;
+    }
+    cur->head = NULL;
+    cur->tail = NULL;
+    cur->size = 0;
+    cur->nodes = 0;
+    return cur;
+}
+
+/** @copydoc ull_destroy */
+void ull_destroy(ULList *list) {
+    if (list == NULL)
+        return;
+
+    ULLNode *cur = list->head;
+    while (cur != NULL) {
+        ULLNode *next = cur->next;
+        free(cur);
+        cur = next;
+    }
+    free(list);
+}
+
+/**
+ * Allocate a new empty node and link it after prev (or as head if prev is NULL)
+ * @param[in] list A valid (non-NULL) ULList pointer
+ * @param[in] prev Node that will precede the new one, NULL to insert at head
+ * @returns Pointer to newly allocated ULLNode, or NULL on allocation failure
+ */
+static ULLNode *ull_insert_node(ULList *list, ULLNode *prev) {
+    ULLNode *node = malloc(sizeof(ULLNode));
+    if (node == NULL) {
+        perror("[ull_insert_node] Cannot create a new node");
+        return NULL;
+    }
+    node->count = 0;
+    node->prev = prev;
+    node->next = prev == NULL ? list->head : prev->next;
+
+    if (node->prev == NULL)
+        list->head = node;
+    else
+        node->prev->next = node;
+
+    if (node->next == NULL)
+        list->tail = node;
+    else
+        node->next->prev = node;
+
+    list->nodes++;
+    return node;
+}
+
+/**
+ * Unlink a node from the list and free its memory
+ * @param[in] list A valid (non-NULL) ULList pointer
+ * @param[in] node Node to remove, its values are discarded
+ */
+static void ull_remove_node(ULList *list, ULLNode *node) {
+    if (node->prev == NULL)
+        list->head = node->next;
+    else
+        node->prev->next = node->next;
+
+    if (node->next == NULL)
+        list->tail = node->prev;
+    else
+        node->next->prev = node->prev;
+
+    free(node);
+    list->nodes--;
+}
+
+/**
+ * Find the node holding the value at idx
+ * @param[in] list A valid (non-NULL) ULList pointer
+ * @param[in] idx Zero-based index, must be < size
+ * @param[out] off Offset of the value inside the node
+ * @returns Node containing the value
+ */
+static ULLNode *ull_locate(const ULList *list, size_t idx, size_t *off) {
+    ULLNode *res = NULL;
+    if (idx < list->size / 2) {
+        // Traverse from head, skipping a whole node per hop
+        res = list->head;
+        while (idx >= res->count) {
+            idx -= res->count;
+            res = res->next;
+        }
+        *off = idx;
+    } else {
+        // Traverse from tail, skipping a whole node per hop
+        size_t rem = list->size - 1 - idx;
+        res = list->tail;
+        while (rem >= res->count) {
+            rem -= res->count;
+            res = res->prev;
+        }
+        *off = res->count - 1 - rem;
+    }
+    return res;
+}
+
+/**
+ * Merge a sparse node with one of its neighbours if they fit in a single node
+ * @param[in] list A valid (non-NULL) ULList pointer
+ * @param[in] node Node that just lost a value
+ */
+static void ull_try_merge(ULList *list, ULLNode *node) {
+    if (node->count >= ULL_NODE_CAP / 2)
+        return;
+
+    ULLNode *next = node->next;
+    if (next != NULL && node->count + next->count <= ULL_NODE_CAP) {
+        // pull the next node values into this one
+        memcpy(&node->elems[node->count], next->elems, next->count * sizeof(size_t));
+        node->count += next->count;
+        ull_remove_node(list, next);
+        return;
+    }
+
+    ULLNode *prev = node->prev;
+    if (prev != NULL && prev->count + node->count <= ULL_NODE_CAP) {
+        // push this node values into the previous one
+        memcpy(&prev->elems[prev->count], node->elems, node->count * sizeof(size_t));
+        prev->count += node->count;
+        ull_remove_node(list, node);
+    }
+}
+
+/** @copydoc ull_get */
+size_t *ull_get(const ULList *list, size_t idx) {
+    if (list == NULL || list->size <= idx) {
+        fprintf(stderr, "[ull_get] Index %zu not valid because size is %zu\n", idx, list ? list->size : 0);
+        return NULL;
+    }
+
+    size_t off;
+    ULLNode *node = ull_locate(list, idx, &off);
+    return &node->elems[off];
+}
+
+/** @copydoc ull_add */
+int ull_add(ULList *list, size_t elem, size_t idx) {
+    if (list == NULL || idx > list->size) {
+        fprintf(stderr, "[ull_add] Index %zu out of bounds (size: %zu)\n", idx, list ? list->size : 0);
+        return 0;
+    }
+
+    ULLNode *node;
+    size_t off;
+
+    if (idx == list->size) {
+        // Case 1: append, open a new node only when the tail is full
+        node = list->tail;
+        if (node == NULL || node->count == ULL_NODE_CAP) {
+            node = ull_insert_node(list, list->tail);
+            if (node == NULL)
+                return 0;
+        }
+        off = node->count;
+    } else if (idx == 0 && list->head->count == ULL_NODE_CAP) {
+        // Case 2: prepend on a full head, open a new head node
+        node = ull_insert_node(list, NULL);
+        if (node == NULL)
+            return 0;
+        off = 0;
+    } else {
+        // Case 3: insert inside a node, split it in two halves if it is full
+        node = ull_locate(list, idx, &off);
+        if (node->count == ULL_NODE_CAP) {
+            ULLNode *right = ull_insert_node(list, node);
+            if (right == NULL)
+                return 0;
+
+            size_t half = ULL_NODE_CAP / 2;
+            right->count = node->count - half;
+            memcpy(right->elems, &node->elems[half], right->count * sizeof(size_t));
+            node->count = half;
+
+            if (off > half) {
+                node = right;
+                off -= half;
+            }
+        }
+    }
+
+    // right shift inside the node
+    memmove(&node->elems[off + 1], &node->elems[off], (node->count - off) * sizeof(size_t));
+    node->elems[off] = elem;
+    node->count++;
+    list->size++;
+    return 1;
+}
+
+/** @copydoc ull_remove */
+int ull_remove(ULList *list, size_t idx) {
+    if (list == NULL) {
+        fprintf(stderr, "[ull_remove] Cannot remove element from NULL list\n");
+        return 0;
+    }
+
+    if (idx >= list->size) {
+        fprintf(stderr, "[ull_remove] Index %zu not valid because size is %zu\n", idx, list->size);
+        return 0;
+    }
+
+    size_t off;
+    ULLNode *node = ull_locate(list, idx, &off);
+
+    // left shift inside the node
+    memmove(&node->elems[off], &node->elems[off + 1], (node->count - off - 1) * sizeof(size_t));
+    node->count--;
+    list->size--;
+
+    if (node->count == 0)
+        ull_remove_node(list, node);
+    else
+        ull_try_merge(list, node);
+    return 1;
+}
+
+/** @copydoc ull_print */
+void ull_print(const ULList *list) {
+    if (list == NULL) {
+        fprintf(stderr, "[ull_print] (empty list)\n");
+        return;
+    }
+
+    for (ULLNode *cur = list->head; cur != NULL; cur = cur->next) {
+        for (size_t ii = 0; ii < cur->count; ii++)
+            printf("%zu ", cur->elems[ii]);
+    }
+    printf("\n");
+}
+
+/** @copydoc ull_print_reverse */
+void ull_print_reverse(const ULList *list) {
+    if (list == NULL) {
+        fprintf(stderr, "[ull_print_reverse] (empty list)\n");
+        return;
+    }
+
+    for (ULLNode *cur = list->tail; cur != NULL; cur = cur->prev) {
+        for (size_t ii = cur->count; ii > 0; ii--)
+            printf("%zu ", cur->elems[ii - 1]);
+    }
+    printf("\n");
+}
+
+/** @copydoc ull_is_empty */
+int ull_is_empty(const ULList *list) {
+    return (list == NULL || list->size == 0) ? 1 : 0;
+}
+
+/** @copydoc ull_get_size */
+size_t ull_get_size(const ULList *list) {
+    return list == NULL ? 0 : list->size;
+}
+
+/** @copydoc ull_prepend */
+int ull_prepend(ULList *list, size_t elem) {
+    return ull_add(list, elem, 0);
+}
+
+/** @copydoc ull_append */
+int ull_append(ULList *list, size_t elem) {
+    return ull_add(list, elem, list->size);
+}
+
+/** @copydoc ull_pop */
+int ull_pop(ULList *list, size_t *res) {
+    if (ull_is_empty(list)) {
+        fprintf(stderr, "[ull_pop] Cannot get element\n");
+        return 0;
+    }
+    *res = list->tail->elems[list->tail->count - 1];
+    ull_remove(list, list->size - 1);
+    return 1;
+}
+
+/** @copydoc ull_get_value */
+int ull_get_value(ULList *list, size_t idx, size_t *res) {
+    size_t *slot = ull_get(list, idx);
+    if (slot == NULL) {
+        fprintf(stderr, "[ull_get_value] Cannot get element\n");
+        return 0;
+    }
+    *res = *slot;
+    return 1;
+}
+
+/** @copydoc ull_get_head */
+ULLNode *ull_get_head(ULList *list) {
+    return list->head;
+}
+
+/** @copydoc ull_get_value_head */
+int ull_get_value_head(ULList *list, size_t *res) {
+    ULLNode *head = ull_get_head(list);
+    if (head == NULL) {
+        fprintf(stderr, "[ull_get_value_head] Cannot get head\n");
+        return 0;
+    }
+    *res = head->elems[0];
+    return 1;
+}
+
+/** @copydoc ull_get_tail */
+ULLNode *ull_get_tail(ULList *list) {
+    return list->tail;
+}
+
+/** @copydoc ull_get_value_tail */
+int ull_get_value_tail(ULList *list, size_t *res) {
+    ULLNode *tail = ull_get_tail(list);
+    if (tail == NULL) {
+        fprintf(stderr, "[ull_get_value_tail] Cannot get tail\n");
+        return 0;
+    }
+    *res = tail->elems[tail->count - 1];
+    return 1;
+}
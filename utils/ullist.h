@@ -0,0 +1,183 @@
+/**
+ * @brief Unrolled linked list implementation
+ *
+ * Numeric doubly linked list where every node stores a small array of size_t
+ * values instead of a single one. A node is sized to fill two cache lines,
+ * so traversal touches one node (and one cache miss) every ULL_NODE_CAP
+ * values instead of every value as in NLList.
+ *
+ * Nodes are split when an insertion hits a full node and merged with the
+ * next one when removals leave them sparse, so every node stays reasonably
+ * dense.
+ *
+ * The ull_* API follows the nll_* semantics (see nllist.h), except that
+ * values live inside shared nodes: ull_get returns a pointer to the value
+ * slot, which is only valid until the next add/remove.
+ *
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef ULLIST_H
+#define ULLIST_H
+
+#include <stddef.h>
+
+#define ULL_NODE_BYTES 128 // target node size: two cache lines
+
+// values per node so that the whole node is ULL_NODE_BYTES (13 on 64 bit)
+#define ULL_NODE_CAP ((ULL_NODE_BYTES - 2 * sizeof(void *) - sizeof(size_t)) / sizeof(size_t))
+
+/**
+ * Node structure: a chunk of consecutive values
+ */
+typedef struct ullnode {
+    struct ullnode *prev;       // Pointer to previous node
+    struct ullnode *next;       // Pointer to next node
+    size_t count;               // Number of used slots in elems
+    size_t elems[ULL_NODE_CAP]; // Values, elems[0..count-1] are valid
+} ULLNode;
+
+/**
+ * Unrolled linked list structure
+ */
+typedef struct
+{
+    ULLNode *head; // Pointer to first node
+    ULLNode *tail; // Pointer to last node
+    size_t size;   // Number of values in the list
+    size_t nodes;  // Number of nodes in the list
+} ULList;
+
+/**
+ * Create and initialize a new unrolled linked list
+ * @returns Pointer to new ULList, or NULL on allocation failure
+ */
+ULList *ull_create(void);
+
+/**
+ * Deallocate linked list and all nodes
+ * @param[in] list Pointer to the list to destroy (can be NULL)
+ */
+void ull_destroy(ULList *list);
+
+/**
+ * Get the value slot at specified index
+ * @param[in] list Pointer to the list
+ * @param[in] idx Zero-based index
+ * @returns Pointer to the value if found, NULL if index out of bounds
+ * @note Traverses node by node from the closest end.
+ *       The pointer is invalidated by any ull_add/ull_remove
+ */
+size_t *ull_get(const ULList *list, size_t idx);
+
+/**
+ * Insert element at specified index
+ * @param[in] list Pointer to the list
+ * @param[in] elem Numeric value to insert
+ * @param[in] idx Zero-based index (0 = prepend, size = append)
+ * @returns 1 OK, 0 in case of error
+ * @note idx must be in range [0, size]. A full node is split in two
+ */
+int ull_add(ULList *list, size_t elem, size_t idx);
+
+/**
+ * Remove element at specified index
+ * @param[in] list Pointer to the list
+ * @param[in] idx Zero-based index
+ * @returns 0 in case of error , 1 OK
+ * @note A sparse node is merged with the next one when they fit together
+ */
+int ull_remove(ULList *list, size_t idx);
+
+/**
+ * Print list from head to tail
+ * @param[in] list Pointer to the list
+ * @note Prints to stdout with space-separated values
+ */
+void ull_print(const ULList *list);
+
+/**
+ * Print list from tail to head
+ * @param[in] list Pointer to the list
+ * @note Prints to stdout with space-separated values
+ */
+void ull_print_reverse(const ULList *list);
+
+/**
+ * Check if list is empty
+ * @param[in] list Pointer to the list
+ * @returns 1 if is empty or 0 otherwise
+ */
+int ull_is_empty(const ULList *list);
+
+/**
+ * Get size of list
+ * @param[in] list Pointer to the list
+ * @returns Number of elements in list, 0 if NULL
+ */
+size_t ull_get_size(const ULList *list);
+
+/**
+ * Insert element at the end
+ * @param[in] list Pointer to the list
+ * @param[in] elem Numeric value to insert
+ * @returns 1 OK, 0 in case of error
+ */
+int ull_append(ULList *list, size_t elem);
+
+/**
+ * Insert element at the beginning
+ * @param[in] list Pointer to the list
+ * @param[in] elem Numeric value to insert
+ * @returns 1 OK, 0 in case of error
+ */
+int ull_prepend(ULList *list, size_t elem);
+
+/**
+ * Pop last element from the list
+ * @param[in] list Pointer to the list
+ * @param[out] res The popped element
+ * @returns 0 in case of error, 1 ok
+ */
+int ull_pop(ULList *list, size_t *res);
+
+/**
+ * Get an element from the list given the index
+ * @param[in] list Pointer to the list
+ * @param[in] idx Index
+ * @param[out] res The retrived
+ * @returns 1 ok, 0 error
+ */
+int ull_get_value(ULList *list, size_t idx, size_t *res);
+
+/**
+ * Get head node from the list
+ * @param[in] list Pointer to the list
+ * @returns Pointer to the head node
+ * @note Iterate with node->elems[0..count-1] then node->next
+ */
+ULLNode *ull_get_head(ULList *list);
+
+/**
+ * Get head element from the list
+ * @param[in] list Pointer to the list
+ * @param[out] res The head element
+ * @returns 1 ok, 0 error
+ */
+int ull_get_value_head(ULList *list, size_t *res);
+
+/**
+ * Get tail node from the list
+ * @param[in] list Pointer to the list
+ * @returns Pointer to the tail node
+ */
+ULLNode *ull_get_tail(ULList *list);
+
+/**
+ * Get tail element from the list
+ * @param[in] list Pointer to the list
+ * @param[out] res The tail element
+ * @returns 1 ok, 0 error
+ */
+int ull_get_value_tail(ULList *list, size_t *res);
+
+#endif // ULLIST_H
@@ -0,0 +1,695 @@
+#include "xxh3.h"
+#include <stdio.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define XXH3_HAS_X86 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#define XXH_PRIME32_1 0x9E3779B1U
+#define XXH_PRIME32_2 0x85EBCA77U
+#define XXH_PRIME32_3 0xC2B2AE3DU
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+#define XXH_PRIME_MX1 0x165667919E3779F9ULL
+#define XXH_PRIME_MX2 0x9FB21C651E98DF25ULL
+
+#define XXH3_SECRET_SIZE 192
+#define XXH3_STRIPE_LEN 64
+#define XXH3_SECRET_CONSUME_RATE 8 // secret advance per stripe
+#define XXH3_STRIPES_PER_BLOCK ((XXH3_SECRET_SIZE - XXH3_STRIPE_LEN) / XXH3_SECRET_CONSUME_RATE) // 16
+#define XXH3_SECRET_LASTACC_START 7
+#define XXH3_SECRET_MERGEACCS_START 11
+#define XXH3_MIDSIZE_MAX 240
+#define XXH3_MIDSIZE_STARTOFFSET 3
+#define XXH3_MIDSIZE_LASTOFFSET 17
+#define XXH3_SECRET_SIZE_MIN 136
+#define XXH3_BUFFER_STRIPES (sizeof(((XXH3_CTX *)0)->buffer) / XXH3_STRIPE_LEN)
+
+/**
+ * @brief Default secret (kSecret of the reference implementation)
+ */
+static const uint8_t xxh3_secret[XXH3_SECRET_SIZE] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c, 0xf7, 0x21, 0xad, 0x1c,
+    0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb, 0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f,
+    0xcb, 0x79, 0xe6, 0x4e, 0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6, 0x81, 0x3a, 0x26, 0x4c,
+    0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb, 0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3,
+    0x71, 0x64, 0x48, 0x97, 0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7, 0xc7, 0x0b, 0x4f, 0x1d,
+    0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31, 0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64,
+    0xea, 0xc5, 0xac, 0x83, 0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26, 0x29, 0xd4, 0x68, 0x9e,
+    0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc, 0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce,
+    0x45, 0xcb, 0x3a, 0x8f, 0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+/**
+ * @brief Accumulate stripes * 64 bytes of input, secret advancing 8 bytes per stripe
+ */
+typedef void (*Xxh3AccumulateFn)(uint64_t acc[8], const uint8_t *input, const uint8_t *secret, size_t stripes);
+
+/**
+ * @brief Scramble the accumulators at the end of a block
+ */
+typedef void (*Xxh3ScrambleFn)(uint64_t acc[8], const uint8_t *secret);
+
+/**
+ * @brief 128-bit value (hash or product)
+ */
+typedef struct
+{
+    uint64_t low;
+    uint64_t high;
+} Xxh3U128;
+
+/**
+ * @brief Little endian loads
+ */
+static inline uint32_t xxh3_load_le32(const uint8_t *p) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint32_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+#else
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+#endif
+}
+
+static inline uint64_t xxh3_load_le64(const uint8_t *p) {
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t word;
+    memcpy(&word, p, sizeof(word));
+    return word;
+#else
+    return (uint64_t)xxh3_load_le32(p) | ((uint64_t)xxh3_load_le32(p + 4) << 32);
+#endif
+}
+
+static inline uint32_t xxh3_swap32(uint32_t x) {
+    return ((x << 24) & 0xff000000U) | ((x << 8) & 0x00ff0000U) | ((x >> 8) & 0x0000ff00U) | ((x >> 24) & 0x000000ffU);
+}
+
+static inline uint64_t xxh3_swap64(uint64_t x) {
+    return ((uint64_t)xxh3_swap32((uint32_t)x) << 32) | xxh3_swap32((uint32_t)(x >> 32));
+}
+
+static inline uint32_t xxh3_rotl32(uint32_t x, int r) {
+    return (x << r) | (x >> (32 - r));
+}
+
+/**
+ * @brief Full 64x64->128 product
+ */
+static inline Xxh3U128 xxh3_mul128(uint64_t a, uint64_t b) {
+    Xxh3U128 r;
+#if defined(__GNUC__) && defined(__SIZEOF_INT128__)
+    __extension__ unsigned __int128 product = (unsigned __int128)a * b;
+    r.low = (uint64_t)product;
+    r.high = (uint64_t)(product >> 64);
+#else
+    uint64_t lo_lo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+    uint64_t hi_lo = (a >> 32) * (b & 0xFFFFFFFF);
+    uint64_t lo_hi = (a & 0xFFFFFFFF) * (b >> 32);
+    uint64_t hi_hi = (a >> 32) * (b >> 32);
+    uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    r.high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    r.low = (cross << 32) | (lo_lo & 0xFFFFFFFF);
+#endif
+    return r;
+}
+
+/**
+ * @brief 64x64->128 product folded to 64 bits
+ */
+static inline uint64_t xxh3_mul128_fold64(uint64_t a, uint64_t b) {
+    Xxh3U128 product = xxh3_mul128(a, b);
+    return product.low ^ product.high;
+}
+
+static inline uint64_t xxh64_avalanche(uint64_t h) {
+    h ^= h >> 33;
+    h *= XXH_PRIME64_2;
+    h ^= h >> 29;
+    h *= XXH_PRIME64_3;
+    h ^= h >> 32;
+    return h;
+}
+
+static inline uint64_t xxh3_avalanche(uint64_t h) {
+    h ^= h >> 37;
+    h *= XXH_PRIME_MX1;
+    h ^= h >> 32;
+    return h;
+}
+
+/**
+ * @brief 0 bytes
+ */
+static Xxh3U128 xxh3_len_0(void) {
+    Xxh3U128 h;
+    h.low = xxh64_avalanche(xxh3_load_le64(xxh3_secret + 64) ^ xxh3_load_le64(xxh3_secret + 72));
+    h.high = xxh64_avalanche(xxh3_load_le64(xxh3_secret + 80) ^ xxh3_load_le64(xxh3_secret + 88));
+    return h;
+}
+
+/**
+ * @brief 1 to 3 bytes
+ */
+static Xxh3U128 xxh3_len_1to3(const uint8_t *input, size_t len) {
+    uint32_t combined_lo = ((uint32_t)input[0] << 16) | ((uint32_t)input[len >> 1] << 24) | (uint32_t)input[len - 1] |
+                           ((uint32_t)len << 8);
+    uint32_t combined_hi = xxh3_rotl32(xxh3_swap32(combined_lo), 13);
+    uint64_t bitflip_lo = xxh3_load_le32(xxh3_secret) ^ xxh3_load_le32(xxh3_secret + 4);
+    uint64_t bitflip_hi = xxh3_load_le32(xxh3_secret + 8) ^ xxh3_load_le32(xxh3_secret + 12);
+
+    Xxh3U128 h;
+    h.low = xxh64_avalanche(combined_lo ^ bitflip_lo);
+    h.high = xxh64_avalanche(combined_hi ^ bitflip_hi);
+    return h;
+}
+
+/**
+ * @brief 4 to 8 bytes
+ */
+static Xxh3U128 xxh3_len_4to8(const uint8_t *input, size_t len) {
+    uint64_t input_64 = xxh3_load_le32(input) + ((uint64_t)xxh3_load_le32(input + len - 4) << 32);
+    uint64_t bitflip = xxh3_load_le64(xxh3_secret + 16) ^ xxh3_load_le64(xxh3_secret + 24);
+
+    Xxh3U128 m = xxh3_mul128(input_64 ^ bitflip, XXH_PRIME64_1 + ((uint64_t)len << 2));
+    m.high += m.low << 1;
+    m.low ^= m.high >> 3;
+    m.low ^= m.low >> 35;
+    m.low *= XXH_PRIME_MX2;
+    m.low ^= m.low >> 28;
+    m.high = xxh3_avalanche(m.high);
+    return m;
+}
+
+/**
+ * @brief 9 to 16 bytes
+ */
+static Xxh3U128 xxh3_len_9to16(const uint8_t *input, size_t len) {
+    uint64_t bitflip_lo = xxh3_load_le64(xxh3_secret + 32) ^ xxh3_load_le64(xxh3_secret + 40);
+    uint64_t bitflip_hi = xxh3_load_le64(xxh3_secret + 48) ^ xxh3_load_le64(xxh3_secret + 56);
+    uint64_t input_lo = xxh3_load_le64(input);
+    uint64_t input_hi = xxh3_load_le64(input + len - 8);
+
+    Xxh3U128 m = xxh3_mul128(input_lo ^ input_hi ^ bitflip_lo, XXH_PRIME64_1);
+    m.low += (uint64_t)(len - 1) << 54;
+    input_hi ^= bitflip_hi;
+    m.high += input_hi + (uint64_t)(uint32_t)input_hi * (XXH_PRIME32_2 - 1);
+    m.low ^= xxh3_swap64(m.high);
+
+    Xxh3U128 h = xxh3_mul128(m.low, XXH_PRIME64_2);
+    h.high += m.high * XXH_PRIME64_2;
+    h.low = xxh3_avalanche(h.low);
+    h.high = xxh3_avalanche(h.high);
+    return h;
+}
+
+static inline uint64_t xxh3_mix16(const uint8_t *input, const uint8_t *secret, uint64_t seed) {
+    return xxh3_mul128_fold64(xxh3_load_le64(input) ^ (xxh3_load_le64(secret) + seed),
+                              xxh3_load_le64(input + 8) ^ (xxh3_load_le64(secret + 8) - seed));
+}
+
+static inline void xxh3_mix32(Xxh3U128 *acc, const uint8_t *input_1, const uint8_t *input_2, const uint8_t *secret,
+                              uint64_t seed) {
+    acc->low += xxh3_mix16(input_1, secret, seed);
+    acc->low ^= xxh3_load_le64(input_2) + xxh3_load_le64(input_2 + 8);
+    acc->high += xxh3_mix16(input_2, secret + 16, seed);
+    acc->high ^= xxh3_load_le64(input_1) + xxh3_load_le64(input_1 + 8);
+}
+
+/**
+ * @brief Final mix of the short and mid size paths
+ */
+static Xxh3U128 xxh3_mix_final(Xxh3U128 acc, size_t len) {
+    Xxh3U128 h;
+    h.low = xxh3_avalanche(acc.low + acc.high);
+    h.high = 0 - xxh3_avalanche(acc.low * XXH_PRIME64_1 + acc.high * XXH_PRIME64_4 + (uint64_t)len * XXH_PRIME64_2);
+    return h;
+}
+
+/**
+ * @brief 17 to 128 bytes
+ */
+static Xxh3U128 xxh3_len_17to128(const uint8_t *input, size_t len) {
+    Xxh3U128 acc = {(uint64_t)len * XXH_PRIME64_1, 0};
+    size_t ii = (len - 1) / 32;
+    do {
+        xxh3_mix32(&acc, input + 16 * ii, input + len - 16 * (ii + 1), xxh3_secret + 32 * ii, 0);
+    } while (ii-- != 0);
+    return xxh3_mix_final(acc, len);
+}
+
+/**
+ * @brief 129 to 240 bytes
+ */
+static Xxh3U128 xxh3_len_129to240(const uint8_t *input, size_t len) {
+    Xxh3U128 acc = {(uint64_t)len * XXH_PRIME64_1, 0};
+    size_t ii;
+    for (ii = 32; ii < 160; ii += 32)
+        xxh3_mix32(&acc, input + ii - 32, input + ii - 16, xxh3_secret + ii - 32, 0);
+    acc.low = xxh3_avalanche(acc.low);
+    acc.high = xxh3_avalanche(acc.high);
+    for (ii = 160; ii <= len; ii += 32)
+        xxh3_mix32(&acc, input + ii - 32, input + ii - 16, xxh3_secret + XXH3_MIDSIZE_STARTOFFSET + ii - 160, 0);
+    xxh3_mix32(&acc, input + len - 16, input + len - 32,
+               xxh3_secret + XXH3_SECRET_SIZE_MIN - XXH3_MIDSIZE_LASTOFFSET - 16, 0);
+    return xxh3_mix_final(acc, len);
+}
+
+/**
+ * @brief Up to XXH3_MIDSIZE_MAX bytes
+ */
+static Xxh3U128 xxh3_short(const uint8_t *input, size_t len) {
+    if (len > 128)
+        return xxh3_len_129to240(input, len);
+    if (len > 16)
+        return xxh3_len_17to128(input, len);
+    if (len > 8)
+        return xxh3_len_9to16(input, len);
+    if (len >= 4)
+        return xxh3_len_4to8(input, len);
+    if (len > 0)
+        return xxh3_len_1to3(input, len);
+    return xxh3_len_0();
+}
+
+/**
+ * @brief Portable stripe accumulation
+ */
+static void xxh3_accumulate_generic(uint64_t acc[8], const uint8_t *input, const uint8_t *secret, size_t stripes) {
+    for (size_t nn = 0; nn < stripes; nn++) {
+        const uint8_t *in = input + nn * XXH3_STRIPE_LEN;
+        const uint8_t *key = secret + nn * XXH3_SECRET_CONSUME_RATE;
+        for (int ii = 0; ii < 8; ii++) {
+            uint64_t data_val = xxh3_load_le64(in + 8 * ii);
+            uint64_t data_key = data_val ^ xxh3_load_le64(key + 8 * ii);
+            acc[ii ^ 1] += data_val;
+            acc[ii] += (data_key & 0xFFFFFFFF) * (data_key >> 32);
+        }
+    }
+}
+
+/**
+ * @brief Portable scramble
+ */
+static void xxh3_scramble_generic(uint64_t acc[8], const uint8_t *secret) {
+    for (int ii = 0; ii < 8; ii++) {
+        uint64_t a = acc[ii];
+        a ^= a >> 47;
+        a ^= xxh3_load_le64(secret + 8 * ii);
+        a *= XXH_PRIME32_1;
+        acc[ii] = a;
+    }
+}
+
+#ifdef XXH3_HAS_X86
+/**
+ * @brief SSE2 stripe accumulation, 2 accumulators per register
+ *
+ * _mm_mul_epu32 multiplies the low 32 bits of each 64-bit lane: the high
+ * halves are moved down with a shuffle first.
+ */
+__attribute__((target("sse2"))) static void xxh3_accumulate_sse2(uint64_t acc[8], const uint8_t *input,
+                                                                  const uint8_t *secret, size_t stripes) {
+    __m128i xacc[4];
+    for (int ii = 0; ii < 4; ii++)
+        xacc[ii] = _mm_loadu_si128((const __m128i *)(acc + 2 * ii));
+
+    for (size_t nn = 0; nn < stripes; nn++) {
+        const uint8_t *in = input + nn * XXH3_STRIPE_LEN;
+        const uint8_t *key = secret + nn * XXH3_SECRET_CONSUME_RATE;
+        for (int ii = 0; ii < 4; ii++) {
+            __m128i data_vec = _mm_loadu_si128((const __m128i *)(in + 16 * ii));
+            __m128i key_vec = _mm_loadu_si128((const __m128i *)(key + 16 * ii));
+            __m128i data_key = _mm_xor_si128(data_vec, key_vec);
+            __m128i product = _mm_mul_epu32(data_key, _mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m128i data_swap = _mm_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+            xacc[ii] = _mm_add_epi64(product, _mm_add_epi64(xacc[ii], data_swap));
+        }
+    }
+
+    for (int ii = 0; ii < 4; ii++)
+        _mm_storeu_si128((__m128i *)(acc + 2 * ii), xacc[ii]);
+}
+
+/**
+ * @brief SSE2 scramble
+ */
+__attribute__((target("sse2"))) static void xxh3_scramble_sse2(uint64_t acc[8], const uint8_t *secret) {
+    const __m128i prime32 = _mm_set1_epi32((int)XXH_PRIME32_1);
+    for (int ii = 0; ii < 4; ii++) {
+        __m128i acc_vec = _mm_loadu_si128((const __m128i *)(acc + 2 * ii));
+        __m128i data_vec = _mm_xor_si128(acc_vec, _mm_srli_epi64(acc_vec, 47));
+        __m128i data_key = _mm_xor_si128(data_vec, _mm_loadu_si128((const __m128i *)(secret + 16 * ii)));
+        __m128i prod_lo = _mm_mul_epu32(data_key, prime32);
+        __m128i prod_hi = _mm_mul_epu32(_mm_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1)), prime32);
+        _mm_storeu_si128((__m128i *)(acc + 2 * ii), _mm_add_epi64(prod_lo, _mm_slli_epi64(prod_hi, 32)));
+    }
+}
+
+/**
+ * @brief AVX2 stripe accumulation, 4 accumulators per register
+ */
+__attribute__((target("avx2"))) static void xxh3_accumulate_avx2(uint64_t acc[8], const uint8_t *input,
+                                                                  const uint8_t *secret, size_t stripes) {
+    __m256i xacc[2];
+    for (int ii = 0; ii < 2; ii++)
+        xacc[ii] = _mm256_loadu_si256((const __m256i *)(acc + 4 * ii));
+
+    for (size_t nn = 0; nn < stripes; nn++) {
+        const uint8_t *in = input + nn * XXH3_STRIPE_LEN;
+        const uint8_t *key = secret + nn * XXH3_SECRET_CONSUME_RATE;
+        for (int ii = 0; ii < 2; ii++) {
+            __m256i data_vec = _mm256_loadu_si256((const __m256i *)(in + 32 * ii));
+            __m256i key_vec = _mm256_loadu_si256((const __m256i *)(key + 32 * ii));
+            __m256i data_key = _mm256_xor_si256(data_vec, key_vec);
+            __m256i product = _mm256_mul_epu32(data_key, _mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1)));
+            __m256i data_swap = _mm256_shuffle_epi32(data_vec, _MM_SHUFFLE(1, 0, 3, 2));
+            xacc[ii] = _mm256_add_epi64(product, _mm256_add_epi64(xacc[ii], data_swap));
+        }
+    }
+
+    for (int ii = 0; ii < 2; ii++)
+        _mm256_storeu_si256((__m256i *)(acc + 4 * ii), xacc[ii]);
+}
+
+/**
+ * @brief AVX2 scramble
+ */
+__attribute__((target("avx2"))) static void xxh3_scramble_avx2(uint64_t acc[8], const uint8_t *secret) {
+    const __m256i prime32 = _mm256_set1_epi32((int)XXH_PRIME32_1);
+    for (int ii = 0; ii < 2; ii++) {
+        __m256i acc_vec = _mm256_loadu_si256((const __m256i *)(acc + 4 * ii));
+        __m256i data_vec = _mm256_xor_si256(acc_vec, _mm256_srli_epi64(acc_vec, 47));
+        __m256i data_key = _mm256_xor_si256(data_vec, _mm256_loadu_si256((const __m256i *)(secret + 32 * ii)));
+        __m256i prod_lo = _mm256_mul_epu32(data_key, prime32);
+        __m256i prod_hi = _mm256_mul_epu32(_mm256_shuffle_epi32(data_key, _MM_SHUFFLE(0, 3, 0, 1)), prime32);
+        _mm256_storeu_si256((__m256i *)(acc + 4 * ii), _mm256_add_epi64(prod_lo, _mm256_slli_epi64(prod_hi, 32)));
+    }
+}
+
+/**
+ * @brief CPUID check of SSE2
+ */
+static bool xxh3_cpu_has_sse2(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (edx & bit_SSE2) != 0;
+}
+
+/**
+ * @brief CPUID check of AVX2, with the OS saving the ymm registers (XCR0)
+ */
+static bool xxh3_cpu_has_avx2(void) {
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+        return false;
+    unsigned int xcr0_lo, xcr0_hi;
+    __asm__ volatile("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0x6) != 0x6)
+        return false; // xmm and ymm state
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (ebx & bit_AVX2) != 0;
+}
+#else
+static bool xxh3_cpu_has_sse2(void) {
+    return false;
+}
+
+static bool xxh3_cpu_has_avx2(void) {
+    return false;
+}
+#endif
+
+static Xxh3Impl xxh3_active_impl = XXH3_IMPL_GENERIC;
+static Xxh3AccumulateFn xxh3_accumulate = xxh3_accumulate_generic;
+static Xxh3ScrambleFn xxh3_scramble = xxh3_scramble_generic;
+
+#ifdef __GNUC__
+/**
+ * @brief Pick the fastest implementation before main (no lazy init, no race)
+ */
+__attribute__((constructor)) static void xxh3_dispatch_init(void) {
+    xxh3_set_impl(XXH3_IMPL_AUTO);
+}
+#endif
+
+/** @copydoc xxh3_set_impl */
+bool xxh3_set_impl(Xxh3Impl impl) {
+    if (impl == XXH3_IMPL_AUTO)
+        impl = xxh3_cpu_has_avx2() ? XXH3_IMPL_AVX2 : xxh3_cpu_has_sse2() ? XXH3_IMPL_SSE2 : XXH3_IMPL_GENERIC;
+
+    switch (impl) {
+    case XXH3_IMPL_GENERIC:
+        xxh3_accumulate = xxh3_accumulate_generic;
+        xxh3_scramble = xxh3_scramble_generic;
+        break;
+#ifdef XXH3_HAS_X86
+    case XXH3_IMPL_SSE2:
+        if (!xxh3_cpu_has_sse2())
+            return false;
+        xxh3_accumulate = xxh3_accumulate_sse2;
+        xxh3_scramble = xxh3_scramble_sse2;
+        break;
+    case XXH3_IMPL_AVX2:
+        if (!xxh3_cpu_has_avx2())
+            return false;
+        xxh3_accumulate = xxh3_accumulate_avx2;
+        xxh3_scramble = xxh3_scramble_avx2;
+        break;
+#endif
+    default:
+        return false;
+    }
+    xxh3_active_impl = impl;
+    return true;
+}
+
+/** @copydoc xxh3_get_impl */
+Xxh3Impl xxh3_get_impl(void) {
+    return xxh3_active_impl;
+}
+
+/** @copydoc xxh3_impl_name */
+const char *xxh3_impl_name(Xxh3Impl impl) {
+    switch (impl) {
+    case XXH3_IMPL_AUTO:
+        return "auto";
+    case XXH3_IMPL_GENERIC:
+        return "generic";
+    case XXH3_IMPL_SSE2:
+        return "sse2";
+    case XXH3_IMPL_AVX2:
+        return "avx2";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Initial accumulators
+ */
+static void xxh3_acc_init(uint64_t acc[8]) {
+    acc[0] = XXH_PRIME32_3;
+    acc[1] = XXH_PRIME64_1;
+    acc[2] = XXH_PRIME64_2;
+    acc[3] = XXH_PRIME64_3;
+    acc[4] = XXH_PRIME64_4;
+    acc[5] = XXH_PRIME32_2;
+    acc[6] = XXH_PRIME64_5;
+    acc[7] = XXH_PRIME32_1;
+}
+
+/**
+ * @brief Accumulate stripes continuing a block of which done stripes are already accumulated,
+ * scrambling when a block is complete
+ */
+static void xxh3_consume_stripes(uint64_t acc[8], size_t *done, const uint8_t *input, size_t stripes) {
+    while (XXH3_STRIPES_PER_BLOCK - *done <= stripes) {
+        size_t to_end = XXH3_STRIPES_PER_BLOCK - *done;
+        xxh3_accumulate(acc, input, xxh3_secret + *done * XXH3_SECRET_CONSUME_RATE, to_end);
+        xxh3_scramble(acc, xxh3_secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN);
+        input += to_end * XXH3_STRIPE_LEN;
+        stripes -= to_end;
+        *done = 0;
+    }
+    xxh3_accumulate(acc, input, xxh3_secret + *done * XXH3_SECRET_CONSUME_RATE, stripes);
+    *done += stripes;
+}
+
+/**
+ * @brief Merge the accumulators into the 128-bit hash
+ */
+static uint64_t xxh3_merge_accs(const uint64_t acc[8], const uint8_t *secret, uint64_t start) {
+    uint64_t result = start;
+    for (int ii = 0; ii < 4; ii++)
+        result += xxh3_mul128_fold64(acc[2 * ii] ^ xxh3_load_le64(secret + 16 * ii),
+                                     acc[2 * ii + 1] ^ xxh3_load_le64(secret + 16 * ii + 8));
+    return xxh3_avalanche(result);
+}
+
+static Xxh3U128 xxh3_long_final(const uint64_t acc[8], uint64_t len) {
+    Xxh3U128 h;
+    h.low = xxh3_merge_accs(acc, xxh3_secret + XXH3_SECRET_MERGEACCS_START, len * XXH_PRIME64_1);
+    h.high = xxh3_merge_accs(acc, xxh3_secret + XXH3_SECRET_SIZE - 64 - XXH3_SECRET_MERGEACCS_START,
+                             ~(len * XXH_PRIME64_2));
+    return h;
+}
+
+/**
+ * @brief More than XXH3_MIDSIZE_MAX bytes
+ */
+static Xxh3U128 xxh3_long(const uint8_t *input, size_t len) {
+    uint64_t acc[8];
+    size_t done = 0;
+    xxh3_acc_init(acc);
+    // every stripe but the last one, which is always hashed apart
+    xxh3_consume_stripes(acc, &done, input, (len - 1) / XXH3_STRIPE_LEN);
+    xxh3_accumulate(acc, input + len - XXH3_STRIPE_LEN,
+                    xxh3_secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - XXH3_SECRET_LASTACC_START, 1);
+    return xxh3_long_final(acc, len);
+}
+
+/**
+ * @brief Canonical form: high then low, big endian
+ */
+static void xxh3_canonical(Xxh3U128 h, uint8_t hash[]) {
+    for (int ii = 0; ii < 8; ii++) {
+        hash[ii] = (uint8_t)(h.high >> (56 - 8 * ii));
+        hash[8 + ii] = (uint8_t)(h.low >> (56 - 8 * ii));
+    }
+}
+
+/** @copydoc xxh3 */
+bool xxh3(const uint8_t *data, size_t len, uint8_t *hash) {
+    if ((data == NULL && len > 0) || hash == NULL) {
+        printf("Invalid parameters! data and hash output must be valid!\n");
+        return false;
+    }
+    xxh3_canonical(len <= XXH3_MIDSIZE_MAX ? xxh3_short(data, len) : xxh3_long(data, len), hash);
+    return true;
+}
+
+/** @copydoc xxh3_init */
+void xxh3_init(XXH3_CTX *ctx) {
+    xxh3_acc_init(ctx->acc);
+    ctx->buffered = 0;
+    ctx->stripes = 0;
+    ctx->count = 0;
+}
+
+/** @copydoc xxh3_update */
+void xxh3_update(XXH3_CTX *ctx, const uint8_t data[], size_t len) {
+    if (len == 0)
+        return;
+
+    ctx->count += len;
+    if (len <= sizeof(ctx->buffer) - ctx->buffered) {
+        memcpy(ctx->buffer + ctx->buffered, data, len);
+        ctx->buffered += len;
+        return;
+    }
+
+    // more than a buffer: the bytes after it exist, so the buffer can be hashed
+    if (ctx->buffered > 0) {
+        size_t fill = sizeof(ctx->buffer) - ctx->buffered;
+        memcpy(ctx->buffer + ctx->buffered, data, fill);
+        data += fill;
+        len -= fill;
+        xxh3_consume_stripes(ctx->acc, &ctx->stripes, ctx->buffer, XXH3_BUFFER_STRIPES);
+        ctx->buffered = 0;
+    }
+
+    // whole buffers from the caller memory, keeping 1 to 256 bytes for later
+    if (len > sizeof(ctx->buffer)) {
+        size_t stripes = (len - 1) / sizeof(ctx->buffer) * XXH3_BUFFER_STRIPES;
+        xxh3_consume_stripes(ctx->acc, &ctx->stripes, data, stripes);
+        data += stripes * XXH3_STRIPE_LEN;
+        len -= stripes * XXH3_STRIPE_LEN;
+        // the last stripe may need the bytes before the pending ones
+        memcpy(ctx->buffer + sizeof(ctx->buffer) - XXH3_STRIPE_LEN, data - XXH3_STRIPE_LEN, XXH3_STRIPE_LEN);
+    }
+
+    memcpy(ctx->buffer, data, len);
+    ctx->buffered = len;
+}
+
+/** @copydoc xxh3_final */
+void xxh3_final(const XXH3_CTX *ctx, uint8_t hash[]) {
+    if (ctx->count <= XXH3_MIDSIZE_MAX) {
+        xxh3_canonical(xxh3_short(ctx->buffer, (size_t)ctx->count), hash);
+        return;
+    }
+
+    uint64_t acc[8];
+    size_t done = ctx->stripes;
+    const uint8_t *last;
+    uint8_t last_stripe[XXH3_STRIPE_LEN];
+    memcpy(acc, ctx->acc, sizeof(acc));
+    if (ctx->buffered >= XXH3_STRIPE_LEN) {
+        xxh3_consume_stripes(acc, &done, ctx->buffer, (ctx->buffered - 1) / XXH3_STRIPE_LEN);
+        last = ctx->buffer + ctx->buffered - XXH3_STRIPE_LEN;
+    } else {
+        // the last stripe starts in the bytes already hashed, kept at the end of the buffer
+        size_t catchup = XXH3_STRIPE_LEN - ctx->buffered;
+        memcpy(last_stripe, ctx->buffer + sizeof(ctx->buffer) - catchup, catchup);
+        memcpy(last_stripe + catchup, ctx->buffer, ctx->buffered);
+        last = last_stripe;
+    }
+    xxh3_accumulate(acc, last, xxh3_secret + XXH3_SECRET_SIZE - XXH3_STRIPE_LEN - XXH3_SECRET_LASTACC_START, 1);
+    xxh3_canonical(xxh3_long_final(acc, ctx->count), hash);
+}
+
+/**
+ * @brief fileio_stream consumer
+ */
+static bool fxxh3_chunk(void *ctx, const uint8_t *data, size_t len) {
+    xxh3_update((XXH3_CTX *)ctx, data, len);
+    return true;
+}
+
+/** @copydoc fxxh3 */
+bool fxxh3(const char *filename, uint8_t *hash) {
+    return fxxh3_io(filename, hash, FILEIO_AUTO);
+}
+
+/** @copydoc fxxh3_io */
+bool fxxh3_io(const char *filename, uint8_t *hash, FileIo io) {
+    if (filename == NULL || hash == NULL) {
+        printf("Invalid parameters! filename and hash output must be valid!\n");
+        return false;
+    }
+
+    XXH3_CTX ctx;
+    xxh3_init(&ctx);
+    if (!fileio_stream(filename, io, fxxh3_chunk, &ctx))
+        return false;
+    xxh3_final(&ctx, hash);
+    return true;
+}
+
+/** @copydoc fhxxh3 */
+bool fhxxh3(Fhash *fh) {
+    if (fh == NULL || fh->filename == NULL) {
+        printf("Invalid parameters! filename and hash output must be valid!\n");
+        return false;
+    }
+    uint8_t hash[XXH3_LENGTH];
+    if (!fxxh3(fh->filename, hash))
+        return false;
+    memcpy(fh->hash, hash, XXH3_LENGTH);
+    memset(fh->hash + XXH3_LENGTH, 0, sizeof(fh->hash) - XXH3_LENGTH);
+    return true;
+}
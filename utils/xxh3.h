@@ -0,0 +1,145 @@
+/**
+ * @brief XXH3 128-bit non-cryptographic hash
+ *
+ * deldup only needs a fingerprint to group identical files, not a
+ * cryptographic hash: XXH3 runs at memory speed where SHA-1 is compute
+ * bound. The output is the XXH3_128bits hash with seed 0 and the default
+ * secret, written in the canonical (big endian) form, so it is the same
+ * hex string printed by xxh128sum.
+ *
+ * Inputs longer than 240 bytes are folded 64 bytes (one stripe) at a time
+ * into 8 64-bit accumulators with 32x32->64 multiplies, a loop that maps
+ * to SSE2 (2 accumulators per register) or AVX2 (4 per register). The
+ * implementation is selected at startup via CPUID, like sha1.
+ *
+ * Not collision resistant: whoever controls the content can build two
+ * files with the same hash. Confirm matches with a full compare when the
+ * files are not trusted (deldup --verify).
+ *
+ * @see https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md
+ * @author Alberto Ielpo <alberto.ielpo@gmail.com>
+ */
+#ifndef XXH3_H
+#define XXH3_H
+
+#include "fileio.h"
+#include "sha1.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define XXH3_LENGTH 16
+#define XXH3_LENGTH_CHAR 33 // 32 + \0
+
+/**
+ * Stripe accumulation implementations
+ */
+typedef enum {
+    XXH3_IMPL_AUTO,    // fastest supported by the running CPU
+    XXH3_IMPL_GENERIC, // portable C
+    XXH3_IMPL_SSE2,    // 128-bit vectors
+    XXH3_IMPL_AVX2     // 256-bit vectors
+} Xxh3Impl;
+
+/**
+ * Streaming context, to be initialized with xxh3_init
+ */
+typedef struct
+{
+    uint64_t acc[8];     // accumulators
+    uint8_t buffer[256]; // pending input, the last bytes are always kept
+    size_t buffered;     // bytes in buffer
+    size_t stripes;      // stripes accumulated in the current block
+    uint64_t count;      // bytes hashed so far
+} XXH3_CTX;
+
+/**
+ * @brief Computes the XXH3 128-bit hash of the given data
+ *
+ * @param[in]  data  bytes (can be NULL only if len is 0)
+ * @param[in]  len   number of bytes
+ * @param[out] hash  16 bytes hash
+ * @returns true if the hash is calculated else false
+ */
+bool xxh3(const uint8_t *data, size_t len, uint8_t *hash);
+
+/**
+ * @brief Start a new streaming hash
+ *
+ * @param[out] ctx context
+ */
+void xxh3_init(XXH3_CTX *ctx);
+
+/**
+ * @brief Hash the next len bytes of the message
+ *
+ * Whole stripes are hashed straight from the caller memory, at most 256
+ * bytes are copied per call.
+ *
+ * @param[in,out] ctx context
+ * @param[in] data bytes (can be NULL only if len is 0)
+ * @param[in] len number of bytes, any size
+ */
+void xxh3_update(XXH3_CTX *ctx, const uint8_t data[], size_t len);
+
+/**
+ * @brief Write the hash
+ *
+ * The context is not modified: more data can be added after it.
+ *
+ * @param[in] ctx context
+ * @param[out] hash 16 bytes hash
+ */
+void xxh3_final(const XXH3_CTX *ctx, uint8_t hash[]);
+
+/**
+ * @brief Computes the XXH3 128-bit hash of a given file
+ *
+ * @param[in] filename The filename
+ * @param[out] hash 16 bytes hash
+ * @returns true if the hash is calculated else false
+ */
+bool fxxh3(const char *filename, uint8_t *hash);
+
+/**
+ * @brief Computes the XXH3 128-bit hash of a given file with a given I/O strategy
+ *
+ * fxxh3 is fxxh3_io with FILEIO_AUTO (strategy by file size, see fileio.h)
+ *
+ * @param[in] filename The filename
+ * @param[out] hash 16 bytes hash
+ * @param[in] io I/O strategy
+ * @returns true if the hash is calculated else false
+ */
+bool fxxh3_io(const char *filename, uint8_t *hash, FileIo io);
+
+/**
+ * @brief wrap of fxxh3 using Fhash struct
+ *
+ * The first XXH3_LENGTH bytes of fh->hash are the hash, the rest is zeroed.
+ */
+bool fhxxh3(Fhash *fh);
+
+/**
+ * @brief Select the stripe accumulation
+ *
+ * The fastest implementation is selected at startup via CPUID, this is
+ * needed only to force one (benchmarks, cross checks).
+ * Not thread safe: call it before hashing from multiple threads.
+ *
+ * @param[in] impl implementation, XXH3_IMPL_AUTO to redo the CPU detection
+ * @returns true if selected, false if not supported by this CPU or build
+ */
+bool xxh3_set_impl(Xxh3Impl impl);
+
+/**
+ * @brief Active implementation (never XXH3_IMPL_AUTO)
+ */
+Xxh3Impl xxh3_get_impl(void);
+
+/**
+ * @brief Implementation name, e.g. "avx2"
+ */
+const char *xxh3_impl_name(Xxh3Impl impl);
+
+#endif // XXH3_H